@@ -31,6 +31,8 @@ ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <stdlib.h>
+
 #include "Adafruit_GFX.h"
 #include "Adafruit_SSD1351.h"
 #include "glcdfont.h"
@@ -58,21 +60,44 @@ Adafruit_GFX(int w, int h):
 }
 */
 
+// Emit the eight mirror images of an octant run (xs..xe, y) of a circle
+// centred on (x0, y0) as straight runs. A run that starts on the axis
+// joins with its own mirror image, so it goes out as one span.
+static void circleRuns(int x0, int y0, int xs, int xe, int y, unsigned int color) {
+  int n = xe - xs + 1;
+
+  if (xs == 0) {
+    drawFastHLine(x0 - xe, y0 + y, 2 * xe + 1, color);
+    drawFastHLine(x0 - xe, y0 - y, 2 * xe + 1, color);
+    drawFastVLine(x0 + y, y0 - xe, 2 * xe + 1, color);
+    drawFastVLine(x0 - y, y0 - xe, 2 * xe + 1, color);
+    return;
+  }
+  drawFastHLine(x0 + xs, y0 + y, n, color);
+  drawFastHLine(x0 - xe, y0 + y, n, color);
+  drawFastHLine(x0 + xs, y0 - y, n, color);
+  drawFastHLine(x0 - xe, y0 - y, n, color);
+  drawFastVLine(x0 + y, y0 + xs, n, color);
+  drawFastVLine(x0 + y, y0 - xe, n, color);
+  drawFastVLine(x0 - y, y0 + xs, n, color);
+  drawFastVLine(x0 - y, y0 - xe, n, color);
+}
+
 // Draw a circle outline
+// Same midpoint walk as before, but each stretch of pixels that share a row
+// in the octant is emitted as one run instead of pixel by pixel.
 void drawCircle(int x0, int y0, int r, unsigned int color) {
   int f = 1 - r;
   int ddF_x = 1;
   int ddF_y = -2 * r;
   int x = 0;
   int y = r;
-
-  drawPixel(x0  , y0+r, color);
-  drawPixel(x0  , y0-r, color);
-  drawPixel(x0+r, y0  , color);
-  drawPixel(x0-r, y0  , color);
+  int xs = 0;
 
   while (x<y) {
     if (f >= 0) {
+      circleRuns(x0, y0, xs, x, y, color);
+      xs = x + 1;
       y--;
       ddF_y += 2;
       f += ddF_y;
@@ -80,16 +105,8 @@ void drawCircle(int x0, int y0, int r, unsigned int color) {
     x++;
     ddF_x += 2;
     f += ddF_x;
-  
-    drawPixel(x0 + x, y0 + y, color);
-    drawPixel(x0 - x, y0 + y, color);
-    drawPixel(x0 + x, y0 - y, color);
-    drawPixel(x0 - x, y0 - y, color);
-    drawPixel(x0 + y, y0 + x, color);
-    drawPixel(x0 - y, y0 + x, color);
-    drawPixel(x0 + y, y0 - x, color);
-    drawPixel(x0 - y, y0 - x, color);
   }
+  circleRuns(x0, y0, xs, x, y, color);
 }
 
 void drawCircleHelper( int x0, int y0,
@@ -130,8 +147,43 @@ void drawCircleHelper( int x0, int y0,
 
 void fillCircle(int x0, int y0, int r,
 			      unsigned int color) {
-  drawFastVLine(x0, y0-r, 2*r+1, color);
-  fillCircleHelper(x0, y0, r, 3, 0, color);
+  // Half-height of the disc in each column |dx|, taken from the same
+  // midpoint walk fillCircleHelper() uses, so the pixels are identical.
+  int half[WIDTH];
+  int f     = 1 - r;
+  int ddF_x = 1;
+  int ddF_y = -2 * r;
+  int x     = 0;
+  int y     = r;
+  int i, run;
+
+  if ((r < 0) || (r >= WIDTH)) {
+    drawFastVLine(x0, y0-r, 2*r+1, color);
+    fillCircleHelper(x0, y0, r, 3, 0, color);
+    return;
+  }
+
+  for (i = 0; i <= r; i++) half[i] = -1;
+  half[0] = r;
+  while (x<y) {
+    if (f >= 0) {
+      y--;
+      ddF_y += 2;
+      f     += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f     += ddF_x;
+    if (y > half[x]) half[x] = y;
+    if (x > half[y]) half[y] = x;
+  }
+
+  // Columns of equal height go out together as one rectangle.
+  for (i = -r; i <= r; i += run) {
+    y = half[abs(i)];
+    for (run = 1; (i + run <= r) && (half[abs(i + run)] == y); run++);
+    if (y >= 0) fillRect(x0 + i, y0 - y, run, 2 * y + 1, color);
+  }
 }
 
 // Used to do circles and roundrects
@@ -166,11 +218,14 @@ void fillCircleHelper(int x0, int y0, int r,
 }
 
 // Bresenham's algorithm - thx wikpedia
+// Pixels that share a row (or a column, for steep lines) are collected and
+// written as one fast H/V line rather than one pixel at a time.
 void drawLine(int x0, int y0, int x1, int y1, unsigned int color) {
   int steep;
   int dx, dy;
 	int err;
 	int ystep;
+	int run;
 						
 	steep = abs(y1 - y0) > abs(x1 - x0);
   if (steep) {
@@ -194,13 +249,16 @@ void drawLine(int x0, int y0, int x1, int y1, unsigned int color) {
     ystep = -1;
   }
 
-  for (; x0<=x1; x0++) {
-    if (steep) {
-      drawPixel(y0, x0, color);
-    } else {
-      drawPixel(x0, y0, color);
-    }
+  for (run = x0; x0<=x1; x0++) {
     err -= dy;
+    if ((err < 0) || (x0 == x1)) {
+      if (steep) {
+        drawFastVLine(y0, run, x0 - run + 1, color);
+      } else {
+        drawFastHLine(run, y0, x0 - run + 1, color);
+      }
+      run = x0 + 1;
+    }
     if (err < 0) {
       y0 += ystep;
       err += dx;
@@ -359,6 +417,84 @@ void fillTriangle ( int x0, int y0,
     drawFastHLine(a, y, b-a+1, color);
   }
 }
+// Opaque sprite fully on screen: open one window and stream every run
+// into it, so a repeat costs one pushColor() whatever its length.
+static void blitSprite(int x, int y, const Sprite *sprite)
+{
+  unsigned short lit[128];
+  const unsigned char *p = sprite->data;
+  long left = (long)sprite->w * sprite->h;
+  int n, i;
+
+  beginWindow(x, y, sprite->w, sprite->h);
+  while (left > 0) {
+    n = (*p & 0x7F) + 1;
+    if (*p++ & 0x80) {
+      for (i = 0; i < n; i++) lit[i] = sprite->palette[*p++];
+      pushPixels(lit, n);
+    } else {
+      pushColor(sprite->palette[*p++], n);
+    }
+    left -= n;
+  }
+  endWindow();
+}
+
+// Lay n pixels of one index down from (col, row) onward as clipped
+// horizontal lines, wrapping at the sprite's right edge.
+static void spriteRun(int x, int y, const Sprite *sprite, int *col, int *row,
+                      int idx, int n)
+{
+  int len, x0, x1;
+
+  while (n > 0) {
+    len = sprite->w - *col;
+    if (len > n) len = n;
+    if ((idx != sprite->transparent) && (y + *row >= 0) && (y + *row < HEIGHT)) {
+      x0 = x + *col;
+      x1 = x0 + len - 1;
+      if (x0 < 0) x0 = 0;
+      if (x1 >= WIDTH) x1 = WIDTH - 1;
+      if (x0 <= x1) drawFastHLine(x0, y + *row, x1 - x0 + 1, sprite->palette[idx]);
+    }
+    *col += len;
+    n -= len;
+    if (*col == sprite->w) {
+      *col = 0;
+      (*row)++;
+    }
+  }
+}
+
+// Draw a sprite with its top left corner at (x, y). Transparent or
+// partly off-screen sprites go out run by run as clipped lines instead of
+// through one window; runs are never expanded into per-pixel calls.
+void drawSprite(int x, int y, const Sprite *sprite)
+{
+  const unsigned char *p = sprite->data;
+  int col = 0, row = 0;
+  int n, i, same;
+
+  if ((sprite->transparent < 0) && (x >= 0) && (y >= 0) &&
+      (x + sprite->w <= WIDTH) && (y + sprite->h <= HEIGHT)) {
+    blitSprite(x, y, sprite);
+    return;
+  }
+
+  while (row < sprite->h) {
+    n = (*p & 0x7F) + 1;
+    if (*p++ & 0x80) {
+      for (i = 0; i < n; i += same) {
+        for (same = 1; (i + same < n) && (p[i + same] == p[i]); same++);
+        spriteRun(x, y, sprite, &col, &row, p[i], same);
+      }
+      p += n;
+    } else {
+      spriteRun(x, y, sprite, &col, &row, *p++, n);
+    }
+  }
+}
+
 /*
 void drawBitmap(int x, int y,
 			      const unsigned char *bitmap, int w, int h,
@@ -438,6 +574,45 @@ void write(unsigned char c) {
 #endif
 }
 */
+// Number of leading characters of str that can be blitted as one opaque
+// run starting at (x, y): every cell must lie wholly on screen.
+static int glyphRunLength(int x, int y, const char *str, unsigned char size) {
+  int n = 0;
+
+  if ((x < 0) || (y < 0) || (y + 8 * size > HEIGHT))
+    return 0;
+  while (str[n] && (x + 6 * size * (n + 1) <= WIDTH))
+    n++;
+  return n;
+}
+
+// Stream n opaque character cells as a single window, one pixel row at a
+// time. Scaled glyphs repeat each font bit size times across the row and
+// each row size times down, so the whole run is one burst.
+static void blitGlyphRun(int x, int y, const char *str, int n,
+                         unsigned int color, unsigned int bg, unsigned char size) {
+  unsigned short row[WIDTH];
+  unsigned short px;
+  unsigned char line;
+  int j, k, i, s, p;
+
+  beginWindow(x, y, 6 * size * n, 8 * size);
+  for (j = 0; j < 8; j++) {
+    p = 0;
+    for (k = 0; k < n; k++) {
+      for (i = 0; i < 6; i++) {
+        line = (i == 5) ? 0x0 : font[((unsigned char)str[k])*5 + i];
+        px = ((line >> j) & 0x1) ? color : bg;
+        for (s = 0; s < size; s++)
+          row[p++] = px;
+      }
+    }
+    for (s = 0; s < size; s++)
+      pushPixels(row, p);
+  }
+  endWindow();
+}
+
 // Draw a character
 void drawChar(int x, int y, unsigned char c,
 			    unsigned int color, unsigned int bg, unsigned char size) {
@@ -445,6 +620,9 @@ void drawChar(int x, int y, unsigned char c,
   unsigned char line;	
   char i;						
   char j;						
+  char run;
+  char on;
+  char str[2];
 						
   if((x >= WIDTH)            || // Clip right
      (y >= HEIGHT)           || // Clip bottom
@@ -452,35 +630,47 @@ void drawChar(int x, int y, unsigned char c,
      ((y + 8 * size - 1) < 0))   // Clip top
     return;
 
+  str[0] = c;
+  str[1] = 0;
+  if ((bg != color) && glyphRunLength(x, y, str, size)) {
+    blitGlyphRun(x, y, str, 1, color, bg, size);
+    return;
+  }
+
+  // Transparent or partly off screen: one fast line (or rect when scaled)
+  // per vertical run of equal bits in each font column.
   for (i=0; i<6; i++ ) {
     if (i == 5) 
       line = 0x0;
     else 
       line = font[(c*5)+i];
-    for (j = 0; j<8; j++) {
-      if (line & 0x1) {
-        if (size == 1) // default size
-          drawPixel(x+i, y+j, color);
-        else {  // big size
-          fillRect(x+(i*size), y+(j*size), size, size, color);
-        } 
-      } else if (bg != color) {
-        if (size == 1) // default size
-          drawPixel(x+i, y+j, bg);
-        else {  // big size
-          fillRect(x+i*size, y+j*size, size, size, bg);
-        }
+    for (j = 0; j<8; j += run) {
+      on = (line >> j) & 0x1;
+      for (run = 1; (j + run < 8) && (((line >> (j + run)) & 0x1) == on); run++);
+      if (!on && (bg == color))
+        continue;
+      if (size == 1) // default size
+        drawFastVLine(x+i, y+j, run, on ? color : bg);
+      else {  // big size
+        fillRect(x+i*size, y+j*size, size, run*size, on ? color : bg);
       }
-      line >>= 1;
     }
   }
 }
 
 void Outstr (char * str) {
 	char * ptr;
+	int n;
 	
 	ptr = str;
 	while (*ptr) {
+		n = (textbgcolor != textcolor) ? glyphRunLength(cursor_x, cursor_y, ptr, textsize) : 0;
+		if (n > 0) {
+			blitGlyphRun(cursor_x, cursor_y, ptr, n, textcolor, textbgcolor, textsize);
+			cursor_x += 6*textsize*n;
+			ptr += n;
+			continue;
+		}
 		drawChar(cursor_x, cursor_y, *ptr++, textcolor, textbgcolor, textsize);
 		cursor_x += 6*textsize;
 	}
@@ -15,6 +15,17 @@
 
 #define swap(a, b) {int t = a; a = b; b = t; }
 
+// Palette-indexed image, run-length encoded in row-major order (runs may
+// cross row ends). Each token byte n is either a repeat, bit 7 clear: the
+// next index byte is drawn (n & 0x7F) + 1 times; or a literal, bit 7 set:
+// (n & 0x7F) + 1 index bytes follow. Built from PNGs by tools/png2sprite.
+typedef struct {
+  int w, h;
+  int transparent;               // palette index left undrawn, or -1
+  const unsigned short *palette; // RGB565
+  const unsigned char *data;
+} Sprite;
+
 // class Adafruit_GFX : public Print {
 
 // public:
@@ -49,6 +60,7 @@
     void drawBitmap(int x, int y, const unsigned char *bitmap, int w, int h, unsigned int color);
 //    void drawBitmap(int x, int y, const unsigned char *bitmap, int w, int h, unsigned int color, unsigned int bg);
     void drawXBitmap(int x, int y, const unsigned char *bitmap, int w, int h, unsigned int color);
+    void drawSprite(int x, int y, const Sprite *sprite);
     void drawChar(int x, int y, unsigned char c, unsigned int color, unsigned int bg, unsigned char size);
     void setCursor(int x, int y);
 //    void setTextColor(unsigned int c);
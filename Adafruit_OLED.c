@@ -15,6 +15,8 @@
 #include "prcm.h"
 #include "uart.h"
 #include "interrupt.h"
+#include "udma.h"
+#include "hw_mcspi.h"
 
 #include "uart_if.h"
 #include "pinmux.h"
@@ -26,9 +28,378 @@
 #define OLED_DC_PIN           GPIO_PIN_6
 #define OLED_RST_PIN          GPIO_PIN_4
 
+// SETCOLUMN + 2 args, SETROW + 2 args, WRITERAM: paid once per flushed window
+#define OLED_WINDOW_COST      7
+
+// Bytes staged per SPITransfer() call while streaming pixels
+#define OLED_BURST_BYTES      64
+
+// Framebuffer pixels a save-under log can hold before it gives up
+#define OLED_SAVE_PIXELS      512
+
+static unsigned long s_txBytes = 0;
+static unsigned char s_burstRx[OLED_BURST_BYTES];
+
+// Clock out a run of bytes with CS already asserted and DC already set.
+// SPITransfer() keeps the GSPI FIFO fed using the word length from SPIInit().
+static void spiSend(const unsigned char *buf, unsigned long len)
+{
+  unsigned long n;
+
+  while (len > 0) {
+    n = (len > OLED_BURST_BYTES) ? OLED_BURST_BYTES : len;
+    MAP_SPITransfer(GSPI_BASE, (unsigned char *)buf, s_burstRx, n, 0);
+    buf += n;
+    len -= n;
+  }
+}
+
+static void burstCommand(unsigned char c, unsigned char a0, unsigned char a1, int nargs)
+{
+  unsigned char args[2];
+
+  args[0] = a0;
+  args[1] = a1;
+  GPIOPinWrite(GPIOA3_BASE, OLED_DC_PIN, 0x00);  // DC low
+  spiSend(&c, 1);
+  GPIOPinWrite(GPIOA3_BASE, OLED_DC_PIN, OLED_DC_PIN);  // DC high
+  if (nargs > 0) spiSend(args, nargs);
+}
+
+// Assert CS and open a GDDRAM write window; CS stays low and DC high until
+// the caller is done streaming pixels. The OLED_WINDOW_COST command bytes
+// are left for the caller to count.
+static void panelWindow(int x0, int y0, int x1, int y1)
+{
+  MAP_SPICSEnable(GSPI_BASE);
+  burstCommand(SSD1351_CMD_SETCOLUMN, x0, x1, 2);
+  burstCommand(SSD1351_CMD_SETROW, y0, y1, 2);
+  burstCommand(SSD1351_CMD_WRITERAM, 0, 0, 0);
+}
+
+#if !SSD1351_FRAMEBUFFER || !SSD1351_DMA
+// Pixel bytes staged for spiSend() by panelPushColor()/panelPushPixels()
+static unsigned char s_burstTx[OLED_BURST_BYTES];
+
+static void burstSend(const unsigned char *buf, unsigned long len)
+{
+  s_txBytes += len;
+  spiSend(buf, len);
+}
+#endif
+
+#if !SSD1351_FRAMEBUFFER
+static void panelPushColor(unsigned int color, unsigned long count)
+{
+  unsigned long i, n;
+
+  for (i = 0; i < OLED_BURST_BYTES; i += 2) {
+    s_burstTx[i] = color >> 8;
+    s_burstTx[i + 1] = color;
+  }
+  while (count > 0) {
+    n = (count > OLED_BURST_BYTES / 2) ? OLED_BURST_BYTES / 2 : count;
+    burstSend(s_burstTx, n * 2);
+    count -= n;
+  }
+}
+#endif
+
+#if !SSD1351_FRAMEBUFFER
+// Clip a rectangle to the panel, the same way drawPixel() would pixel by
+// pixel, and fill what is left as one window.
+static void panelFill(int x, int y, int w, int h, unsigned int color)
+{
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > SSD1351WIDTH) w = SSD1351WIDTH - x;
+  if (y + h > SSD1351HEIGHT) h = SSD1351HEIGHT - y;
+  if ((w <= 0) || (h <= 0)) return;
+
+  beginWindow(x, y, w, h);
+  pushColor(color, (unsigned long)w * h);
+  endWindow();
+}
+#endif
+
+#if !SSD1351_DMA
+static void panelPushPixels(const unsigned short *pixels, unsigned long count)
+{
+  unsigned long i, n;
+
+  while (count > 0) {
+    n = (count > OLED_BURST_BYTES / 2) ? OLED_BURST_BYTES / 2 : count;
+    for (i = 0; i < n; i++) {
+      s_burstTx[2 * i] = pixels[i] >> 8;
+      s_burstTx[2 * i + 1] = pixels[i];
+    }
+    burstSend(s_burstTx, n * 2);
+    pixels += n;
+    count -= n;
+  }
+}
+#endif
+
+#if SSD1351_FRAMEBUFFER
+// Shadow of the panel GDDRAM plus the span of columns touched in each row
+// since the last flush (x0 > x1 means the row is clean).
+static unsigned short s_frame[SSD1351HEIGHT][SSD1351WIDTH];
+static unsigned char s_dirtyX0[SSD1351HEIGHT];
+static unsigned char s_dirtyX1[SSD1351HEIGHT];
+static int s_dirtyY0 = SSD1351HEIGHT;
+static int s_dirtyY1 = -1;
+
+static void markDirty(int x0, int x1, int y)
+{
+  if (x0 < s_dirtyX0[y]) s_dirtyX0[y] = x0;
+  if (x1 > s_dirtyX1[y]) s_dirtyX1[y] = x1;
+  if (y < s_dirtyY0) s_dirtyY0 = y;
+  if (y > s_dirtyY1) s_dirtyY1 = y;
+}
+
+// Save-under log: while recording, the old value of every framebuffer
+// pixel that changes is appended so restoreSaveUnder() can lift sprites
+// back off the background, newest first.
+static unsigned short s_saveIdx[OLED_SAVE_PIXELS];
+static unsigned short s_saveVal[OLED_SAVE_PIXELS];
+static int s_saveLen = 0;
+static int s_saving = 0;
+static int s_saveLost = 0;
+
+static void saveUnder(int x, int y)
+{
+  if (!s_saving) return;
+  if (s_saveLen < OLED_SAVE_PIXELS) {
+    s_saveIdx[s_saveLen] = y * SSD1351WIDTH + x;
+    s_saveVal[s_saveLen] = s_frame[y][x];
+    s_saveLen++;
+  } else {
+    s_saveLost = 1;
+  }
+}
+
+static void clearDirty(void)
+{
+  memset(s_dirtyX0, 0xFF, sizeof(s_dirtyX0));
+  memset(s_dirtyX1, 0x00, sizeof(s_dirtyX1));
+  s_dirtyY0 = SSD1351HEIGHT;
+  s_dirtyY1 = -1;
+}
+
+// Only pixels whose value actually changes are marked, so erasing and
+// redrawing the same content leaves nothing to flush.
+static void fbFill(int x, int y, int w, int h, unsigned int color)
+{
+  unsigned short c = (unsigned short)color;
+  unsigned short *p;
+  int row, col, first, last;
+
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > SSD1351WIDTH) w = SSD1351WIDTH - x;
+  if (y + h > SSD1351HEIGHT) h = SSD1351HEIGHT - y;
+  if ((w <= 0) || (h <= 0)) return;
+
+  for (row = y; row < y + h; row++) {
+    p = s_frame[row];
+    first = -1;
+    last = -1;
+    for (col = x; col < x + w; col++) {
+      if (p[col] != c) {
+        saveUnder(col, row);
+        p[col] = c;
+        if (first < 0) first = col;
+        last = col;
+      }
+    }
+    if (first >= 0) markDirty(first, last, row);
+  }
+}
+
+#if SSD1351_DMA
+// Windows handed over by flushDisplay() are clocked out by the GSPI uDMA
+// channels one row at a time. While one row buffer is on the wire the GSPI
+// interrupt has already byte-swapped the next row into the other, so the
+// main loop only pays for building the window list. Rows are copied out of
+// s_frame as they are staged; anything drawn over them meanwhile is marked
+// dirty again and goes out with the next flush.
+typedef struct {
+  unsigned char x0, y0, x1, y1;
+} FlushWindow;
+
+#if defined(ccs)
+#pragma DATA_ALIGN(s_dmaTable, 1024)
+static tDMAControlTable s_dmaTable[64];
+#else
+static tDMAControlTable s_dmaTable[64] __attribute__((aligned(1024)));
+#endif
+
+static FlushWindow s_queue[SSD1351HEIGHT];
+static int s_queueLen = 0;
+static int s_queueHead = 0;
+static int s_stageRow = 0;
+static unsigned char s_line[2][SSD1351WIDTH * 2];
+static unsigned long s_lineLen[2];
+static int s_lineCur = 0;
+static unsigned char s_rxSink;
+static volatile int s_flushBusy = 0;
+static void (*s_flushDone)(void) = 0;
+
+// Copy the next row of the head window into a line buffer in panel byte
+// order; an empty buffer means the window has no rows left to stage.
+static void stageLine(int buf)
+{
+  const FlushWindow *w = &s_queue[s_queueHead];
+  unsigned char *out = s_line[buf];
+  int x;
+
+  if (s_stageRow > w->y1) {
+    s_lineLen[buf] = 0;
+    return;
+  }
+  for (x = w->x0; x <= w->x1; x++) {
+    *out++ = s_frame[s_stageRow][x] >> 8;
+    *out++ = s_frame[s_stageRow][x];
+  }
+  s_lineLen[buf] = 2 * (w->x1 - w->x0 + 1);
+  s_stageRow++;
+}
+
+// RX is drained into a scratch byte so the channel completes only once the
+// last TX byte has actually been shifted out, which makes it the safe point
+// to drop CS or turn DC around.
+static void startLine(int buf)
+{
+  s_lineCur = buf;
+  MAP_uDMAChannelControlSet(UDMA_CH30_GSPI_RX | UDMA_PRI_SELECT,
+                            UDMA_SIZE_8 | UDMA_SRC_INC_NONE | UDMA_DST_INC_NONE | UDMA_ARB_1);
+  MAP_uDMAChannelTransferSet(UDMA_CH30_GSPI_RX | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+                             (void *)(GSPI_BASE + MCSPI_O_RX0), &s_rxSink, s_lineLen[buf]);
+  MAP_uDMAChannelControlSet(UDMA_CH31_GSPI_TX | UDMA_PRI_SELECT,
+                            UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_1);
+  MAP_uDMAChannelTransferSet(UDMA_CH31_GSPI_TX | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+                             s_line[buf], (void *)(GSPI_BASE + MCSPI_O_TX0), s_lineLen[buf]);
+  MAP_uDMAChannelEnable(UDMA_CH30_GSPI_RX);
+  MAP_uDMAChannelEnable(UDMA_CH31_GSPI_TX);
+  MAP_SPIDmaEnable(GSPI_BASE, SPI_RX_DMA | SPI_TX_DMA);
+}
+
+// Open the head window with polled command bytes, then hand its rows to DMA.
+// Both buffers are staged first: a short row can complete, and re-enter
+// through the interrupt, before this returns.
+static void startWindow(void)
+{
+  const FlushWindow *w = &s_queue[s_queueHead];
+
+  panelWindow(w->x0, w->y0, w->x1, w->y1);
+  s_stageRow = w->y0;
+  stageLine(0);
+  stageLine(1);
+  startLine(0);
+}
+
+static void OledDmaIntHandler(void)
+{
+  int next;
+
+  MAP_SPIIntClear(GSPI_BASE, SPI_INT_DMARX);
+  if (!s_flushBusy || MAP_uDMAChannelIsEnabled(UDMA_CH30_GSPI_RX)) return;
+  MAP_SPIDmaDisable(GSPI_BASE, SPI_RX_DMA | SPI_TX_DMA);
+
+  next = s_lineCur ^ 1;
+  if (s_lineLen[next] > 0) {
+    startLine(next);
+    stageLine(next ^ 1);
+    return;
+  }
+
+  MAP_SPICSDisable(GSPI_BASE);
+  if (++s_queueHead < s_queueLen) {
+    startWindow();
+    return;
+  }
+
+  s_flushBusy = 0;
+  if (s_flushDone) s_flushDone();
+}
+
+static void dmaInit(void)
+{
+  MAP_PRCMPeripheralClkEnable(PRCM_UDMA, PRCM_RUN_MODE_CLK);
+  MAP_uDMAEnable();
+  // Share the control table if the application already installed one.
+  if (MAP_uDMAControlBaseGet() == 0) {
+    MAP_uDMAControlBaseSet(s_dmaTable);
+  }
+  MAP_uDMAChannelAssign(UDMA_CH30_GSPI_RX);
+  MAP_uDMAChannelAssign(UDMA_CH31_GSPI_TX);
+  MAP_uDMAChannelAttributeDisable(UDMA_CH30_GSPI_RX, UDMA_ATTR_ALTSELECT | UDMA_ATTR_USEBURST | UDMA_ATTR_REQMASK);
+  MAP_uDMAChannelAttributeDisable(UDMA_CH31_GSPI_TX, UDMA_ATTR_ALTSELECT | UDMA_ATTR_USEBURST | UDMA_ATTR_REQMASK);
+
+  MAP_SPIFIFOLevelSet(GSPI_BASE, 1, 1);
+  MAP_SPIIntRegister(GSPI_BASE, OledDmaIntHandler);
+  MAP_SPIIntEnable(GSPI_BASE, SPI_INT_DMARX);
+}
+
+// Polled writes must not cut into a DMA flush that still owns the bus.
+static void waitFlush(void)
+{
+  while (s_flushBusy) {
+  }
+}
+
+static void sendWindow(int x0, int y0, int x1, int y1)
+{
+  FlushWindow *w = &s_queue[s_queueLen++];
+
+  w->x0 = x0;
+  w->y0 = y0;
+  w->x1 = x1;
+  w->y1 = y1;
+  s_txBytes += OLED_WINDOW_COST + 2UL * (x1 - x0 + 1) * (y1 - y0 + 1);
+}
+#else
+static void sendWindow(int x0, int y0, int x1, int y1)
+{
+  int y;
+
+  s_txBytes += OLED_WINDOW_COST;
+  panelWindow(x0, y0, x1, y1);
+  for (y = y0; y <= y1; y++) {
+    panelPushPixels(&s_frame[y][x0], x1 - x0 + 1);
+  }
+  MAP_SPICSDisable(GSPI_BASE);
+}
+#endif
+
+// Raster cursor for beginWindow()/pushColor()/pushPixels() in RAM. Pixels
+// that fall outside the panel advance the cursor but are not stored.
+static int s_winX0, s_winY0, s_winX1, s_winY1;
+static int s_winX, s_winY;
+
+static void fbPut(unsigned short c)
+{
+  if ((s_winX >= 0) && (s_winX < SSD1351WIDTH) &&
+      (s_winY >= 0) && (s_winY < SSD1351HEIGHT) &&
+      (s_frame[s_winY][s_winX] != c)) {
+    saveUnder(s_winX, s_winY);
+    s_frame[s_winY][s_winX] = c;
+    markDirty(s_winX, s_winX, s_winY);
+  }
+  if (++s_winX > s_winX1) {
+    s_winX = s_winX0;
+    if (++s_winY > s_winY1) s_winY = s_winY0;
+  }
+}
+#endif
+
 void writeCommand(unsigned char c) {
   unsigned long ulDummy;
 
+#if SSD1351_DMA
+  waitFlush();
+#endif
+  s_txBytes++;
   MAP_SPICSEnable(GSPI_BASE);
   GPIOPinWrite(GPIOA3_BASE, OLED_DC_PIN, 0x00);  // DC low
 
@@ -41,6 +412,10 @@ void writeCommand(unsigned char c) {
 void writeData(unsigned char c) {
     unsigned long ulDummy;
 
+#if SSD1351_DMA
+    waitFlush();
+#endif
+    s_txBytes++;
     MAP_SPICSEnable(GSPI_BASE);
     GPIOPinWrite(GPIOA3_BASE, OLED_DC_PIN, OLED_DC_PIN);  // DC high
 
@@ -52,6 +427,13 @@ void writeData(unsigned char c) {
 
 void Adafruit_Init(void){
   volatile unsigned long delay;
+#if SSD1351_FRAMEBUFFER
+  int row;
+#endif
+
+#if SSD1351_DMA
+  dmaInit();
+#endif
 
   GPIOPinWrite(GPIOA3_BASE, OLED_RST_PIN, 0);	// RESET = RESET_LOW
 
@@ -125,6 +507,13 @@ void Adafruit_Init(void){
   writeData(0x01);
 
   writeCommand(SSD1351_CMD_DISPLAYON);
+
+#if SSD1351_FRAMEBUFFER
+  // Panel RAM is undefined after reset; push the whole shadow on first flush.
+  for (row = 0; row < SSD1351HEIGHT; row++) {
+    markDirty(0, SSD1351WIDTH - 1, row);
+  }
+#endif
 }
 
 void goTo(int x, int y) {
@@ -142,6 +531,14 @@ void goTo(int x, int y) {
   writeCommand(SSD1351_CMD_WRITERAM);
 }
 
+// Show GDDRAM row `line` at the top of the panel. This rotates the whole
+// display: the SSD1351 has no vertical scroll region, so a scrolling view
+// has to own every row. Waits for any flush in flight, like writeCommand().
+void setStartLine(unsigned char line) {
+  writeCommand(SSD1351_CMD_STARTLINE);
+  writeData(line % SSD1351HEIGHT);
+}
+
 unsigned int Color565(unsigned char r, unsigned char g, unsigned char b) {
   unsigned int c;
   c = r >> 3;
@@ -159,112 +556,239 @@ void fillScreen(unsigned int fillcolor) {
 
 void fillRect(unsigned int x, unsigned int y, unsigned int w, unsigned int h, unsigned int fillcolor)
 {
-  unsigned int i;
-
-  if ((x >= SSD1351WIDTH) || (y >= SSD1351HEIGHT))
-	return;
+#if SSD1351_FRAMEBUFFER
+  fbFill((int)x, (int)y, (int)w, (int)h, fillcolor);
+#else
+  panelFill((int)x, (int)y, (int)w, (int)h, fillcolor);
+#endif
+}
 
-  if (y+h > SSD1351HEIGHT)
-  {
-    h = SSD1351HEIGHT - y - 1;
-  }
+void drawFastVLine(int x, int y, int h, unsigned int color) {
+#if SSD1351_FRAMEBUFFER
+  fbFill(x, y, 1, h, color);
+#else
+  panelFill(x, y, 1, h, color);
+#endif
+}
 
-  if (x+w > SSD1351WIDTH)
-  {
-    w = SSD1351WIDTH - x - 1;
-  }
 
-  writeCommand(SSD1351_CMD_SETCOLUMN);
-  writeData(x);
-  writeData(x+w-1);
-  writeCommand(SSD1351_CMD_SETROW);
-  writeData(y);
-  writeData(y+h-1);
-  writeCommand(SSD1351_CMD_WRITERAM);
 
-  for (i=0; i < w*h; i++) {
-    writeData(fillcolor >> 8);
-    writeData(fillcolor);
-  }
+void drawFastHLine(int x, int y, int w, unsigned int color) {
+#if SSD1351_FRAMEBUFFER
+  fbFill(x, y, w, 1, color);
+#else
+  panelFill(x, y, w, 1, color);
+#endif
 }
 
-void drawFastVLine(int x, int y, int h, unsigned int color) {
-  unsigned int i;
-
-  if ((x >= SSD1351WIDTH) || (y >= SSD1351HEIGHT))
-	return;
 
-  if (y+h > SSD1351HEIGHT)
-  {
-    h = SSD1351HEIGHT - y - 1;
-  }
 
-  if (h < 0) return;
 
-  writeCommand(SSD1351_CMD_SETCOLUMN);
-  writeData(x);
-  writeData(x);
-  writeCommand(SSD1351_CMD_SETROW);
-  writeData(y);
-  writeData(y+h-1);
-  writeCommand(SSD1351_CMD_WRITERAM);
+void drawPixel(int x, int y, unsigned int color)
+{
+  if ((x >= SSD1351WIDTH) || (y >= SSD1351HEIGHT)) return;
+  if ((x < 0) || (y < 0)) return;
 
-  for (i=0; i < h; i++) {
-    writeData(color >> 8);
-    writeData(color);
+#if SSD1351_FRAMEBUFFER
+  if (s_frame[y][x] != (unsigned short)color) {
+    saveUnder(x, y);
+    s_frame[y][x] = (unsigned short)color;
+    markDirty(x, x, y);
   }
+#else
+  beginWindow(x, y, 1, 1);
+  pushColor(color, 1);
+  endWindow();
+#endif
 }
 
+// Open a w x h GDDRAM window at (x, y) for streaming. On the panel this
+// holds CS low with DC high until endWindow(); with the framebuffer it just
+// positions a raster cursor. Pixels wrap row by row within the window.
+void beginWindow(int x, int y, int w, int h)
+{
+#if SSD1351_FRAMEBUFFER
+  s_winX0 = s_winX = x;
+  s_winY0 = s_winY = y;
+  s_winX1 = x + w - 1;
+  s_winY1 = y + h - 1;
+#else
+  s_txBytes += OLED_WINDOW_COST;
+  panelWindow(x, y, x + w - 1, y + h - 1);
+#endif
+}
 
+// Stream count copies of one colour into the open window.
+void pushColor(unsigned int color, unsigned long count)
+{
+#if SSD1351_FRAMEBUFFER
+  while (count-- > 0) fbPut((unsigned short)color);
+#else
+  panelPushColor(color, count);
+#endif
+}
 
-void drawFastHLine(int x, int y, int w, unsigned int color) {
-  unsigned int i;
+// Stream count RGB565 pixels into the open window.
+void pushPixels(const unsigned short *pixels, unsigned long count)
+{
+#if SSD1351_FRAMEBUFFER
+  while (count-- > 0) fbPut(*pixels++);
+#else
+  panelPushPixels(pixels, count);
+#endif
+}
 
-  if ((x >= SSD1351WIDTH) || (y >= SSD1351HEIGHT))
-	return;
+void endWindow(void)
+{
+#if !SSD1351_FRAMEBUFFER
+  MAP_SPICSDisable(GSPI_BASE);
+#endif
+}
 
-  if (x+w > SSD1351WIDTH)
-  {
-    w = SSD1351WIDTH - x - 1;
-  }
 
-  if (w < 0) return;
+void  invert(char v) {
+   if (v) {
+     writeCommand(SSD1351_CMD_INVERTDISPLAY);
+   } else {
+     	writeCommand(SSD1351_CMD_NORMALDISPLAY);
+   }
+ }
+
+// Push the dirty part of the shadow framebuffer to the panel. Consecutive
+// dirty rows are merged into one SETCOLUMN/SETROW/WRITERAM window while
+// widening it costs fewer bytes than opening a new window would. With
+// SSD1351_DMA the windows are only queued here; returns 0 without touching
+// the dirty spans if the previous flush is still in flight.
+int flushDisplay(void)
+{
+#if SSD1351_FRAMEBUFFER
+  int y;
+  int gx0 = 0, gx1 = -1, gy0 = 0, rows = 0;
+  int nx0, nx1;
+  long grow, split;
+
+#if SSD1351_DMA
+  if (s_flushBusy) return 0;
+  s_queueLen = 0;
+#endif
+
+  for (y = s_dirtyY0; y <= s_dirtyY1; y++) {
+    if (s_dirtyX0[y] > s_dirtyX1[y]) {
+      if (rows > 0) sendWindow(gx0, gy0, gx1, y - 1);
+      rows = 0;
+      continue;
+    }
+
+    if (rows > 0) {
+      nx0 = (s_dirtyX0[y] < gx0) ? s_dirtyX0[y] : gx0;
+      nx1 = (s_dirtyX1[y] > gx1) ? s_dirtyX1[y] : gx1;
+      grow = 2L * ((long)(nx1 - nx0 + 1) * (rows + 1) - (long)(gx1 - gx0 + 1) * rows);
+      split = OLED_WINDOW_COST + 2L * (s_dirtyX1[y] - s_dirtyX0[y] + 1);
+      if (grow <= split) {
+        gx0 = nx0;
+        gx1 = nx1;
+        rows++;
+        continue;
+      }
+      sendWindow(gx0, gy0, gx1, y - 1);
+    }
+
+    gx0 = s_dirtyX0[y];
+    gx1 = s_dirtyX1[y];
+    gy0 = y;
+    rows = 1;
+  }
+  if (rows > 0) sendWindow(gx0, gy0, gx1, gy0 + rows - 1);
 
-  writeCommand(SSD1351_CMD_SETCOLUMN);
-  writeData(x);
-  writeData(x+w-1);
-  writeCommand(SSD1351_CMD_SETROW);
-  writeData(y);
-  writeData(y);
-  writeCommand(SSD1351_CMD_WRITERAM);
+  clearDirty();
 
-  for (i=0; i < w; i++) {
-    writeData(color >> 8);
-    writeData(color);
+#if SSD1351_DMA
+  if (s_queueLen > 0) {
+    s_queueHead = 0;
+    s_flushBusy = 1;
+    startWindow();
   }
+#endif
+#endif
+  return 1;
 }
 
+// Nonzero while a DMA flush still owns the bus. Drawing into the frame
+// buffer is fine meanwhile; flushDisplay() and panel commands are not.
+int flushBusy(void)
+{
+#if SSD1351_DMA
+  return s_flushBusy;
+#else
+  return 0;
+#endif
+}
 
+// Called from the GSPI interrupt once the last queued window of a DMA flush
+// has been clocked out to the panel.
+void setFlushCallback(void (*done)(void))
+{
+#if SSD1351_DMA
+  s_flushDone = done;
+#else
+  (void)done;
+#endif
+}
 
-
-void drawPixel(int x, int y, unsigned int color)
+// Start logging what drawing overwrites, so it can be undone later with
+// restoreSaveUnder(). Only meaningful with the framebuffer.
+void beginSaveUnder(void)
 {
-  if ((x >= SSD1351WIDTH) || (y >= SSD1351HEIGHT)) return;
-  if ((x < 0) || (y < 0)) return;
+#if SSD1351_FRAMEBUFFER
+  s_saving = 1;
+#endif
+}
 
-  goTo(x, y);
+void endSaveUnder(void)
+{
+#if SSD1351_FRAMEBUFFER
+  s_saving = 0;
+#endif
+}
 
-  writeData(color >> 8);
-  writeData(color);
+// Put back every pixel logged since the last restore, newest first, and
+// empty the log. Returns 0 if the log overflowed (or there is no
+// framebuffer), in which case the caller has to redraw the area itself.
+int restoreSaveUnder(void)
+{
+#if SSD1351_FRAMEBUFFER
+  int x, y, ok;
+
+  while (s_saveLen > 0) {
+    s_saveLen--;
+    y = s_saveIdx[s_saveLen] / SSD1351WIDTH;
+    x = s_saveIdx[s_saveLen] % SSD1351WIDTH;
+    if (s_frame[y][x] != s_saveVal[s_saveLen]) {
+      s_frame[y][x] = s_saveVal[s_saveLen];
+      markDirty(x, x, y);
+    }
+  }
+  ok = !s_saveLost;
+  s_saveLost = 0;
+  return ok;
+#else
+  return 0;
+#endif
 }
 
+// Forget the log without touching the frame, e.g. after a full redraw.
+void discardSaveUnder(void)
+{
+#if SSD1351_FRAMEBUFFER
+  s_saveLen = 0;
+  s_saveLost = 0;
+#endif
+}
 
-void  invert(char v) {
-   if (v) {
-     writeCommand(SSD1351_CMD_INVERTDISPLAY);
-   } else {
-     	writeCommand(SSD1351_CMD_NORMALDISPLAY);
-   }
- }
+// Running total of command and data bytes clocked out to the panel.
+unsigned long txByteCount(void)
+{
+  return s_txBytes;
+}
 
 
@@ -19,6 +19,21 @@
 #define SSD1351WIDTH 128
 #define SSD1351HEIGHT 128  // SET THIS TO 96 FOR 1.27"!
 
+// Rasterize every primitive into a RAM copy of the panel and push only the
+// rows that changed from flushDisplay(). Set to 0 to draw straight to the panel.
+#ifndef SSD1351_FRAMEBUFFER
+#define SSD1351_FRAMEBUFFER 1
+#endif
+
+// Let the GSPI uDMA channels clock flushDisplay() out in the background.
+// Needs the framebuffer, since the panel is written from it asynchronously.
+#ifndef SSD1351_DMA
+#define SSD1351_DMA SSD1351_FRAMEBUFFER
+#endif
+#if SSD1351_DMA && !SSD1351_FRAMEBUFFER
+#error "SSD1351_DMA requires SSD1351_FRAMEBUFFER"
+#endif
+
 //#define swap(a, b) { unsigned int t = a; a = b; b = t; }
 
 /*
@@ -112,10 +127,30 @@ class Adafruit_SSD1351  : public virtual Adafruit_GFX {
   void drawFastVLine(int x, int y, int h, unsigned int color);
   void fillScreen(unsigned int fillcolor);
 
+  // burst streaming: one window, CS held, DC set once
+  void beginWindow(int x, int y, int w, int h);
+  void pushColor(unsigned int color, unsigned long count);
+  void pushPixels(const unsigned short *pixels, unsigned long count);
+  void endWindow(void);
+
   void invert(char);
+
+  // framebuffer
+  int flushDisplay(void);
+  int flushBusy(void);
+  void setFlushCallback(void (*done)(void));
+
+  // save-under for sprites drawn over a retained background
+  void beginSaveUnder(void);
+  void endSaveUnder(void);
+  int restoreSaveUnder(void);
+  void discardSaveUnder(void);
+  unsigned long txByteCount(void);
+
   // commands
   void begin(void);
   void goTo(int x, int y);
+  void setStartLine(unsigned char line);
 
   void reset(void);
 
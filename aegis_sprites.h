@@ -0,0 +1,62 @@
+// Generated by tools/png2sprite/png2sprite.py; do not edit.
+// Sources: shield.png trophy.png (matte 000000)
+
+#ifndef _AEGIS_SPRITES_H
+#define _AEGIS_SPRITES_H
+
+#include "Adafruit_GFX.h"
+
+// 22x28, 5 colours, 282 bytes of runs (1232 raw)
+static const unsigned short sprite_shield_palette[5] = {
+  0x0000, 0xFFFF, 0x041F, 0x0219, 0x06E0,
+};
+static const unsigned char sprite_shield_data[282] = {
+  0x16, 0x00, 0x13, 0x01, 0x01, 0x00, 0x80, 0x01, 0x08, 0x02, 0x08, 0x03,
+  0x83, 0x01, 0x00, 0x00, 0x01, 0x08, 0x02, 0x08, 0x03, 0x83, 0x01, 0x00,
+  0x00, 0x01, 0x08, 0x02, 0x08, 0x03, 0x83, 0x01, 0x00, 0x00, 0x01, 0x08,
+  0x02, 0x08, 0x03, 0x83, 0x01, 0x00, 0x00, 0x01, 0x08, 0x02, 0x08, 0x03,
+  0x83, 0x01, 0x00, 0x00, 0x01, 0x08, 0x02, 0x08, 0x03, 0x83, 0x01, 0x00,
+  0x00, 0x01, 0x08, 0x02, 0x08, 0x03, 0x83, 0x01, 0x00, 0x00, 0x01, 0x08,
+  0x02, 0x08, 0x03, 0x83, 0x01, 0x00, 0x00, 0x01, 0x08, 0x02, 0x08, 0x03,
+  0x83, 0x01, 0x00, 0x00, 0x01, 0x08, 0x02, 0x04, 0x03, 0x80, 0x04, 0x02,
+  0x03, 0x83, 0x01, 0x00, 0x00, 0x01, 0x08, 0x02, 0x03, 0x03, 0x01, 0x04,
+  0x02, 0x03, 0x83, 0x01, 0x00, 0x00, 0x01, 0x03, 0x02, 0x80, 0x04, 0x03,
+  0x02, 0x02, 0x03, 0x01, 0x04, 0x03, 0x03, 0x83, 0x01, 0x00, 0x00, 0x01,
+  0x03, 0x02, 0x01, 0x04, 0x02, 0x02, 0x01, 0x03, 0x01, 0x04, 0x04, 0x03,
+  0x83, 0x01, 0x00, 0x00, 0x01, 0x04, 0x02, 0x01, 0x04, 0x01, 0x02, 0x82,
+  0x03, 0x04, 0x04, 0x05, 0x03, 0x83, 0x01, 0x00, 0x00, 0x01, 0x05, 0x02,
+  0x01, 0x04, 0x82, 0x02, 0x04, 0x04, 0x06, 0x03, 0x83, 0x01, 0x00, 0x00,
+  0x01, 0x06, 0x02, 0x02, 0x04, 0x07, 0x03, 0x83, 0x01, 0x00, 0x00, 0x01,
+  0x07, 0x02, 0x80, 0x04, 0x08, 0x03, 0x80, 0x01, 0x02, 0x00, 0x80, 0x01,
+  0x07, 0x02, 0x07, 0x03, 0x80, 0x01, 0x04, 0x00, 0x80, 0x01, 0x06, 0x02,
+  0x06, 0x03, 0x80, 0x01, 0x06, 0x00, 0x80, 0x01, 0x05, 0x02, 0x05, 0x03,
+  0x80, 0x01, 0x08, 0x00, 0x80, 0x01, 0x04, 0x02, 0x04, 0x03, 0x80, 0x01,
+  0x0A, 0x00, 0x80, 0x01, 0x03, 0x02, 0x03, 0x03, 0x80, 0x01, 0x0C, 0x00,
+  0x80, 0x01, 0x02, 0x02, 0x02, 0x03, 0x80, 0x01, 0x0E, 0x00, 0x85, 0x01,
+  0x02, 0x02, 0x03, 0x03, 0x01, 0x10, 0x00, 0x83, 0x01, 0x02, 0x03, 0x01,
+  0x12, 0x00, 0x01, 0x01, 0x09, 0x00,
+};
+static const Sprite sprite_shield = {22, 28, -1, sprite_shield_palette, sprite_shield_data};
+
+// 22x28, 5 colours, 153 bytes of runs (1232 raw)
+static const unsigned short sprite_trophy_palette[5] = {
+  0x0000, 0xFFD2, 0xFEE0, 0xFC60, 0x3940,
+};
+static const unsigned char sprite_trophy_data[153] = {
+  0x2D, 0x00, 0x05, 0x01, 0x0B, 0x02, 0x03, 0x00, 0x05, 0x01, 0x0B, 0x02,
+  0x01, 0x00, 0x03, 0x03, 0x03, 0x01, 0x09, 0x02, 0x04, 0x03, 0x80, 0x00,
+  0x05, 0x01, 0x0B, 0x02, 0x83, 0x00, 0x03, 0x03, 0x00, 0x05, 0x01, 0x0B,
+  0x02, 0x83, 0x00, 0x03, 0x03, 0x00, 0x05, 0x01, 0x0B, 0x02, 0x83, 0x00,
+  0x03, 0x03, 0x00, 0x05, 0x01, 0x0B, 0x02, 0x80, 0x00, 0x04, 0x03, 0x03,
+  0x01, 0x09, 0x02, 0x03, 0x03, 0x03, 0x00, 0x03, 0x01, 0x09, 0x02, 0x08,
+  0x00, 0x02, 0x01, 0x08, 0x02, 0x0A, 0x00, 0x01, 0x01, 0x07, 0x02, 0x0B,
+  0x00, 0x01, 0x01, 0x07, 0x02, 0x0C, 0x00, 0x80, 0x01, 0x06, 0x02, 0x0F,
+  0x00, 0x03, 0x03, 0x11, 0x00, 0x03, 0x03, 0x11, 0x00, 0x03, 0x03, 0x11,
+  0x00, 0x03, 0x03, 0x11, 0x00, 0x03, 0x03, 0x0E, 0x00, 0x09, 0x02, 0x0B,
+  0x00, 0x09, 0x02, 0x0B, 0x00, 0x09, 0x02, 0x09, 0x00, 0x0D, 0x04, 0x07,
+  0x00, 0x03, 0x04, 0x05, 0x02, 0x03, 0x04, 0x07, 0x00, 0x03, 0x04, 0x05,
+  0x02, 0x03, 0x04, 0x07, 0x00, 0x0D, 0x04, 0x19, 0x00,
+};
+static const Sprite sprite_trophy = {22, 28, -1, sprite_trophy_palette, sprite_trophy_data};
+
+#endif // _AEGIS_SPRITES_H
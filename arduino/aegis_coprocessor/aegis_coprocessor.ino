@@ -1,6 +1,24 @@
 #include <SoftwareSerial.h>
 #include <Servo.h>
 #include <stdio.h>
+#include "link_codec.h"
+
+// Bus transport, chosen at build time:
+//   BUS_SOFT_SERIAL  SoftwareSerial on D10/D11, debug log and console on USB.
+//                    Every received byte holds interrupts off for a whole
+//                    character time (~1 ms at 9600), which jitters the
+//                    stepper and stretches pulseIn() readings.
+//   BUS_HW_UART      Hardware UART on D0/D1 (disconnect the bus to upload).
+//                    The debug log moves to a TX-only SoftwareSerial on D11;
+//                    D10 is left unconnected so it never interrupts, and
+//                    there is no serial console.
+// An input-capture receiver does not fit this board: ICP1 is D8 (PIN_ECHO)
+// and Timer1 is taken by the servo.
+#define BUS_SOFT_SERIAL 0
+#define BUS_HW_UART     1
+#ifndef BUS_TRANSPORT
+#define BUS_TRANSPORT   BUS_SOFT_SERIAL
+#endif
 
 static const int BUS_RX = 10;
 static const int BUS_TX = 11;
@@ -27,17 +45,61 @@ static const int PIN_RGB_B = A5;
 static const int RADAR_SWEEP_STEPS = 512;
 static const int SECTOR_COUNT = 16;
 
+#if BUS_TRANSPORT == BUS_HW_UART
+SoftwareSerial debugPort(BUS_RX, BUS_TX);
+HardwareSerial &bus = Serial;
+Print &dbg = debugPort;
+#else
 SoftwareSerial bus(BUS_RX, BUS_TX);
+Print &dbg = Serial;
+#endif
+
+static void busListen(void) {
+#if BUS_TRANSPORT == BUS_SOFT_SERIAL
+  bus.listen();
+#endif
+}
+
 Servo shieldServo;
 
 char busLine[96];
 int busLineIdx = 0;
+int busBinary = 0;
 char serialLine[96];
 int serialLineIdx = 0;
 unsigned long g_busRxBytes = 0;
 unsigned long g_busRxLines = 0;
 unsigned long g_ctrlFrames = 0;
 unsigned long g_pingFrames = 0;
+unsigned long g_linkRxErrors = 0;
+
+// Set once the master asks for binary frames with LINK_PING_BINARY; a plain
+// PING (old master) puts the sensor frames back on ASCII.
+int g_linkBinary = 0;
+unsigned char g_linkTxSeq = 0;
+
+// Bus rate, stepped by the master's $B command. Any rate above the base one
+// is dropped again after LINK_BAUD_SILENCE_MS without a valid control frame.
+static const unsigned long BAUD_RATES[LINK_BAUD_STEPS] = LINK_BAUD_RATES;
+unsigned long g_busBaud = 9600;
+unsigned long g_lastBusOkMs = 0;
+
+// refMs of the last control frame that answered one of our $S frames; echoed
+// back as "$L,<refMs>,<appliedMs>" once applyOutputs() has driven it, so the
+// master can time sensor-to-actuator latency on our own clock.
+unsigned long g_echoRefMs = 0;
+unsigned long g_lastEchoRefMs = 0;
+unsigned long g_echoFrames = 0;
+
+// Latest range per sector, sent as one sweep frame every SWEEP_FRAME_MS in
+// binary mode: a delta against g_sweepSentCm, with a key frame every
+// SWEEP_KEY_EVERY sweeps so a master that missed one catches up.
+static const unsigned long SWEEP_FRAME_MS = 720;
+static const unsigned char SWEEP_KEY_EVERY = 8;
+int g_sweepCm[SECTOR_COUNT];
+int g_sweepSentCm[SECTOR_COUNT];
+unsigned char g_sweepNo = 0;
+unsigned long g_lastSweepMs = 0;
 
 int g_servoDeg = 90;
 int g_stepMode = 2;
@@ -59,6 +121,22 @@ int g_aux = 0;
 int g_joyX = 512;
 int g_joyY = 512;
 
+// Transport bench figures, reset with every DBG line: how far the gap
+// between radar steps strays from the 8 ms cadence (gaps that include a
+// ranging burst are left out), how far apart the three raw echo readings
+// behind one distance are, and link decode errors per 10k bus bytes. Run
+// it with the link in binary mode, since ASCII lines carry no CRC.
+unsigned long g_stepLastUs = 0;
+int g_stepSkip = 1;
+unsigned long g_stepJitterSumUs = 0;
+unsigned long g_stepJitterMaxUs = 0;
+unsigned long g_stepGaps = 0;
+unsigned long g_echoSpreadSum = 0;
+int g_echoSpreadMax = 0;
+unsigned long g_echoReads = 0;
+unsigned long g_benchBusBytes = 0;
+unsigned long g_benchLinkErrors = 0;
+
 unsigned long g_lastSensorMs = 0;
 unsigned long g_lastFrameMs = 0;
 unsigned long g_lastStepMs = 0;
@@ -106,6 +184,11 @@ static int readDistanceCm(void) {
   int b = readDistanceRawCm();
   int c = readDistanceRawCm();
   int dist = median3(a, b, c);
+  int spread = max(a, max(b, c)) - min(a, min(b, c));
+
+  if (spread > g_echoSpreadMax) g_echoSpreadMax = spread;
+  g_echoSpreadSum += spread;
+  g_echoReads++;
 
   if (dist >= 400) return lastGood;
   lastGood = dist;
@@ -179,6 +262,21 @@ static void stepMotor(int delta) {
   applyStepPhase(g_stepIndex);
 }
 
+static void noteStepTime(void) {
+  unsigned long us = micros();
+  unsigned long gap = us - g_stepLastUs;
+  unsigned long jitter = (gap > 8000UL) ? gap - 8000UL : 8000UL - gap;
+
+  g_stepLastUs = us;
+  if (g_stepSkip) {
+    g_stepSkip = 0;
+    return;
+  }
+  if (jitter > g_stepJitterMaxUs) g_stepJitterMaxUs = jitter;
+  g_stepJitterSumUs += jitter;
+  g_stepGaps++;
+}
+
 static void stepRadar(void) {
   unsigned long now = millis();
   if (now - g_lastStepMs < 8) return;
@@ -198,6 +296,9 @@ static void stepRadar(void) {
   if (stepDelta != 0) {
     stepMotor(stepDelta);
     g_radarPos += stepDelta;
+    noteStepTime();
+  } else {
+    g_stepSkip = 1;
   }
 
   long shifted = g_radarPos + RADAR_SWEEP_STEPS;
@@ -215,6 +316,8 @@ static void sampleSensors(void) {
   g_lastSensorMs = now;
 
   g_distCm = readDistanceCm();
+  g_stepSkip = 1;
+  g_sweepCm[g_sector] = g_distCm;
   g_lux = smoothAnalogRead(PIN_LIGHT, g_lux);
   g_tilt = 0;
   g_joyX = smoothAnalogRead(PIN_JOY_X, g_joyX);
@@ -229,6 +332,24 @@ static void sendSensorFrame(void) {
   if (now - g_lastFrameMs < 180) return;
   g_lastFrameMs = now;
 
+  if (g_linkBinary) {
+    LinkSensor sensor;
+    unsigned char wire[LINK_WIRE_MAX];
+
+    sensor.ms = now;
+    sensor.sector = g_sector;
+    sensor.distCm = g_distCm;
+    sensor.lux = g_lux;
+    sensor.tilt = g_tilt;
+    sensor.tempC10 = g_tempC10;
+    sensor.hum10 = g_hum10;
+    sensor.aux = g_aux;
+    sensor.joy = g_joyX;
+    bus.write(wire, LinkEncodeSensor(&sensor, g_linkTxSeq++, wire));
+    busListen();
+    return;
+  }
+
   char frame[128];
   snprintf(frame,
            sizeof(frame),
@@ -244,7 +365,92 @@ static void sendSensorFrame(void) {
            g_joyX);
 
   bus.print(frame);
-  bus.listen();
+  busListen();
+}
+
+static void sendSweepFrame(void) {
+  if (!g_linkBinary) return;
+  unsigned long now = millis();
+  if (now - g_lastSweepMs < SWEEP_FRAME_MS) return;
+  g_lastSweepMs = now;
+
+  LinkSweep sweep;
+  unsigned char wire[LINK_WIRE_MAX];
+
+  LinkSweepBuild(&sweep, g_sweepNo, g_sweepCm,
+                 (g_sweepNo % SWEEP_KEY_EVERY) ? g_sweepSentCm : 0);
+  bus.write(wire, LinkEncodeSweep(&sweep, g_linkTxSeq++, wire));
+  busListen();
+  for (int i = 0; i < SECTOR_COUNT; i++) g_sweepSentCm[i] = g_sweepCm[i];
+  g_sweepNo++;
+}
+
+// Both transports finish sending before end(), so an ack written just
+// before a rate change still goes out at the old rate.
+static void setBusBaud(unsigned long baud) {
+  bus.end();
+  bus.begin(baud);
+  busListen();
+  busLineIdx = 0;
+  g_busBaud = baud;
+  g_lastBusOkMs = millis();
+}
+
+static int validBaud(unsigned long baud) {
+  for (int i = 0; i < LINK_BAUD_STEPS; i++) {
+    if (BAUD_RATES[i] == baud) return 1;
+  }
+  return 0;
+}
+
+static void checkBusSilence(void) {
+  if (g_busBaud == BAUD_RATES[0]) return;
+  if (millis() - g_lastBusOkMs < LINK_BAUD_SILENCE_MS) return;
+  setBusBaud(BAUD_RATES[0]);
+}
+
+static void applyControl(int servo, int stepMode, int buzzMode, int rgbCode, int roundState,
+                         unsigned long refMs) {
+  g_servoDeg = clampInt(servo, 0, 180);
+  g_stepMode = clampInt(stepMode, -1, 2);
+  g_buzzMode = clampInt(buzzMode, 0, 2);
+  g_rgbCode = clampInt(rgbCode, 0, 6);
+  g_roundState = clampInt(roundState, 0, 9);
+  g_ctrlFrames++;
+  g_lastBusOkMs = millis();
+  if (refMs != 0 && refMs != g_lastEchoRefMs) g_echoRefMs = refMs;
+}
+
+static void sendAppliedEcho(void) {
+  if (g_echoRefMs == 0) return;
+
+  LinkApplied applied;
+  applied.refMs = g_echoRefMs;
+  applied.appliedMs = millis();
+  g_lastEchoRefMs = g_echoRefMs;
+  g_echoRefMs = 0;
+  g_echoFrames++;
+
+  if (g_linkBinary) {
+    unsigned char wire[LINK_WIRE_MAX];
+    bus.write(wire, LinkEncodeApplied(&applied, g_linkTxSeq++, wire));
+  } else {
+    char line[40];
+    snprintf(line, sizeof(line), "$L,%lu,%lu\n", applied.refMs, applied.appliedMs);
+    bus.print(line);
+  }
+  busListen();
+}
+
+// Clock exchange for the master's timebase: t2 is when the request line was
+// parsed, t3 just before the reply goes out.
+static void answerTimePing(unsigned long t1) {
+  unsigned long t2 = millis();
+  char line[48];
+
+  snprintf(line, sizeof(line), LINK_TIME_ACK "%lu,%lu,%lu", t1, t2, millis());
+  bus.println(line);
+  busListen();
 }
 
 static void parseControl(const char *line) {
@@ -253,32 +459,85 @@ static void parseControl(const char *line) {
   int buzzMode = 0;
   int rgbCode = 0;
   int roundState = 0;
+  unsigned long refMs = 0;
+  unsigned long baud = 0;
+  unsigned long t1 = 0;
+
+  // The sixth field (refMs) is optional so older masters still work
+  if (sscanf(line, "$C,%d,%d,%d,%d,%d,%lu", &servo, &stepMode, &buzzMode, &rgbCode, &roundState,
+             &refMs) >= 5) {
+    applyControl(servo, stepMode, buzzMode, rgbCode, roundState, refMs);
+    return;
+  }
+
+  if (sscanf(line, LINK_TIME_CMD "%lu", &t1) == 1) {
+    answerTimePing(t1);
+    return;
+  }
+
+  if (sscanf(line, LINK_BAUD_CMD "%lu", &baud) == 1) {
+    if (!validBaud(baud)) return;
+    bus.print(LINK_BAUD_ACK);
+    bus.println(baud);
+    setBusBaud(baud);
+    return;
+  }
 
-  if (sscanf(line, "$C,%d,%d,%d,%d,%d", &servo, &stepMode, &buzzMode, &rgbCode, &roundState) == 5) {
-    g_servoDeg = clampInt(servo, 0, 180);
-    g_stepMode = clampInt(stepMode, -1, 2);
-    g_buzzMode = clampInt(buzzMode, 0, 2);
-    g_rgbCode = clampInt(rgbCode, 0, 6);
-    g_roundState = clampInt(roundState, 0, 9);
-    g_ctrlFrames++;
+  if (strcmp(line, LINK_PING_BINARY) == 0) {
+    g_pingFrames++;
+    g_linkBinary = 1;
+    g_sweepNo = 0;   // start the new link on a key frame
+    bus.println(LINK_PONG_BINARY);
     return;
   }
 
   if (strcmp(line, "PING") == 0) {
     g_pingFrames++;
+    g_linkBinary = 0;
     bus.println("$A,PONG");
     return;
   }
 }
 
+static void parseBinary(const unsigned char *wire, int len) {
+  LinkFrame frame;
+
+  if (LinkDecode(wire, len, &frame) != LINK_TYPE_CONTROL) {
+    g_linkRxErrors++;
+    return;
+  }
+  applyControl(frame.u.control.servoDeg, frame.u.control.stepMode,
+               frame.u.control.buzzMode, frame.u.control.rgbCode,
+               frame.u.control.state, frame.u.control.refMs);
+}
+
+// A 0x00 switches to binary: bytes up to the next 0x00 are one COBS frame
+// (see link_codec.h). A '$' at the start of a frame switches back to ASCII
+// lines ending at CR/LF (see link_codec.h), which may contain '$' or LF.
 static void pollBus(void) {
   while (bus.available()) {
     char c = (char)bus.read();
     g_busRxBytes++;
-    if (c == '$') {
+    if (c == 0) {
+      busBinary = 1;
+      if (busLineIdx > 0) {
+        g_busRxLines++;
+        parseBinary((const unsigned char *)busLine, busLineIdx);
+      }
       busLineIdx = 0;
+      continue;
     }
-    if (c == '\r' || c == '\n') {
+    if (busBinary && busLineIdx >= LINK_WIRE_MAX - 2) {
+      // Longer than any frame: the peer is back on ASCII lines
+      g_linkRxErrors++;
+      busBinary = 0;
+      busLineIdx = 0;
+    }
+    if (c == '$' && (!busBinary || busLineIdx == 0)) {
+      busBinary = 0;
+      busLineIdx = 0;
+    }
+    if (!busBinary && (c == '\r' || c == '\n')) {
       busLine[busLineIdx] = '\0';
       if (busLineIdx > 0) {
         g_busRxLines++;
@@ -295,6 +554,8 @@ static void pollBus(void) {
 }
 
 static void pollSerial(void) {
+  // With BUS_HW_UART, Serial is the bus and there is no console
+#if BUS_TRANSPORT == BUS_SOFT_SERIAL
   while (Serial.available()) {
     char c = (char)Serial.read();
     if (c == '\r' || c == '\n') {
@@ -308,12 +569,33 @@ static void pollSerial(void) {
       serialLine[serialLineIdx++] = c;
     }
   }
+#endif
+}
+
+static void resetBench(void) {
+  g_stepJitterSumUs = 0;
+  g_stepJitterMaxUs = 0;
+  g_stepGaps = 0;
+  g_echoSpreadSum = 0;
+  g_echoSpreadMax = 0;
+  g_echoReads = 0;
+  g_benchBusBytes = g_busRxBytes;
+  g_benchLinkErrors = g_linkRxErrors;
 }
 
 void setup() {
+#if BUS_TRANSPORT == BUS_HW_UART
+  debugPort.begin(115200);
+#else
   Serial.begin(115200);
-  bus.begin(9600);
-  bus.listen();
+#endif
+  bus.begin(g_busBaud);
+  busListen();
+
+  for (int i = 0; i < SECTOR_COUNT; i++) {
+    g_sweepCm[i] = 400;
+    g_sweepSentCm[i] = 400;
+  }
 
   pinMode(PIN_TRIG, OUTPUT);
   pinMode(PIN_ECHO, INPUT);
@@ -333,36 +615,60 @@ void setup() {
 
   applyOutputs();
 
-  Serial.println("AEGIS coprocessor ready");
-  Serial.println("Expecting: $C,<servo>,<step>,<buzz>,<rgb>,<state>");
+  dbg.println("AEGIS coprocessor ready");
+  dbg.println(BUS_TRANSPORT == BUS_HW_UART ? "Bus: hardware UART" : "Bus: SoftwareSerial");
+  dbg.println("Expecting: $C,<servo>,<step>,<buzz>,<rgb>,<state>[,<refMs>]");
 }
 
 void loop() {
   pollBus();
   pollSerial();
+  checkBusSilence();
 
   stepRadar();
   sampleSensors();
   applyOutputs();
+  sendAppliedEcho();
   sendSensorFrame();
+  sendSweepFrame();
 
   if (millis() - g_lastLogMs >= 1000) {
     g_lastLogMs = millis();
-    Serial.print("DBG busB=");
-    Serial.print(g_busRxBytes);
-    Serial.print(" busL=");
-    Serial.print(g_busRxLines);
-    Serial.print(" ctrl=");
-    Serial.print(g_ctrlFrames);
-    Serial.print(" ping=");
-    Serial.print(g_pingFrames);
-    Serial.print(" joyX=");
-    Serial.print(g_joyX);
-    Serial.print(" joyY=");
-    Serial.print(g_joyY);
-    Serial.print(" rgb=");
-    Serial.print(g_rgbCode);
-    Serial.print(" state=");
-    Serial.println(g_roundState);
+    dbg.print("DBG busB=");
+    dbg.print(g_busRxBytes);
+    dbg.print(" busL=");
+    dbg.print(g_busRxLines);
+    dbg.print(" ctrl=");
+    dbg.print(g_ctrlFrames);
+    dbg.print(" ping=");
+    dbg.print(g_pingFrames);
+    dbg.print(" link=");
+    dbg.print(g_linkBinary ? "bin" : "asc");
+    dbg.print(" baud=");
+    dbg.print(g_busBaud);
+    dbg.print(" lerr=");
+    dbg.print(g_linkRxErrors);
+    dbg.print(" echo=");
+    dbg.print(g_echoFrames);
+    dbg.print(" stj=");
+    dbg.print(g_stepGaps ? g_stepJitterSumUs / g_stepGaps : 0);
+    dbg.print("/");
+    dbg.print(g_stepJitterMaxUs);
+    dbg.print(" esp=");
+    dbg.print(g_echoReads ? g_echoSpreadSum / g_echoReads : 0);
+    dbg.print("/");
+    dbg.print(g_echoSpreadMax);
+    dbg.print(" ber=");
+    dbg.print(g_busRxBytes > g_benchBusBytes ?
+              (g_linkRxErrors - g_benchLinkErrors) * 10000UL / (g_busRxBytes - g_benchBusBytes) : 0);
+    dbg.print(" joyX=");
+    dbg.print(g_joyX);
+    dbg.print(" joyY=");
+    dbg.print(g_joyY);
+    dbg.print(" rgb=");
+    dbg.print(g_rgbCode);
+    dbg.print(" state=");
+    dbg.println(g_roundState);
+    resetBench();
   }
 }
@@ -1,5 +1,6 @@
 #include <SoftwareSerial.h>
 #include <stdio.h>
+#include "link_codec.h"
 
 static const int BUS_RX = 10;
 static const int BUS_TX = 11;
@@ -23,11 +24,21 @@ static const int ACTIVE_ROUND_MS = 45000;
 static const int JUDGE_MS = 2200;
 
 static const int SECTOR_COUNT = 16;
+static const int LINK_PING_MS = 400;
+static const int LINK_PING_TRIES = 5;
+static const unsigned long BAUD_DWELL_MS = 6000;
+static const unsigned long BAUD_ACK_MS = 400;
+static const unsigned long BAUD_PROBE_MS = 2000;
+static const int BAUD_ASK_TRIES = 3;
+static const unsigned long BAUD_MIN_FRAMES = 6;
+static const unsigned long BAUD_MAX_ERR_PCT = 10;
+static const unsigned long BAUD_RATES[LINK_BAUD_STEPS] = LINK_BAUD_RATES;
 
 SoftwareSerial bus(BUS_RX, BUS_TX);
 
 char busLine[128];
 int busLineIdx = 0;
+int busBinary = 0;
 char serialLine[128];
 int serialLineIdx = 0;
 
@@ -74,6 +85,42 @@ unsigned long g_lastLogMs = 0;
 unsigned long g_lastLcdMs = 0;
 int g_waitingForSensor = 0;
 
+// LOAD console command: send control frames back to back every
+// LOAD_CONTROL_MS instead of pacing them on sensor frames, to load the
+// coprocessor's bus receiver for its transport bench (stj/esp/ber).
+static const unsigned long LOAD_CONTROL_MS = 20;
+int g_loadTest = 0;
+
+// Binary link negotiation: ping with LINK_PING_BINARY until the coprocessor
+// answers; a plain $A,PONG (old firmware) keeps the ASCII frames.
+int g_linkBinary = 0;
+int g_linkPingTries = 0;
+unsigned long g_lastLinkPingMs = 0;
+unsigned char g_linkTxSeq = 0;
+unsigned long g_linkRxFrames = 0;
+unsigned long g_linkRxErrors = 0;
+unsigned long g_busOk = 0;
+unsigned long g_busBad = 0;
+
+// Bus rate ladder, same scheme as the CC3200 firmware: step up after a clean
+// BAUD_DWELL_MS, keep the new rate only if BAUD_PROBE_MS of traffic at it is
+// clean, fall back one step on errors and to the base rate on silence.
+enum BaudState {
+  BAUD_IDLE = 0,
+  BAUD_ASKED = 1,
+  BAUD_PROBE = 2
+};
+
+BaudState g_baudState = BAUD_IDLE;
+int g_baudIdx = 0;
+int g_baudCeiling = LINK_BAUD_STEPS - 1;
+int g_baudTarget = 0;
+int g_baudTries = 0;
+unsigned long g_baudStateMs = 0;
+unsigned long g_baudWindowOk = 0;
+unsigned long g_baudWindowBad = 0;
+unsigned long g_baudFallbacks = 0;
+
 int g_prevStartBtn = HIGH;
 int g_prevJoyBtn = HIGH;
 
@@ -217,10 +264,29 @@ static void setState(RoundState next) {
 
 static void sendControlFrame(void) {
   unsigned long now = millis();
-  if (g_waitingForSensor && (now - g_lastControlTxMs) < 160) return;
-  if (!g_waitingForSensor && (now - g_lastControlTxMs) < 90) return;
+  if (g_loadTest) {
+    if (now - g_lastControlTxMs < LOAD_CONTROL_MS) return;
+  } else {
+    if (g_waitingForSensor && (now - g_lastControlTxMs) < 160) return;
+    if (!g_waitingForSensor && (now - g_lastControlTxMs) < 90) return;
+  }
   g_lastControlTxMs = now;
 
+  if (g_linkBinary) {
+    LinkControl ctrl;
+    unsigned char wire[LINK_WIRE_MAX];
+
+    ctrl.refMs = 0;   // no latency echo wanted from the emulator
+    ctrl.servoDeg = g_servoDeg;
+    ctrl.stepMode = g_stepMode;
+    ctrl.buzzMode = g_buzzMode;
+    ctrl.rgbCode = g_rgbCode;
+    ctrl.state = (int)g_state;
+    bus.write(wire, LinkEncodeControl(&ctrl, g_linkTxSeq++, wire));
+    g_waitingForSensor = 1;
+    return;
+  }
+
   char out[96];
   snprintf(out,
            sizeof(out),
@@ -234,39 +300,172 @@ static void sendControlFrame(void) {
   g_waitingForSensor = 1;
 }
 
-static void handleSensorLine(const char *line) {
-  unsigned long ms = 0;
-  int sector = 0;
-  int distCm = 0;
-  int lux = 0;
-  int tilt = 0;
-  int tempC10 = 0;
-  int hum10 = 0;
-  int irRaw = 0;
-  int joy = 0;
-
-  if (sscanf(line,
-             "$S,%lu,%d,%d,%d,%d,%d,%d,%d,%d",
-             &ms,
-             &sector,
-             &distCm,
-             &lux,
-             &tilt,
-             &tempC10,
-             &hum10,
-             &irRaw,
-             &joy) == 9) {
-    g_sensor.ms = ms;
-    g_sensor.sector = clampInt(sector, 0, SECTOR_COUNT - 1);
-    g_sensor.distCm = clampInt(distCm, 2, 400);
-    g_sensor.lux = clampInt(lux, 0, 1023);
-    g_sensor.tilt = (tilt != 0) ? 1 : 0;
-    g_sensor.tempC10 = clampInt(tempC10, -200, 800);
-    g_sensor.hum10 = clampInt(hum10, 0, 1000);
-    g_sensor.irRaw = (irRaw != 0) ? 1 : 0;
-    g_sensor.joy = joy;
-    g_lastSensorRxMs = millis();
+static void linkNegotiate(void) {
+  unsigned long now = millis();
+  if (g_linkBinary || g_linkPingTries >= LINK_PING_TRIES) return;
+  if (g_linkPingTries > 0 && (now - g_lastLinkPingMs) < LINK_PING_MS) return;
+  g_lastLinkPingMs = now;
+  g_linkPingTries++;
+  bus.print(LINK_PING_BINARY "\n");
+}
+
+static void setBusBaud(int idx) {
+  bus.end();
+  bus.begin(BAUD_RATES[idx]);
+  busLineIdx = 0;
+  g_baudIdx = idx;
+  Serial.print("LINK: baud ");
+  Serial.println(BAUD_RATES[idx]);
+}
+
+static void baudWindowStart(void) {
+  g_baudStateMs = millis();
+  g_baudWindowOk = g_busOk;
+  g_baudWindowBad = g_busBad;
+}
+
+static int baudWindowHealth(void) {
+  unsigned long ok = g_busOk - g_baudWindowOk;
+  unsigned long bad = g_busBad - g_baudWindowBad;
+
+  if (bad * 100UL > (ok + bad) * BAUD_MAX_ERR_PCT) return -1;
+  if (ok < BAUD_MIN_FRAMES) return 0;
+  return 1;
+}
+
+static void baudRequest(int target) {
+  g_baudTarget = target;
+  g_baudState = BAUD_ASKED;
+  g_baudStateMs = millis();
+  bus.print(LINK_BAUD_CMD);
+  bus.println(BAUD_RATES[target]);
+}
+
+static void baudAcked(unsigned long baud) {
+  if (g_baudState != BAUD_ASKED || baud != BAUD_RATES[g_baudTarget]) return;
+  int up = g_baudTarget > g_baudIdx;
+  setBusBaud(g_baudTarget);
+  g_baudState = up ? BAUD_PROBE : BAUD_IDLE;
+  g_lastSensorRxMs = millis();
+  baudWindowStart();
+}
+
+static void linkBaudStep(void) {
+  unsigned long now = millis();
+  int health;
+
+  if (g_baudIdx > 0 && (now - g_lastSensorRxMs) > LINK_BAUD_SILENCE_MS) {
+    if (g_baudState == BAUD_PROBE) g_baudCeiling = g_baudIdx - 1;
+    g_baudFallbacks++;
+    g_baudState = BAUD_IDLE;
+    setBusBaud(0);
+    baudWindowStart();
+    return;
+  }
+
+  if (g_baudState == BAUD_IDLE) {
+    if (now - g_baudStateMs < BAUD_DWELL_MS) return;
+    health = baudWindowHealth();
+    g_baudTries = 0;
+    if (health < 0 && g_baudIdx > 0) {
+      g_baudCeiling = g_baudIdx - 1;
+      g_baudFallbacks++;
+      baudRequest(g_baudIdx - 1);
+    } else if (health > 0 && g_baudIdx < g_baudCeiling) {
+      baudRequest(g_baudIdx + 1);
+    } else {
+      baudWindowStart();
+    }
+    return;
+  }
+
+  if (g_baudState == BAUD_ASKED) {
+    if (now - g_baudStateMs < BAUD_ACK_MS) return;
+    if (++g_baudTries < BAUD_ASK_TRIES) {
+      baudRequest(g_baudTarget);
+      return;
+    }
+    if (g_baudTarget < g_baudIdx) {
+      setBusBaud(g_baudTarget);
+    } else {
+      g_baudCeiling = g_baudIdx;
+    }
+    g_baudState = BAUD_IDLE;
+    baudWindowStart();
+    return;
+  }
+
+  if (now - g_baudStateMs < BAUD_PROBE_MS) return;
+  if (baudWindowHealth() > 0) {
+    g_baudState = BAUD_IDLE;
+    baudWindowStart();
+    return;
+  }
+  g_baudCeiling = g_baudIdx - 1;
+  g_baudFallbacks++;
+  g_baudTries = 0;
+  baudRequest(g_baudIdx - 1);
+}
+
+static void applySensor(const LinkSensor *s) {
+  g_sensor.ms = s->ms;
+  g_sensor.sector = clampInt(s->sector, 0, SECTOR_COUNT - 1);
+  g_sensor.distCm = clampInt(s->distCm, 2, 400);
+  g_sensor.lux = clampInt(s->lux, 0, 1023);
+  g_sensor.tilt = (s->tilt != 0) ? 1 : 0;
+  g_sensor.tempC10 = clampInt(s->tempC10, -200, 800);
+  g_sensor.hum10 = clampInt(s->hum10, 0, 1000);
+  g_sensor.irRaw = (s->aux != 0) ? 1 : 0;
+  g_sensor.joy = s->joy;
+  g_busOk++;
+  g_lastSensorRxMs = millis();
+  g_waitingForSensor = 0;
+}
+
+static void handleSensorBinary(const unsigned char *wire, int len) {
+  LinkFrame frame;
+  int type = LinkDecode(wire, len, &frame);
+
+  if (type == LINK_TYPE_SWEEP || type == LINK_TYPE_APPLIED) {
+    // Valid, just nothing the emulator shows
+    g_linkRxFrames++;
+    g_busOk++;
+    return;
+  }
+  if (type != LINK_TYPE_SENSOR) {
+    g_linkRxErrors++;
+    g_busBad++;
+    return;
+  }
+  g_linkRxFrames++;
+  applySensor(&frame.u.sensor);
+}
+
+static void handleSensorLine(const char *line, int len) {
+  LinkSensor sensor;
+  unsigned long baud = 0;
+
+  if (LinkParseSensorText(line, len, &sensor) == 0) {
+    applySensor(&sensor);
+    return;
+  }
+
+  if (sscanf(line, LINK_BAUD_ACK "%lu", &baud) == 1) {
+    baudAcked(baud);
+    return;
+  }
+
+  if (strcmp(line, LINK_PONG_BINARY) == 0) {
+    g_linkBinary = 1;
     g_waitingForSensor = 0;
+    Serial.println("LINK: binary");
+    return;
+  }
+
+  if (strcmp(line, "$A,PONG") == 0) {
+    g_linkPingTries = LINK_PING_TRIES;
+    g_waitingForSensor = 0;
+    Serial.println("LINK: ascii");
     return;
   }
 
@@ -277,16 +476,39 @@ static void handleSensorLine(const char *line) {
     return;
   }
 
+  g_busBad++;
   Serial.print("Bad bus line: ");
   Serial.println(line);
 }
 
+// A 0x00 switches to binary: bytes up to the next 0x00 are one COBS frame
+// (see link_codec.h). A '$' at the start of a frame switches back to ASCII
+// lines ending at CR/LF (see link_codec.h).
 static void pollBus(void) {
   while (bus.available()) {
     char c = (char)bus.read();
-    if (c == '\r' || c == '\n') {
+    if (c == 0) {
+      busBinary = 1;
+      if (busLineIdx > 0) {
+        handleSensorBinary((const unsigned char *)busLine, busLineIdx);
+      }
+      busLineIdx = 0;
+      continue;
+    }
+    if (busBinary && busLineIdx >= LINK_WIRE_MAX - 2) {
+      // Longer than any frame: the peer is back on ASCII lines
+      g_linkRxErrors++;
+      g_busBad++;
+      busBinary = 0;
+      busLineIdx = 0;
+    }
+    if (c == '$' && (!busBinary || busLineIdx == 0)) {
+      busBinary = 0;
+      busLineIdx = 0;
+    }
+    if (!busBinary && (c == '\r' || c == '\n')) {
       busLine[busLineIdx] = '\0';
-      if (busLineIdx > 0) handleSensorLine(busLine);
+      if (busLineIdx > 0) handleSensorLine(busLine, busLineIdx);
       busLineIdx = 0;
       continue;
     }
@@ -314,6 +536,18 @@ static void handleSerialCommand(const char *line) {
     return;
   }
 
+  if (strcmp(line, "LINK") == 0 || strcmp(line, "link") == 0) {
+    g_linkBinary = 0;
+    g_linkPingTries = 0;
+    return;
+  }
+
+  if (strcmp(line, "LOAD") == 0 || strcmp(line, "load") == 0) {
+    g_loadTest = !g_loadTest;
+    Serial.println(g_loadTest ? "LOAD on" : "LOAD off");
+    return;
+  }
+
   if (sscanf(line, "MISSION,%d", &v) == 1) {
     g_missionDifficulty = clampInt(v, 1, 5);
     Serial.print("MISSION level=");
@@ -544,12 +778,24 @@ static void logStatus(void) {
   Serial.print(" atk=");
   Serial.print(g_attackerScore);
   Serial.print(" diff=");
-  Serial.println(g_missionDifficulty);
+  Serial.print(g_missionDifficulty);
+  Serial.print(" link=");
+  Serial.print(g_linkBinary ? "bin" : "asc");
+  Serial.print(" lrf=");
+  Serial.print(g_linkRxFrames);
+  Serial.print(" lre=");
+  Serial.print(g_linkRxErrors);
+  Serial.print(" baud=");
+  Serial.print(BAUD_RATES[g_baudIdx]);
+  Serial.print(" bdc=");
+  Serial.print(BAUD_RATES[g_baudCeiling]);
+  Serial.print(" bdf=");
+  Serial.println(g_baudFallbacks);
 }
 
 void setup() {
   Serial.begin(115200);
-  bus.begin(9600);
+  bus.begin(BAUD_RATES[0]);
   lcdInit();
 
   pinMode(PIN_JOY_SW, INPUT_PULLUP);
@@ -563,9 +809,10 @@ void setup() {
   lcdPrintText("Booting...");
 
   Serial.println("AEGIS master emulator ready");
-  Serial.println("Commands: START | RESET | MISSION,<1..5> | STATUS");
+  Serial.println("Commands: START | RESET | MISSION,<1..5> | STATUS | LINK | LOAD");
   Serial.println("UART TX: $C,<servo>,<step>,<buzz>,<rgb>,<state>");
   Serial.println("UART RX: $S,<ms>,<sector>,<dist>,<lux>,<tilt>,<temp10>,<hum10>,<ir>,<joy>");
+  Serial.println("Binary COBS+CRC16 frames after PING,BIN3 -> $A,PONG,BIN3");
 }
 
 void loop() {
@@ -575,6 +822,8 @@ void loop() {
   updateStateMachine();
   updateStatusLed();
   updateLcd();
+  linkNegotiate();
+  linkBaudStep();
   sendControlFrame();
   logStatus();
 }
@@ -0,0 +1,158 @@
+/*
+ * link_codec.h
+ *
+ *  Binary framing for the CC3200 <-> coprocessor UART link.
+ *
+ *  The same two files are compiled into the Arduino sketches; the copies in
+ *  arduino/<sketch>/ must be kept identical to this one.
+ */
+
+#ifndef UTILS_LINK_CODEC_H_
+#define UTILS_LINK_CODEC_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// On the wire a frame is COBS(header, seq, body, crc16) between two 0x00
+// delimiters. The header byte carries the format version in its high nibble
+// and the frame type in the low one; the CRC is CRC-16/CCITT-FALSE over
+// everything before it, big-endian.
+//
+// ASCII lines always start with '$' and never contain 0x00. A receiver
+// switches to binary on any 0x00 and back to ASCII on a '$' at the start of
+// a frame; a COBS code byte for a frame this short is at most
+// LINK_PAYLOAD_MAX + 1, so it is never '$'. The leading delimiter is what
+// keeps a code byte of '\r' or '\n' right after an ASCII line from being
+// taken for that line's terminator.
+#define LINK_VERSION        3
+#define LINK_TYPE_SENSOR    1
+#define LINK_TYPE_CONTROL   2
+#define LINK_TYPE_APPLIED   3
+#define LINK_TYPE_SWEEP     4
+
+// Sized for a key sweep frame: header, seq, 20 body bytes, CRC
+#define LINK_PAYLOAD_MAX    24
+#define LINK_WIRE_MAX       (LINK_PAYLOAD_MAX + 3)
+
+// Handshake: the master sends LINK_PING_BINARY as an ASCII line. A peer that
+// speaks this version answers LINK_PONG_BINARY and switches its own frames to
+// binary; one that only knows "PING" answers "$A,PONG" or nothing, and the
+// link stays ASCII.
+#define LINK_PING_BINARY    "PING,BIN3"
+#define LINK_PONG_BINARY    "$A,PONG,BIN3"
+
+// Rate change: the master sends LINK_BAUD_CMD "<baud>" as an ASCII line at
+// the current rate; a peer that supports it answers LINK_BAUD_ACK "<baud>"
+// and then switches. Only rates from LINK_BAUD_RATES are valid. Either end
+// that hears nothing decodable for LINK_BAUD_SILENCE_MS goes back to the
+// base rate by itself, so a rate that does not work cannot strand the link.
+#define LINK_BAUD_CMD       "$B,"
+#define LINK_BAUD_ACK       "$A,BAUD,"
+#define LINK_BAUD_RATES     { 9600UL, 19200UL, 38400UL, 57600UL }
+#define LINK_BAUD_STEPS     4
+#define LINK_BAUD_SILENCE_MS 2000UL
+
+// Clock exchange: the master sends LINK_TIME_CMD "<t1>" as an ASCII line in
+// either mode; the peer answers LINK_TIME_ACK "<t1>,<t2>,<t3>" with its
+// millis() when the line arrived and when the reply started. A peer that
+// does not know it stays silent and the master just has no shared clock.
+#define LINK_TIME_CMD       "$T,"
+#define LINK_TIME_ACK       "$A,TIME,"
+
+#define LINK_ERR_COBS       -1
+#define LINK_ERR_LENGTH     -2
+#define LINK_ERR_CRC        -3
+#define LINK_ERR_VERSION    -4
+#define LINK_ERR_TYPE       -5
+#define LINK_ERR_FORMAT     -6
+
+typedef struct {
+    unsigned long ms;
+    int sector;     // 0..15
+    int distCm;     // 0..511
+    int lux;        // 0..1023
+    int tilt;       // 0..1
+    int tempC10;    // -200..823
+    int hum10;      // 0..1023
+    int aux;        // 0..1023
+    int joy;        // 0..1023
+} LinkSensor;
+
+typedef struct {
+    unsigned long refMs;    // ms of the $S frame this answers, 0 if none
+    int servoDeg;   // 0..180
+    int stepMode;   // -1..2
+    int buzzMode;   // 0..3
+    int rgbCode;    // 0..7
+    int state;      // 0..15
+} LinkControl;
+
+// Sent by the coprocessor once it has applied a control frame that carried a
+// refMs; ASCII form "$L,<refMs>,<appliedMs>". Both times are on the
+// coprocessor's clock, so appliedMs - refMs is the sensor-to-actuator
+// latency with no clock sync needed.
+typedef struct {
+    unsigned long refMs;
+    unsigned long appliedMs;
+} LinkApplied;
+
+// Latest range for every radar sector, sent once per sweep interval in
+// binary mode only. A key frame carries every sector as an absolute range;
+// the others carry, for the sectors in mask, the change since the previous
+// sweep number, so a receiver that missed one must wait for the next key.
+#define LINK_SWEEP_SECTORS  16
+#define LINK_SWEEP_RANGE_MAX 511
+
+typedef struct {
+    unsigned char sweep;        // +1 per frame, wraps
+    unsigned char key;
+    unsigned short mask;        // bit i set: value[i] is valid (all for key)
+    short value[LINK_SWEEP_SECTORS];
+} LinkSweep;
+
+typedef struct {
+    int type;
+    unsigned char seq;
+    union {
+        LinkSensor sensor;
+        LinkControl control;
+        LinkApplied applied;
+        LinkSweep sweep;
+    } u;
+} LinkFrame;
+
+unsigned short LinkCrc16(const unsigned char *data, int len);
+int LinkCobsEncode(const unsigned char *in, int len, unsigned char *out);
+int LinkCobsDecode(const unsigned char *in, int len, unsigned char *out);
+
+// Build a complete wire frame, both delimiters included, into out (at least
+// LINK_WIRE_MAX bytes). Out-of-range fields are clamped. Returns its length.
+int LinkEncodeSensor(const LinkSensor *sensor, unsigned char seq, unsigned char *out);
+int LinkEncodeControl(const LinkControl *control, unsigned char seq, unsigned char *out);
+int LinkEncodeApplied(const LinkApplied *applied, unsigned char seq, unsigned char *out);
+int LinkEncodeSweep(const LinkSweep *sweep, unsigned char seq, unsigned char *out);
+
+// Fill sweep from rangeCm as the delta against prevCm, or as a key frame
+// when prevCm is null or the delta would not be any smaller.
+void LinkSweepBuild(LinkSweep *sweep, unsigned char sweepNo, const int *rangeCm, const int *prevCm);
+
+// Decode one frame as received, without its 0x00 delimiters. Returns the
+// frame type, or a LINK_ERR_* code.
+int LinkDecode(const unsigned char *wire, int len, LinkFrame *frame);
+
+// Parse an ASCII "$S,<ms>,<sector>,<dist>,<lux>,<tilt>,<temp10>,<hum10>,
+// <aux>,<joy>" line of len bytes (no CR/LF, need not be NUL-terminated) in
+// one pass. Fields are plain decimal, ms unsigned 32-bit and the rest
+// -32767..32767; anything else, including a missing or extra field or
+// trailing bytes, is rejected. Returns 0 or LINK_ERR_FORMAT.
+int LinkParseSensorText(const char *text, int len, LinkSensor *sensor);
+
+// Same for an ASCII "$L,<refMs>,<appliedMs>" line.
+int LinkParseAppliedText(const char *text, int len, LinkApplied *applied);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UTILS_LINK_CODEC_H_ */
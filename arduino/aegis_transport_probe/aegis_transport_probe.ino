@@ -1,5 +1,6 @@
 #include <SoftwareSerial.h>
 #include <stdio.h>
+#include "link_codec.h"
 
 static const int BUS_RX = 10;
 static const int BUS_TX = 11;
@@ -16,6 +17,7 @@ SoftwareSerial bus(BUS_RX, BUS_TX);
 
 char busLine[96];
 int busLineIdx = 0;
+int busBinary = 0;
 
 int g_servoDeg = 90;
 int g_rgbCode = 0;
@@ -29,6 +31,22 @@ unsigned long g_txFrames = 0;
 unsigned long g_lastTxMs = 0;
 unsigned long g_lastLogMs = 0;
 
+// Switched by the master's PING,BIN3 / PING handshake, same as the coprocessor
+int g_linkBinary = 0;
+unsigned char g_linkTxSeq = 0;
+
+// Follows the master's $B rate steps; back to the base rate after
+// LINK_BAUD_SILENCE_MS without a valid control frame.
+static const unsigned long BAUD_RATES[LINK_BAUD_STEPS] = LINK_BAUD_RATES;
+unsigned long g_busBaud = 9600;
+unsigned long g_lastBusOkMs = 0;
+
+// Latency echo for control frames carrying a refMs, as in the coprocessor.
+// The RGB pins are driven straight from applyControl(), so the applied time
+// is taken there and the echo goes out once the bus has been drained.
+LinkApplied g_echo = { 0, 0 };
+unsigned long g_lastEchoRefMs = 0;
+
 static int clampInt(int v, int lo, int hi) {
   if (v < lo) return lo;
   if (v > hi) return hi;
@@ -55,27 +73,117 @@ static void applyRgbCode(int code) {
   digitalWrite(PIN_RGB_B, b);
 }
 
+static void setBusBaud(unsigned long baud) {
+  bus.end();
+  bus.begin(baud);
+  bus.listen();
+  busLineIdx = 0;
+  g_busBaud = baud;
+  g_lastBusOkMs = millis();
+  Serial.print("BAUD ");
+  Serial.println(baud);
+}
+
+static int validBaud(unsigned long baud) {
+  for (int i = 0; i < LINK_BAUD_STEPS; i++) {
+    if (BAUD_RATES[i] == baud) return 1;
+  }
+  return 0;
+}
+
+static void checkBusSilence(void) {
+  if (g_busBaud == BAUD_RATES[0]) return;
+  if (millis() - g_lastBusOkMs < LINK_BAUD_SILENCE_MS) return;
+  setBusBaud(BAUD_RATES[0]);
+}
+
+static void applyControl(int servo, int rgbCode, int roundState, unsigned long refMs) {
+  g_servoDeg = clampInt(servo, 0, 180);
+  g_rgbCode = clampInt(rgbCode, 0, 6);
+  g_roundState = roundState;
+  g_ctrlFrames++;
+  g_lastBusOkMs = millis();
+
+  applyRgbCode(g_rgbCode);
+  if (refMs != 0 && refMs != g_lastEchoRefMs) {
+    g_echo.refMs = refMs;
+    g_echo.appliedMs = millis();
+  }
+
+  Serial.print("CTRL servo=");
+  Serial.print(g_servoDeg);
+  Serial.print(" rgb=");
+  Serial.print(g_rgbCode);
+  Serial.print(" state=");
+  Serial.println(g_roundState);
+}
+
+static void sendAppliedEcho(void) {
+  if (g_echo.refMs == 0) return;
+
+  g_lastEchoRefMs = g_echo.refMs;
+  if (g_linkBinary) {
+    unsigned char wire[LINK_WIRE_MAX];
+    bus.write(wire, LinkEncodeApplied(&g_echo, g_linkTxSeq++, wire));
+  } else {
+    char line[40];
+    snprintf(line, sizeof(line), "$L,%lu,%lu\n", g_echo.refMs, g_echo.appliedMs);
+    bus.print(line);
+  }
+  bus.listen();
+  g_echo.refMs = 0;
+}
+
+// Clock exchange for the master's timebase: t2 is when the request line was
+// parsed, t3 just before the reply goes out.
+static void answerTimePing(unsigned long t1) {
+  unsigned long t2 = millis();
+  char line[48];
+
+  snprintf(line, sizeof(line), LINK_TIME_ACK "%lu,%lu,%lu", t1, t2, millis());
+  bus.println(line);
+  bus.listen();
+}
+
 static void parseControl(const char *line) {
   int servo = 90;
   int stepMode = 0;
   int buzzMode = 0;
   int rgbCode = 0;
   int roundState = 0;
+  unsigned long refMs = 0;
+  unsigned long baud = 0;
+  unsigned long t1 = 0;
 
-  if (sscanf(line, "$C,%d,%d,%d,%d,%d", &servo, &stepMode, &buzzMode, &rgbCode, &roundState) == 5) {
-    g_servoDeg = clampInt(servo, 0, 180);
-    g_rgbCode = clampInt(rgbCode, 0, 6);
-    g_roundState = roundState;
-    g_ctrlFrames++;
+  if (sscanf(line, "$C,%d,%d,%d,%d,%d,%lu", &servo, &stepMode, &buzzMode, &rgbCode, &roundState,
+             &refMs) >= 5) {
+    applyControl(servo, rgbCode, roundState, refMs);
+    return;
+  }
+
+  if (sscanf(line, LINK_TIME_CMD "%lu", &t1) == 1) {
+    answerTimePing(t1);
+    return;
+  }
+
+  if (sscanf(line, LINK_BAUD_CMD "%lu", &baud) == 1 && validBaud(baud)) {
+    bus.print(LINK_BAUD_ACK);
+    bus.println(baud);
+    setBusBaud(baud);
+    return;
+  }
 
-    applyRgbCode(g_rgbCode);
+  if (strcmp(line, LINK_PING_BINARY) == 0) {
+    g_linkBinary = 1;
+    bus.println(LINK_PONG_BINARY);
+    Serial.println("LINK binary");
+    return;
+  }
 
-    Serial.print("CTRL servo=");
-    Serial.print(g_servoDeg);
-    Serial.print(" rgb=");
-    Serial.print(g_rgbCode);
-    Serial.print(" state=");
-    Serial.println(g_roundState);
+  if (strcmp(line, "PING") == 0) {
+    g_linkBinary = 0;
+    bus.println("$A,PONG");
+    Serial.println("LINK ascii");
     return;
   }
 
@@ -84,12 +192,45 @@ static void parseControl(const char *line) {
   Serial.println(line);
 }
 
+static void parseBinary(const unsigned char *wire, int len) {
+  LinkFrame frame;
+
+  if (LinkDecode(wire, len, &frame) != LINK_TYPE_CONTROL) {
+    g_badFrames++;
+    Serial.print("BAD bin len=");
+    Serial.println(len);
+    return;
+  }
+  applyControl(frame.u.control.servoDeg, frame.u.control.rgbCode, frame.u.control.state,
+               frame.u.control.refMs);
+}
+
+// A 0x00 switches to binary: bytes up to the next 0x00 are one COBS frame
+// (see link_codec.h). A '$' at the start of a frame switches back to ASCII
+// lines ending at CR/LF (see link_codec.h).
 static void pollBus(void) {
   while (bus.available()) {
     char c = (char)bus.read();
     g_busRxBytes++;
 
-    if (c == '\r' || c == '\n') {
+    if (c == 0) {
+      busBinary = 1;
+      if (busLineIdx > 0) {
+        g_busRxLines++;
+        parseBinary((const unsigned char *)busLine, busLineIdx);
+      }
+      busLineIdx = 0;
+      continue;
+    }
+
+    if (busBinary && busLineIdx >= LINK_WIRE_MAX - 2) {
+      // Longer than any frame: the peer is back on ASCII lines
+      g_badFrames++;
+      busBinary = 0;
+      busLineIdx = 0;
+    }
+
+    if (!busBinary && (c == '\r' || c == '\n')) {
       busLine[busLineIdx] = '\0';
       if (busLineIdx > 0) {
         g_busRxLines++;
@@ -99,7 +240,8 @@ static void pollBus(void) {
       continue;
     }
 
-    if (c == '$') {
+    if (c == '$' && (!busBinary || busLineIdx == 0)) {
+      busBinary = 0;
       busLineIdx = 0;
     }
 
@@ -130,6 +272,25 @@ static void sendSensorFrame(void) {
   sector = (joyY * 15) / 1023;
   distCm = 80 + ((1023 - joyX) * 320) / 1023;
 
+  if (g_linkBinary) {
+    LinkSensor sensor;
+    unsigned char wire[LINK_WIRE_MAX];
+
+    sensor.ms = now;
+    sensor.sector = sector;
+    sensor.distCm = distCm;
+    sensor.lux = lux;
+    sensor.tilt = tilt;
+    sensor.tempC10 = 250;
+    sensor.hum10 = 500;
+    sensor.aux = joyY;
+    sensor.joy = joyX;
+    bus.write(wire, LinkEncodeSensor(&sensor, g_linkTxSeq++, wire));
+    bus.listen();
+    g_txFrames++;
+    return;
+  }
+
   snprintf(frame,
            sizeof(frame),
            "$S,%lu,%d,%d,%d,%d,%d,%d,%d,%d\n",
@@ -150,7 +311,7 @@ static void sendSensorFrame(void) {
 
 void setup() {
   Serial.begin(115200);
-  bus.begin(9600);
+  bus.begin(g_busBaud);
   bus.listen();
 
   pinMode(PIN_TILT, INPUT_PULLUP);
@@ -161,8 +322,9 @@ void setup() {
   applyRgbCode(g_rgbCode);
 
   Serial.println("AEGIS transport probe ready");
-  Serial.println("TX: periodic $S frames");
-  Serial.println("RX: $C,<servo>,<step>,<buzz>,<rgb>,<state>");
+  Serial.println("TX: periodic $S frames (binary after PING,BIN3)");
+  Serial.println("RX: $C,<servo>,<step>,<buzz>,<rgb>,<state>[,<refMs>] or binary control");
+  Serial.println("TX: $L,<refMs>,<appliedMs> after each control with a refMs");
 }
 
 void loop() {
@@ -172,6 +334,8 @@ void loop() {
   int tilt;
 
   pollBus();
+  sendAppliedEcho();
+  checkBusSilence();
   sendSensorFrame();
 
   if (millis() - g_lastLogMs < 1000) return;
@@ -192,6 +356,10 @@ void loop() {
   Serial.print(g_ctrlFrames);
   Serial.print(" bad=");
   Serial.print(g_badFrames);
+  Serial.print(" link=");
+  Serial.print(g_linkBinary ? "bin" : "asc");
+  Serial.print(" baud=");
+  Serial.print(g_busBaud);
   Serial.print(" joyX=");
   Serial.print(joyX);
   Serial.print(" joyY=");
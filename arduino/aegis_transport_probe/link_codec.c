@@ -0,0 +1,428 @@
+/*
+ * link_codec.c
+ *
+ *  Binary framing for the CC3200 <-> coprocessor UART link.
+ *
+ *  The same two files are compiled into the Arduino sketches; the copies in
+ *  arduino/<sketch>/ must be kept identical to this one.
+ */
+#include "link_codec.h"
+
+#define SENSOR_BODY     12      // ms (4) + 64 bits of packed fields
+#define CONTROL_BODY    7       // refMs (4) + 19 bits of packed fields
+#define APPLIED_BODY    8       // refMs (4) + appliedMs (4)
+#define SWEEP_KEY_BITS  (1 + LINK_SWEEP_SECTORS * 9)   // after the sweep byte
+#define SWEEP_HEAD_BITS (1 + 16 + 4)                    // delta: key, mask, width
+
+//*****************************************************************************
+//
+//! \brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), bitwise so it stays
+//! small on the AVR side
+//!
+//*****************************************************************************
+unsigned short LinkCrc16(const unsigned char *data, int len) {
+    unsigned short crc = 0xFFFF;
+    int i;
+
+    while (len-- > 0) {
+        crc ^= (unsigned short)(*data++) << 8;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (unsigned short)((crc << 1) ^ 0x1021) : (unsigned short)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+//*****************************************************************************
+//
+//! \brief Consistent overhead byte stuffing: rewrite len bytes so that none
+//! is zero. out needs len + 1 bytes; no delimiter is appended.
+//!
+//! \return encoded length
+//!
+//*****************************************************************************
+int LinkCobsEncode(const unsigned char *in, int len, unsigned char *out) {
+    int code = 0;
+    int o = 1;
+    int i;
+
+    for (i = 0; i < len; i++) {
+        if (in[i] == 0) {
+            out[code] = (unsigned char)(o - code);
+            code = o++;
+        } else {
+            out[o++] = in[i];
+            if (o - code == 0xFF) {
+                out[code] = 0xFF;
+                code = o++;
+            }
+        }
+    }
+    out[code] = (unsigned char)(o - code);
+    return o;
+}
+
+//*****************************************************************************
+//
+//! \brief Undo LinkCobsEncode(). out needs len bytes.
+//!
+//! \return decoded length, or LINK_ERR_COBS if the input is malformed
+//!
+//*****************************************************************************
+int LinkCobsDecode(const unsigned char *in, int len, unsigned char *out) {
+    int i = 0;
+    int o = 0;
+    int code, k;
+
+    while (i < len) {
+        code = in[i++];
+        if ((code == 0) || (i + code - 1 > len)) return LINK_ERR_COBS;
+        for (k = 1; k < code; k++) {
+            if (in[i] == 0) return LINK_ERR_COBS;
+            out[o++] = in[i++];
+        }
+        if ((code != 0xFF) && (i < len)) out[o++] = 0;
+    }
+    return o;
+}
+
+static unsigned int clampField(long value, long lo, long hi) {
+    if (value < lo) value = lo;
+    if (value > hi) value = hi;
+    return (unsigned int)(value - lo);
+}
+
+// Little-endian bit packing, LSB of each field first.
+static void putBits(unsigned char *buf, int *pos, unsigned int value, int bits) {
+    while (bits-- > 0) {
+        if (value & 1) {
+            buf[*pos >> 3] |= (unsigned char)(1 << (*pos & 7));
+        } else {
+            buf[*pos >> 3] &= (unsigned char)~(1 << (*pos & 7));
+        }
+        value >>= 1;
+        (*pos)++;
+    }
+}
+
+static unsigned int getBits(const unsigned char *buf, int *pos, int bits) {
+    unsigned int value = 0;
+    int i;
+
+    for (i = 0; i < bits; i++) {
+        if (buf[*pos >> 3] & (1 << (*pos & 7))) value |= 1U << i;
+        (*pos)++;
+    }
+    return value;
+}
+
+static int finishFrame(unsigned char *payload, int len, unsigned char *out) {
+    unsigned short crc = LinkCrc16(payload, len);
+    int n;
+
+    payload[len++] = (unsigned char)(crc >> 8);
+    payload[len++] = (unsigned char)crc;
+    out[0] = 0;
+    n = 1 + LinkCobsEncode(payload, len, out + 1);
+    out[n++] = 0;
+    return n;
+}
+
+static void putU32(unsigned char *buf, unsigned long value) {
+    buf[0] = (unsigned char)value;
+    buf[1] = (unsigned char)(value >> 8);
+    buf[2] = (unsigned char)(value >> 16);
+    buf[3] = (unsigned char)(value >> 24);
+}
+
+static unsigned long getU32(const unsigned char *buf) {
+    return (unsigned long)buf[0] |
+           ((unsigned long)buf[1] << 8) |
+           ((unsigned long)buf[2] << 16) |
+           ((unsigned long)buf[3] << 24);
+}
+
+int LinkEncodeSensor(const LinkSensor *sensor, unsigned char seq, unsigned char *out) {
+    unsigned char payload[LINK_PAYLOAD_MAX];
+    unsigned char *body = payload + 2;
+    int pos = 0;
+
+    payload[0] = (LINK_VERSION << 4) | LINK_TYPE_SENSOR;
+    payload[1] = seq;
+    putU32(body, sensor->ms);
+    body += 4;
+    putBits(body, &pos, clampField(sensor->sector, 0, 15), 4);
+    putBits(body, &pos, clampField(sensor->tilt, 0, 1), 1);
+    putBits(body, &pos, clampField(sensor->distCm, 0, 511), 9);
+    putBits(body, &pos, clampField(sensor->lux, 0, 1023), 10);
+    putBits(body, &pos, clampField(sensor->tempC10, -200, 823), 10);
+    putBits(body, &pos, clampField(sensor->hum10, 0, 1023), 10);
+    putBits(body, &pos, clampField(sensor->aux, 0, 1023), 10);
+    putBits(body, &pos, clampField(sensor->joy, 0, 1023), 10);
+    return finishFrame(payload, 2 + SENSOR_BODY, out);
+}
+
+int LinkEncodeControl(const LinkControl *control, unsigned char seq, unsigned char *out) {
+    // 19 bits of fields: zero the padding so equal frames encode identically
+    unsigned char payload[LINK_PAYLOAD_MAX] = { 0 };
+    unsigned char *body = payload + 2;
+    int pos = 0;
+
+    payload[0] = (LINK_VERSION << 4) | LINK_TYPE_CONTROL;
+    payload[1] = seq;
+    putU32(body, control->refMs);
+    body += 4;
+    putBits(body, &pos, clampField(control->servoDeg, 0, 255), 8);
+    putBits(body, &pos, clampField(control->stepMode, -1, 2), 2);
+    putBits(body, &pos, clampField(control->buzzMode, 0, 3), 2);
+    putBits(body, &pos, clampField(control->rgbCode, 0, 7), 3);
+    putBits(body, &pos, clampField(control->state, 0, 15), 4);
+    return finishFrame(payload, 2 + CONTROL_BODY, out);
+}
+
+int LinkEncodeApplied(const LinkApplied *applied, unsigned char seq, unsigned char *out) {
+    unsigned char payload[LINK_PAYLOAD_MAX];
+
+    payload[0] = (LINK_VERSION << 4) | LINK_TYPE_APPLIED;
+    payload[1] = seq;
+    putU32(payload + 2, applied->refMs);
+    putU32(payload + 6, applied->appliedMs);
+    return finishFrame(payload, 2 + APPLIED_BODY, out);
+}
+
+// Signed deltas as small unsigned numbers: 0, -1, 1, -2, 2, ...
+static unsigned int zigzag(int value) {
+    return (value >= 0) ? ((unsigned int)value << 1) : (((unsigned int)(-value) << 1) - 1);
+}
+
+static int unzigzag(unsigned int value) {
+    return (value & 1) ? -(int)((value + 1) >> 1) : (int)(value >> 1);
+}
+
+static int bitWidth(unsigned int value) {
+    int bits = 1;
+
+    while (value >>= 1) bits++;
+    return bits;
+}
+
+static int sweepDeltaWidth(const LinkSweep *sweep) {
+    int width = 1;
+    int i;
+
+    for (i = 0; i < LINK_SWEEP_SECTORS; i++) {
+        if ((sweep->mask & (1U << i)) && (bitWidth(zigzag(sweep->value[i])) > width)) {
+            width = bitWidth(zigzag(sweep->value[i]));
+        }
+    }
+    return width;
+}
+
+static int sweepCount(unsigned short mask) {
+    int n = 0;
+
+    while (mask) {
+        n += mask & 1;
+        mask >>= 1;
+    }
+    return n;
+}
+
+void LinkSweepBuild(LinkSweep *sweep, unsigned char sweepNo, const int *rangeCm, const int *prevCm) {
+    int i, cur;
+
+    sweep->sweep = sweepNo;
+    sweep->key = 0;
+    sweep->mask = 0;
+    for (i = 0; (prevCm != 0) && (i < LINK_SWEEP_SECTORS); i++) {
+        cur = (int)clampField(rangeCm[i], 0, LINK_SWEEP_RANGE_MAX);
+        sweep->value[i] = (short)(cur - (int)clampField(prevCm[i], 0, LINK_SWEEP_RANGE_MAX));
+        if (sweep->value[i] != 0) sweep->mask |= (unsigned short)(1U << i);
+    }
+    if ((prevCm != 0) &&
+        (SWEEP_HEAD_BITS + sweepCount(sweep->mask) * sweepDeltaWidth(sweep) < SWEEP_KEY_BITS)) {
+        return;
+    }
+
+    sweep->key = 1;
+    sweep->mask = 0xFFFF;
+    for (i = 0; i < LINK_SWEEP_SECTORS; i++) {
+        sweep->value[i] = (short)clampField(rangeCm[i], 0, LINK_SWEEP_RANGE_MAX);
+    }
+}
+
+int LinkEncodeSweep(const LinkSweep *sweep, unsigned char seq, unsigned char *out) {
+    unsigned char payload[LINK_PAYLOAD_MAX] = { 0 };
+    unsigned char *body = payload + 3;
+    int pos = 0;
+    int width, i;
+
+    payload[0] = (LINK_VERSION << 4) | LINK_TYPE_SWEEP;
+    payload[1] = seq;
+    payload[2] = sweep->sweep;
+    putBits(body, &pos, sweep->key ? 1 : 0, 1);
+    if (sweep->key) {
+        for (i = 0; i < LINK_SWEEP_SECTORS; i++) {
+            putBits(body, &pos, clampField(sweep->value[i], 0, LINK_SWEEP_RANGE_MAX), 9);
+        }
+    } else {
+        width = sweepDeltaWidth(sweep);
+        putBits(body, &pos, sweep->mask, 16);
+        putBits(body, &pos, (unsigned int)(width - 1), 4);
+        for (i = 0; i < LINK_SWEEP_SECTORS; i++) {
+            if (sweep->mask & (1U << i)) putBits(body, &pos, zigzag(sweep->value[i]), width);
+        }
+    }
+    return finishFrame(payload, 3 + (pos + 7) / 8, out);
+}
+
+static int decodeSweep(const unsigned char *body, int n, LinkSweep *sweep) {
+    const unsigned char *bits = body + 1;
+    int pos = 0;
+    int width, i;
+
+    if (n < 2) return LINK_ERR_LENGTH;
+    sweep->sweep = body[0];
+    sweep->key = (unsigned char)getBits(bits, &pos, 1);
+    if (sweep->key) {
+        if (n != 1 + (SWEEP_KEY_BITS + 7) / 8) return LINK_ERR_LENGTH;
+        sweep->mask = 0xFFFF;
+        for (i = 0; i < LINK_SWEEP_SECTORS; i++) {
+            sweep->value[i] = (short)getBits(bits, &pos, 9);
+        }
+        return 0;
+    }
+    if ((n - 1) * 8 < SWEEP_HEAD_BITS) return LINK_ERR_LENGTH;
+    sweep->mask = (unsigned short)getBits(bits, &pos, 16);
+    width = (int)getBits(bits, &pos, 4) + 1;
+    if (n != 1 + (SWEEP_HEAD_BITS + sweepCount(sweep->mask) * width + 7) / 8) return LINK_ERR_LENGTH;
+    for (i = 0; i < LINK_SWEEP_SECTORS; i++) {
+        sweep->value[i] = (sweep->mask & (1U << i)) ? (short)unzigzag(getBits(bits, &pos, width)) : 0;
+    }
+    return 0;
+}
+
+int LinkDecode(const unsigned char *wire, int len, LinkFrame *frame) {
+    unsigned char payload[LINK_WIRE_MAX];
+    const unsigned char *body;
+    unsigned short crc;
+    int n, pos = 0;
+
+    if ((len < 1) || (len > LINK_WIRE_MAX - 2)) return LINK_ERR_LENGTH;
+    n = LinkCobsDecode(wire, len, payload);
+    if (n < 0) return n;
+    if (n < 4) return LINK_ERR_LENGTH;
+    crc = (unsigned short)((payload[n - 2] << 8) | payload[n - 1]);
+    if (LinkCrc16(payload, n - 2) != crc) return LINK_ERR_CRC;
+    if ((payload[0] >> 4) != LINK_VERSION) return LINK_ERR_VERSION;
+
+    frame->type = payload[0] & 0x0F;
+    frame->seq = payload[1];
+    body = payload + 2;
+    n -= 4;
+
+    if (frame->type == LINK_TYPE_SENSOR) {
+        if (n != SENSOR_BODY) return LINK_ERR_LENGTH;
+        frame->u.sensor.ms = getU32(body);
+        body += 4;
+        frame->u.sensor.sector = (int)getBits(body, &pos, 4);
+        frame->u.sensor.tilt = (int)getBits(body, &pos, 1);
+        frame->u.sensor.distCm = (int)getBits(body, &pos, 9);
+        frame->u.sensor.lux = (int)getBits(body, &pos, 10);
+        frame->u.sensor.tempC10 = (int)getBits(body, &pos, 10) - 200;
+        frame->u.sensor.hum10 = (int)getBits(body, &pos, 10);
+        frame->u.sensor.aux = (int)getBits(body, &pos, 10);
+        frame->u.sensor.joy = (int)getBits(body, &pos, 10);
+        return frame->type;
+    }
+    if (frame->type == LINK_TYPE_CONTROL) {
+        if (n != CONTROL_BODY) return LINK_ERR_LENGTH;
+        frame->u.control.refMs = getU32(body);
+        body += 4;
+        frame->u.control.servoDeg = (int)getBits(body, &pos, 8);
+        frame->u.control.stepMode = (int)getBits(body, &pos, 2) - 1;
+        frame->u.control.buzzMode = (int)getBits(body, &pos, 2);
+        frame->u.control.rgbCode = (int)getBits(body, &pos, 3);
+        frame->u.control.state = (int)getBits(body, &pos, 4);
+        return frame->type;
+    }
+    if (frame->type == LINK_TYPE_APPLIED) {
+        if (n != APPLIED_BODY) return LINK_ERR_LENGTH;
+        frame->u.applied.refMs = getU32(body);
+        frame->u.applied.appliedMs = getU32(body + 4);
+        return frame->type;
+    }
+    if (frame->type == LINK_TYPE_SWEEP) {
+        n = decodeSweep(body, n, &frame->u.sweep);
+        return (n < 0) ? n : frame->type;
+    }
+    return LINK_ERR_TYPE;
+}
+
+// Read the decimal number at text[*pos], at most limit, and advance *pos
+// past it. A leading '-' is only taken when negative is non-null.
+static int scanNumber(const char *text, int len, int *pos, unsigned long limit,
+                      unsigned long *value, int *negative) {
+    unsigned long v = 0;
+    unsigned int d;
+    int i = *pos;
+    int start;
+
+    if (negative) {
+        *negative = (i < len) && (text[i] == '-');
+        if (*negative) i++;
+    }
+    start = i;
+    while ((i < len) && (text[i] >= '0') && (text[i] <= '9')) {
+        d = (unsigned int)(text[i] - '0');
+        if (v > (limit - d) / 10) return -1;
+        v = v * 10 + d;
+        i++;
+    }
+    if (i == start) return -1;
+    *value = v;
+    *pos = i;
+    return 0;
+}
+
+static int checkTag(const char *text, int len, char tag) {
+    return (len >= 4) && (text[0] == '$') && (text[1] == tag) && (text[2] == ',');
+}
+
+int LinkParseSensorText(const char *text, int len, LinkSensor *sensor) {
+    int field[8];
+    unsigned long v;
+    int neg, i, pos = 3;
+
+    if (!checkTag(text, len, 'S')) return LINK_ERR_FORMAT;
+    if (scanNumber(text, len, &pos, 0xFFFFFFFFUL, &v, 0) < 0) return LINK_ERR_FORMAT;
+    sensor->ms = v;
+    for (i = 0; i < 8; i++) {
+        if ((pos >= len) || (text[pos] != ',')) return LINK_ERR_FORMAT;
+        pos++;
+        if (scanNumber(text, len, &pos, 32767UL, &v, &neg) < 0) return LINK_ERR_FORMAT;
+        field[i] = neg ? -(int)v : (int)v;
+    }
+    if (pos != len) return LINK_ERR_FORMAT;
+
+    sensor->sector = field[0];
+    sensor->distCm = field[1];
+    sensor->lux = field[2];
+    sensor->tilt = field[3];
+    sensor->tempC10 = field[4];
+    sensor->hum10 = field[5];
+    sensor->aux = field[6];
+    sensor->joy = field[7];
+    return 0;
+}
+
+int LinkParseAppliedText(const char *text, int len, LinkApplied *applied) {
+    int pos = 3;
+
+    if (!checkTag(text, len, 'L')) return LINK_ERR_FORMAT;
+    if (scanNumber(text, len, &pos, 0xFFFFFFFFUL, &applied->refMs, 0) < 0) return LINK_ERR_FORMAT;
+    if ((pos >= len) || (text[pos] != ',')) return LINK_ERR_FORMAT;
+    pos++;
+    if (scanNumber(text, len, &pos, 0xFFFFFFFFUL, &applied->appliedMs, 0) < 0) return LINK_ERR_FORMAT;
+    return (pos == len) ? 0 : LINK_ERR_FORMAT;
+}
@@ -30,17 +30,31 @@
 
 #include "Adafruit_SSD1351.h"
 #include "Adafruit_GFX.h"
+#include "aegis_sprites.h"
 #include "i2c_if.h"
 #include "utils/network_utils.h"
+#include "utils/timebase.h"
+#include "utils/byte_ring.h"
+#include "utils/link_codec.h"
+#include "utils/latency_stats.h"
+#include "utils/clock_sync.h"
+#include "utils/http_conn.h"
+#include "utils/json_stream.h"
+#include "utils/mqtt_client.h"
 
 #define SERVER_NAME           "a126k3e19n75q0-ats.iot.us-east-2.amazonaws.com"
 #define SERVER_PORT           8443
+#define MQTT_PORT             8883
+#define MQTT_CLIENT_ID        "akge_cc3200_board"
+#define MQTT_KEEPALIVE_S      60
+#define SHADOW_TOPIC          "$aws/things/akge_cc3200_board/shadow/update"
+#define SHADOW_DELTA_TOPIC    SHADOW_TOPIC "/delta"
 
 #define POSTHEADER            "POST /things/akge_cc3200_board/shadow HTTP/1.1\r\n"
 #define SHADOWTOPICPOSTHEADER "POST /topics/$aws/things/akge_cc3200_board/shadow/update?qos=0 HTTP/1.1\r\n"
 #define GETHEADER             "GET /things/akge_cc3200_board/shadow HTTP/1.1\r\n"
 #define HOSTHEADER            "Host: a126k3e19n75q0-ats.iot.us-east-2.amazonaws.com\r\n"
-#define CHEADER               "Connection: close\r\n"
+#define CHEADER               "Connection: keep-alive\r\n"
 #define CTHEADER              "Content-Type: application/json; charset=utf-8\r\n"
 #define CLHEADER1             "Content-Length: "
 #define CLHEADER2             "\r\n\r\n"
@@ -58,9 +72,36 @@
 #define SYSTICK_RELOAD_VAL    8000000UL
 #define TICKS_TO_US(ticks) ((((ticks) / SYSCLKFREQ) * 1000000ULL) + ((((ticks) % SYSCLKFREQ) * 1000000ULL) / SYSCLKFREQ))
 
-#define UART1_BAUD            9600
+#define UART1_RX_RING_SIZE    2048
+#define UART1_TX_SLOTS        4
+#define UART1_TX_FRAME_MAX    64
+#define UART1_RX_SLOTS        4
+#define UART1_RX_FRAME_MAX    128
 
-#define SHADOW_BUF_SIZE       4096
+#define TX_KIND_NONE          0
+#define TX_KIND_CONTROL       1
+
+#define RX_LINE               1
+#define RX_BINARY             2
+
+#define BAUD_IDLE             0
+#define BAUD_ASKED            1
+#define BAUD_SWITCH           2
+#define BAUD_PROBE            3
+
+#define CLOUD_IDLE            0
+#define CLOUD_CONNECT         1
+#define CLOUD_SEND            2
+#define CLOUD_RECV            3
+#define CLOUD_PARSE           4
+#define CLOUD_CLOSE           5
+
+#define CLOUD_OP_OPEN         0     // connect only, ahead of the first request
+#define CLOUD_OP_REQUEST      1     // mission request, answer not awaited
+#define CLOUD_OP_POLL         2     // shadow GET, parsed for the mission
+#define CLOUD_OP_REPORT       3     // round report POST
+
+#define CLOUD_REQ_SIZE        1400
 #define S3_URL_BUF_SIZE       2048
 
 #define SECTOR_COUNT          16
@@ -70,12 +111,29 @@
 #define CONTROL_INTERVAL_LOOPS 6
 #define CONTROL_RESEND_LOOPS  18
 #define DRAW_INTERVAL_LOOPS   5
+#define DRAW_BUDGET_US        3000UL
+#define LOOP_SLOW_US          20000UL
 #define LOG_INTERVAL_LOOPS    320
+#define LOG_VIEW_LINES        16
+#define LOG_VIEW_CHARS        21
 #define SHADOW_INTERVAL_LOOPS 160
 #define MISSION_POLL_LOOPS    180
 #define MISSION_REQUEST_RETRY_LOOPS 120
 #define SCORE_INTERVAL_LOOPS  12
 #define CONTROL_KEEPALIVE_LOOPS 80
+#define LATENCY_MAX_MS        10000UL
+#define LINK_PING_LOOPS       220
+#define LINK_PING_TRIES       5
+#define CLOCK_PING_LOOPS      220
+#define FRAME_STALE_MS        300L
+#define FRAME_AGE_LOST_MS     2000L
+#define LINK_BAUD_DWELL_LOOPS 1200
+#define LINK_BAUD_ACK_LOOPS   80
+#define LINK_BAUD_ASK_TRIES   3
+#define LINK_BAUD_PROBE_LOOPS 400
+#define LINK_BAUD_SILENCE_LOOPS 440
+#define LINK_BAUD_MIN_FRAMES  6
+#define LINK_BAUD_MAX_ERR_PCT 10
 #define IR_DEBOUNCE_LOOPS     16
 #define CLOUD_RETRY_COOLDOWN_LOOPS 3000
 #define SYNC_RETRY_LOOPS      800
@@ -95,6 +153,8 @@
 #define DIST_NEAR             12
 #define DIST_MED              24
 #define DIST_FAR              40
+#define RADAR_RANGE_CM        100
+#define RADAR_NO_ECHO_CM      400
 
 #define BTN_START             1
 #define BTN_DIFF_UP           2
@@ -106,6 +166,7 @@
 #define BTN_ABORT             10
 #define BTN_DIFF_DOWN         12
 #define BTN_SYNC              13
+#define BTN_LOG_VIEW          0
 
 #if defined(ccs) || defined(gcc)
 extern void (* const g_pfnVectors[])(void);
@@ -137,27 +198,134 @@ typedef enum RoundState {
     RS_END = 7
 } RoundState;
 
+// The one cloud request under way; see cloudStep()
+typedef struct {
+    int step;
+    int op;
+    int reqLen;
+    int sent;
+    int reused;             // went out on a connection that had carried others
+    int retried;
+    int result;             // status code, or the error CLOUD_CLOSE reports
+    char req[CLOUD_REQ_SIZE];
+} CloudJob;
+
+// Shadow keys the firmware acts on. They are matched against the end of a
+// value's key path, so one table serves the full document from a poll and
+// the delta pushed over MQTT.
+#define SHADOW_KEY_LEVEL      0
+#define SHADOW_KEY_URL        1
+#define SHADOW_KEY_READY      2
+#define SHADOW_KEY_WINNER     3
+#define SHADOW_KEY_CMD        4     // the back end's "cmd":"MISSION_READY" marker
+
+static const char *const g_shadowKeys[] = {
+    "mission_level", "mission_url", "mission_ready", "round_result.winner", "cmd"
+};
+
+// What one shadow document said, gathered while it streams in
+typedef struct {
+    JsonStream js;
+    int hasLevel;
+    int level;
+    int urlDone;            // first mission_url complete, later ones ignored
+    int hasUrl;
+    int ready;
+    int winnerDone;         // first round_result.winner taken, later ones ignored
+} ShadowScan;
+
 volatile unsigned long g_irCmd = 0;
 volatile int g_bitCount = 0;
 volatile int g_codeReady = 0;
 unsigned long g_irEdgeCount = 0;
 unsigned long g_irCodeCount = 0;
 
-volatile int g_sensorReady = 0;
+unsigned long g_linkRxFrames = 0;
+unsigned long g_linkRxErrors = 0;
+int g_linkBinary = 0;
+int g_linkPingTries = 0;
+unsigned long g_lastLinkPingLoop = 0;
+unsigned char g_linkTxSeq = 0;
+static const unsigned long g_baudRates[LINK_BAUD_STEPS] = LINK_BAUD_RATES;
+int g_baudIdx = 0;
+int g_baudCeiling = LINK_BAUD_STEPS - 1;
+int g_baudState = BAUD_IDLE;
+int g_baudTarget = 0;
+int g_baudAskTries = 0;
+unsigned long g_baudStateLoop = 0;
+unsigned long g_baudWindowOk = 0;
+unsigned long g_baudWindowErr = 0;
+unsigned long g_baudFallbacks = 0;
 unsigned long g_uart1RxBytes = 0;
 unsigned long g_uart1RxLines = 0;
 unsigned long g_uart1RxOverflow = 0;
+unsigned long g_uart1RxLate = 0;
+unsigned long g_uart1RxPeak = 0;
+volatile unsigned long g_uart1RxHwOverrun = 0;
+ByteRing g_uart1RxRing;
+static unsigned char g_uart1RxBuf[UART1_RX_RING_SIZE];
 unsigned long g_uart1TxLines = 0;
+unsigned long g_uart1TxDropped = 0;
+unsigned long g_uart1TxCoalesced = 0;
+unsigned long g_uart1TxPeak = 0;
 unsigned long g_lastIrAcceptLoop = 0;
+unsigned long g_oledFrameBytes = 0;
+unsigned long g_oledTxMark = 0;
+unsigned long g_oledFlushDeferred = 0;
+volatile unsigned long g_oledFlushDone = 0;
+int g_oledFlushPending = 0;
+int g_drawPending = 0;
+unsigned long g_drawOverruns = 0;
+unsigned long g_drawCarryovers = 0;
+unsigned long g_drawWorstUs = 0;
+unsigned long g_loopWorstUs = 0;        // longest main loop pass since boot, delay excluded
+unsigned long g_loopWindowWorstUs = 0;  // same, since the last DBG line
+unsigned long g_loopSlow = 0;           // passes over LOOP_SLOW_US
+int g_logView = 0;
+int g_logStartPending = -1;
 
-char g_softLine[128];
-char g_readyLine[128];
-volatile int g_softIdx = 0;
 unsigned long g_softParseOk = 0;
 unsigned long g_softParseFail = 0;
 
+// Per-round sensor-to-actuator latency. g_latency is the coprocessor's own
+// $S timestamp to its "applied" echo; g_hostLatency is the part spent here,
+// from parsing the $S frame to queueing the $C that answers it.
+LatencyStats g_latency;
+LatencyStats g_hostLatency;
+unsigned long g_sensorRxMs = 0;
+int g_sensorUnanswered = 0;
+unsigned long g_lastEchoRef = 0;
+unsigned long g_latencyRejected = 0;
+
+// Shared timebase with the coprocessor's millis(), kept by $T exchanges.
+// g_frameAgeMs is how old the last sensor frame was when its final byte
+// reached us, on that shared clock; older than FRAME_STALE_MS counts stale.
+ClockSync g_clock;
+unsigned long g_clockPingT1 = 0;
+int g_clockPingLen = 0;
+int g_clockPingPending = 0;
+unsigned long g_lastClockPingLoop = 0;
+long g_frameAgeMs = 0;
+unsigned long g_staleFrames = 0;
+
 SensorFrame g_sensor = {0, 0, 400, 0, 0, 250, 500, 0, 512};
 
+// Latest range per radar sector. Every sensor frame fills in its own sector
+// and binary sweep frames refresh all of them; g_rangeStamp moves on any
+// change so the radar knows to redraw. Sweep deltas apply to g_sweepBaseCm,
+// the last full sweep, since single-sector updates land in g_rangeCm too.
+#if SECTOR_COUNT != LINK_SWEEP_SECTORS
+#error "sweep frames carry LINK_SWEEP_SECTORS ranges"
+#endif
+int g_rangeCm[SECTOR_COUNT] = {400, 400, 400, 400, 400, 400, 400, 400,
+                               400, 400, 400, 400, 400, 400, 400, 400};
+int g_sweepBaseCm[SECTOR_COUNT] = {400, 400, 400, 400, 400, 400, 400, 400,
+                                   400, 400, 400, 400, 400, 400, 400, 400};
+unsigned long g_rangeStamp = 0;
+int g_sweepNo = -1;
+unsigned long g_sweepFrames = 0;
+unsigned long g_sweepGaps = 0;
+
 RoundState g_state = RS_BOOT;
 unsigned long g_loopCount = 0;
 unsigned long g_stateStartLoop = 0;
@@ -180,6 +348,7 @@ int g_defenderScore = 0;
 int g_attackerScore = 0;
 int g_missionDifficulty = 1;
 int g_missionReady = 0;
+int g_missionRequested = 0;
 int g_roundReported = 0;
 int g_shadowDirty = 1;
 int g_cloudOnline = 0;
@@ -208,9 +377,19 @@ unsigned long g_attackBlindUntil = 0;
 unsigned long g_lastScoreLoop = 0;
 int g_attackAction = 0;
 
-int g_sockID = -1;
-char g_httpBuf[SHADOW_BUF_SIZE];
+HttpConn g_http;
+CloudJob g_cloudJob;
+MqttClient g_mqtt;
+TlsConnect g_mqttConnect;
+int g_mqttConnecting = 0;
+unsigned long g_nextMqttRetryLoop = 0;
+int g_roundReportId = 0;            // QoS 1 packet id of the round report awaiting its PUBACK
+unsigned long g_missionAskMs = 0;   // when the mission request went out; 0 once answered
+LatencyStats g_missionLatency;      // mission request to mission ready, by push or poll
 char g_s3MissionUrl[S3_URL_BUF_SIZE];
+char g_cloudWinner[8];              // round_result.winner of the latest document carrying one
+ShadowScan g_pollScan;              // shadow GET body, parsed as it arrives
+ShadowScan g_pushScan;              // delta pushed over MQTT
 
 static const int g_sectorDx[SECTOR_COUNT] = {0, 12, 23, 30, 32, 30, 23, 12, 0, -12, -23, -30, -32, -30, -23, -12};
 static const int g_sectorDy[SECTOR_COUNT] = {-32, -30, -23, -12, 0, 12, 23, 30, 32, 30, 23, 12, 0, -12, -23, -30};
@@ -302,6 +481,7 @@ static void SPIInit(void)
                            20000000, SPI_MODE_MASTER, SPI_SUB_MODE_0,
                            (SPI_SW_CTRL_CS | SPI_4PIN_MODE | SPI_TURBO_OFF |
                             SPI_CS_ACTIVELOW | SPI_WL_8));
+    MAP_SPIFIFOEnable(GSPI_BASE, SPI_TX_FIFO | SPI_RX_FIFO);
     MAP_SPIEnable(GSPI_BASE);
 }
 
@@ -343,7 +523,7 @@ static void IRIntHandler(void)
 static int IRCodeToButton(unsigned long cmd)
 {
     switch (cmd) {
-        case 0x9899: return 0;
+        case 0x9899: return BTN_LOG_VIEW;
         case 0x0809: return BTN_START;
         case 0x8889: return BTN_DIFF_UP;
         case 0x4849: return BTN_MISSION;
@@ -374,58 +554,239 @@ static void IRInit(void)
     MAP_GPIOIntEnable(IR_GPIO_PORT, IR_GPIO_PIN);
 }
 
-static void Uart1Init(void)
+// UART1 transmit queue: whole frames, sent by the UART interrupt from the
+// TX FIFO refill. s_txq[s_txTail] is on the wire once s_txPos > 0. The
+// main loop only touches the queue with the TX interrupt masked, and frames
+// of the same kind that have not started yet are overwritten rather than
+// queued behind each other, so only the newest control frame goes out.
+typedef struct {
+    unsigned char data[UART1_TX_FRAME_MAX];
+    int len;
+    int kind;
+} TxFrame;
+
+static TxFrame s_txq[UART1_TX_SLOTS];
+static volatile unsigned int s_txHead = 0;
+static volatile unsigned int s_txTail = 0;
+static volatile int s_txPos = 0;
+
+static unsigned int Uart1TxDepth(void)
 {
+    return s_txHead - s_txTail;
+}
+
+// Top up the TX FIFO. Leaves the TX interrupt enabled only while frames
+// remain, since the FIFO-level interrupt would otherwise keep firing.
+static void Uart1TxPump(void)
+{
+    TxFrame *f;
+
+    while (s_txTail != s_txHead) {
+        f = &s_txq[s_txTail % UART1_TX_SLOTS];
+        while ((s_txPos < f->len) && MAP_UARTSpaceAvail(UARTA1_BASE)) {
+            MAP_UARTCharPutNonBlocking(UARTA1_BASE, f->data[s_txPos++]);
+        }
+        if (s_txPos < f->len) {
+            MAP_UARTIntEnable(UARTA1_BASE, UART_INT_TX);
+            return;
+        }
+        s_txPos = 0;
+        s_txTail++;
+    }
+    MAP_UARTIntDisable(UARTA1_BASE, UART_INT_TX);
+}
+
+// Queue a frame (ASCII line or binary wire frame) and return at once. A
+// frame with a kind other than TX_KIND_NONE replaces a queued frame of that
+// kind that has not started sending. Returns 0 if the frame was dropped
+// (queue full or too long).
+static int Uart1TxFrame(const void *data, int len, int kind)
+{
+    unsigned int i;
+    TxFrame *f = 0;
+
+    if (len > UART1_TX_FRAME_MAX) {
+        g_uart1TxDropped++;
+        return 0;
+    }
+
+    MAP_UARTIntDisable(UARTA1_BASE, UART_INT_TX);
+    if (kind != TX_KIND_NONE) {
+        for (i = s_txTail + (s_txPos > 0); i != s_txHead; i++) {
+            if (s_txq[i % UART1_TX_SLOTS].kind == kind) {
+                f = &s_txq[i % UART1_TX_SLOTS];
+                g_uart1TxCoalesced++;
+                break;
+            }
+        }
+    }
+    if (!f) {
+        if (Uart1TxDepth() >= UART1_TX_SLOTS) {
+            g_uart1TxDropped++;
+            Uart1TxPump();
+            return 0;
+        }
+        f = &s_txq[s_txHead % UART1_TX_SLOTS];
+        s_txHead++;
+        if (Uart1TxDepth() > g_uart1TxPeak) g_uart1TxPeak = Uart1TxDepth();
+        g_uart1TxLines++;
+    }
+    memcpy(f->data, data, len);
+    f->len = len;
+    f->kind = kind;
+    Uart1TxPump();
+    return 1;
+}
+
+// Move everything in the RX FIFO into the ring. RX fires at half full and
+// RT (receive timeout) picks up a frame's tail shorter than that, so the
+// 16-byte hardware FIFO is emptied long before it can overrun, however long
+// the main loop is busy. Overruns the ring cannot absorb are counted there.
+static void Uart1IntHandler(void)
+{
+    unsigned long status = MAP_UARTIntStatus(UARTA1_BASE, true);
+
+    MAP_UARTIntClear(UARTA1_BASE, status);
+    if (status & UART_INT_OE) {
+        g_uart1RxHwOverrun++;
+        MAP_UARTRxErrorClear(UARTA1_BASE);
+    }
+    while (MAP_UARTCharsAvail(UARTA1_BASE)) {
+        ByteRingPut(&g_uart1RxRing,
+                    (unsigned char)MAP_UARTCharGetNonBlocking(UARTA1_BASE));
+    }
+    if (status & UART_INT_TX) Uart1TxPump();
+}
+
+// UART1 receive queue: Uart1PollRx() assembles the next frame straight into
+// s_rxq[s_rxHead], so a finished frame is queued by bumping s_rxHead and is
+// parsed in place from its slot, never copied. One slot is always left for
+// assembly, so UART1_RX_SLOTS - 1 frames can wait; once they do, the poll
+// stops and the rest stays in g_uart1RxRing until they are released. A
+// frame is only lost when the ring itself overflows, which is counted in
+// g_uart1RxLate. Main-loop context only.
+typedef struct {
+    char data[UART1_RX_FRAME_MAX];
+    int len;
+    int kind;
+    unsigned long rxMs;     // TimebaseMillis() of the poll that completed it
+} RxFrame;
+
+static RxFrame s_rxq[UART1_RX_SLOTS];
+static unsigned int s_rxHead = 0;
+static unsigned int s_rxTail = 0;
+static int s_rxLen = 0;
+static int s_rxBinary = 0;
+static unsigned long s_rxPollMs = 0;
+static unsigned long s_rxRingDropped = 0;   // g_uart1RxRing.dropped at the last poll
+
+// Close the frame being assembled as kind and return the slot for the next.
+static RxFrame *Uart1RxQueue(int kind)
+{
+    RxFrame *f = &s_rxq[s_rxHead % UART1_RX_SLOTS];
+
+    f->data[s_rxLen] = '\0';
+    f->len = s_rxLen;
+    f->kind = kind;
+    f->rxMs = s_rxPollMs;
+    s_rxLen = 0;
+    s_rxHead++;
+    if (s_rxHead - s_rxTail > g_uart1RxPeak) g_uart1RxPeak = s_rxHead - s_rxTail;
+    return &s_rxq[s_rxHead % UART1_RX_SLOTS];
+}
+
+// Reprogram UART1 for g_baudRates[idx]. Only call with the TX queue empty
+// and the UART idle; a partly assembled RX frame is dropped, since its tail
+// will arrive at the new rate.
+static void Uart1SetBaud(int idx)
+{
+    g_baudIdx = idx;
     MAP_UARTConfigSetExpClk(UARTA1_BASE,
                             MAP_PRCMPeripheralClockGet(PRCM_UARTA1),
-                            UART1_BAUD,
+                            g_baudRates[idx],
                             (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
                              UART_CONFIG_PAR_NONE));
+    MAP_UARTFIFOLevelSet(UARTA1_BASE, UART_FIFO_TX1_8, UART_FIFO_RX4_8);
     MAP_UARTEnable(UARTA1_BASE);
+    s_rxLen = 0;
 }
 
-static void Uart1PollRx(void)
+static void Uart1Init(void)
 {
-    while (MAP_UARTCharsAvail(UARTA1_BASE)) {
-        unsigned char c = (unsigned char)MAP_UARTCharGet(UARTA1_BASE);
+    ByteRingInit(&g_uart1RxRing, g_uart1RxBuf, sizeof(g_uart1RxBuf));
+    Uart1SetBaud(0);
+    MAP_UARTIntRegister(UARTA1_BASE, Uart1IntHandler);
+    MAP_UARTIntClear(UARTA1_BASE, UART_INT_RX | UART_INT_RT | UART_INT_OE);
+    MAP_UARTIntEnable(UARTA1_BASE, UART_INT_RX | UART_INT_RT | UART_INT_OE);
+}
+
+// Assemble frames from the RX ring. A 0x00 switches to binary: bytes up to
+// the next 0x00 are one COBS frame and may contain '$' or LF. A '$' at the
+// start of a frame switches back to ASCII lines ending at CR/LF. Reads the
+// ring until it is empty or the slot queue is full, and returns the number
+// of frames waiting in the slot queue.
+static unsigned int Uart1PollRx(void)
+{
+    RxFrame *f = &s_rxq[s_rxHead % UART1_RX_SLOTS];
+    unsigned char c;
+
+    s_rxPollMs = TimebaseMillis();
+    if (g_uart1RxRing.dropped != s_rxRingDropped) {
+        // The ring refused bytes since the last poll, so a frame is gone
+        s_rxRingDropped = g_uart1RxRing.dropped;
+        g_uart1RxLate++;
+    }
+    while ((s_rxHead - s_rxTail < UART1_RX_SLOTS - 1) &&
+           ByteRingGet(&g_uart1RxRing, &c)) {
         g_uart1RxBytes++;
 
-        if (c == '$') {
-            g_softIdx = 0;
+        if (c == 0) {
+            s_rxBinary = 1;
+            if (s_rxLen > 0) f = Uart1RxQueue(RX_BINARY);
+            continue;
+        }
+
+        if (s_rxBinary && (s_rxLen >= LINK_WIRE_MAX - 2)) {
+            // Longer than any frame: the peer is back on ASCII lines
+            g_linkRxErrors++;
+            s_rxBinary = 0;
+            s_rxLen = 0;
+        }
+
+        if ((c == '$') && (!s_rxBinary || s_rxLen == 0)) {
+            s_rxBinary = 0;
+            s_rxLen = 0;
         }
 
-        if (c == '\n' || c == '\r') {
-            if (g_softIdx > 0) {
-                g_softLine[g_softIdx] = '\0';
-                strncpy(g_readyLine, g_softLine, sizeof(g_readyLine) - 1);
-                g_readyLine[sizeof(g_readyLine) - 1] = '\0';
+        if (!s_rxBinary && (c == '\n' || c == '\r')) {
+            if (s_rxLen > 0) {
                 g_uart1RxLines++;
-                g_sensorReady = 1;
+                f = Uart1RxQueue(RX_LINE);
             }
-            g_softIdx = 0;
             continue;
         }
 
-        if (g_softIdx >= (int)sizeof(g_softLine) - 1) {
+        if (s_rxLen >= UART1_RX_FRAME_MAX - 1) {
             g_uart1RxOverflow++;
-            g_softIdx = 0;
+            s_rxLen = 0;
             continue;
         }
 
-        g_softLine[g_softIdx++] = (char)c;
+        f->data[s_rxLen++] = (char)c;
     }
+    return s_rxHead - s_rxTail;
 }
 
-static void Uart1TxString(const char *s)
+// Oldest waiting frame, or 0. It stays put until Uart1RxRelease().
+static const RxFrame *Uart1RxPeek(void)
 {
-    const char *p = s;
-    while (*p) {
-        if (*p == '\n') g_uart1TxLines++;
-        p++;
-    }
-    while (*s) {
-        MAP_UARTCharPut(UARTA1_BASE, (unsigned char)*s++);
-    }
+    if (s_rxTail == s_rxHead) return 0;
+    return &s_rxq[s_rxTail % UART1_RX_SLOTS];
+}
+
+static void Uart1RxRelease(void)
+{
+    if (s_rxTail != s_rxHead) s_rxTail++;
 }
 
 static int set_time(void)
@@ -446,32 +807,19 @@ static int set_time(void)
     return SUCCESS;
 }
 
-static int ensureTlsSocket(void)
+static void cloudFailed(int err)
 {
-    if (g_sockID >= 0) return 0;
-    if (g_loopCount < g_nextCloudRetryLoop) return -1;
-
-    g_sockID = tls_connect();
-    if (g_sockID < 0) {
-        g_cloudOnline = 0;
-        g_lastCloudError = g_sockID;
-        snprintf(g_lastCloudOp, sizeof(g_lastCloudOp), "TLS");
-        g_nextCloudRetryLoop = g_loopCount + CLOUD_RETRY_COOLDOWN_LOOPS;
-        return -1;
-    }
-
-    g_cloudOnline = 1;
-    return 0;
+    HttpConnClose(&g_http);
+    g_cloudOnline = 0;
+    g_lastCloudError = err;
+    g_nextCloudRetryLoop = g_loopCount + CLOUD_RETRY_COOLDOWN_LOOPS;
 }
 
-static int http_post_path_json(int sock, const char *pathHeader, const char *json)
+static int http_build_post(char *sendBuf, int sendSize, const char *pathHeader, const char *json)
 {
-    char sendBuf[1400];
-    char recvBuf[512];
     int reqLen;
-    int ret;
 
-    reqLen = snprintf(sendBuf, sizeof(sendBuf),
+    reqLen = snprintf(sendBuf, sendSize,
                       "%s%s%s%s%s%d%s%s",
                       pathHeader,
                       HOSTHEADER,
@@ -481,104 +829,244 @@ static int http_post_path_json(int sock, const char *pathHeader, const char *jso
                       (int)strlen(json),
                       CLHEADER2,
                       json);
-    if (reqLen <= 0 || reqLen >= (int)sizeof(sendBuf)) return -3;
-
-    ret = sl_Send(sock, sendBuf, reqLen, 0);
-    if (ret < 0) return ret;
+    if (reqLen <= 0 || reqLen >= sendSize) return -3;
+    return reqLen;
+}
 
-    ret = sl_Recv(sock, recvBuf, sizeof(recvBuf) - 1, 0);
-    if (ret == SL_EAGAIN) return 0;
-    if (ret < 0) return ret;
-    recvBuf[ret] = '\0';
+static int http_build_get_shadow(char *sendBuf, int sendSize)
+{
+    int reqLen;
 
-    if (strstr(recvBuf, "HTTP/1.1 4") || strstr(recvBuf, "HTTP/1.1 5")) {
-        return -2;
-    }
+    reqLen = snprintf(sendBuf, sendSize, "%s%s%s\r\n", GETHEADER, HOSTHEADER, CHEADER);
+    if (reqLen <= 0 || reqLen >= sendSize) return -3;
+    return reqLen;
+}
 
-    return 0;
+static int mqttReady(void)
+{
+    return g_mqtt.state == MQTT_UP && g_mqtt.subscribed;
 }
 
-static int http_post_path_json_fire_and_forget(int sock, const char *pathHeader, const char *json)
+// Called for each matched shadow value as the document streams in. The
+// first occurrence of a key wins, as desired comes before reported in
+// every document AWS sends.
+static void onShadowValue(void *ctx, const JsonValue *v)
 {
-    char sendBuf[1400];
-    int reqLen;
-    int ret;
+    ShadowScan *scan = (ShadowScan *)ctx;
+    int end;
+
+    switch (v->path) {
+    case SHADOW_KEY_LEVEL:
+        if (v->type == JSON_STREAM_NUMBER && !scan->hasLevel) {
+            sscanf(v->text, "%d", &scan->level);
+            scan->hasLevel = 1;
+        }
+        break;
+
+    case SHADOW_KEY_URL:
+        // Long URLs arrive in pieces and go straight into place, but only
+        // while a mission is being waited for
+        if (v->type != JSON_STREAM_STRING || scan->urlDone || g_state != RS_MISSION) break;
+        end = v->offset + v->len;
+        if (end > (int)sizeof(g_s3MissionUrl) - 1) end = sizeof(g_s3MissionUrl) - 1;
+        if (end > v->offset) memcpy(g_s3MissionUrl + v->offset, v->text, end - v->offset);
+        if (end >= v->offset) g_s3MissionUrl[end] = '\0';
+        if (v->last) {
+            scan->hasUrl = (end > 0);
+            scan->urlDone = 1;
+        }
+        break;
 
-    reqLen = snprintf(sendBuf, sizeof(sendBuf),
-                      "%s%s%s%s%s%d%s%s",
-                      pathHeader,
-                      HOSTHEADER,
-                      CHEADER,
-                      CTHEADER,
-                      CLHEADER1,
-                      (int)strlen(json),
-                      CLHEADER2,
-                      json);
-    if (reqLen <= 0 || reqLen >= (int)sizeof(sendBuf)) return -3;
+    case SHADOW_KEY_READY:
+        if (v->type == JSON_STREAM_TRUE) scan->ready = 1;
+        break;
 
-    ret = sl_Send(sock, sendBuf, reqLen, 0);
-    if (ret < 0) return ret;
-    if (ret != reqLen) return -4;
-    return 0;
+    case SHADOW_KEY_CMD:
+        if (v->type == JSON_STREAM_STRING && v->offset == 0 && strcmp(v->text, "MISSION_READY") == 0) {
+            scan->ready = 1;
+        }
+        break;
+
+    case SHADOW_KEY_WINNER:
+        if (v->type == JSON_STREAM_STRING && v->offset == 0 && !scan->winnerDone) {
+            snprintf(g_cloudWinner, sizeof(g_cloudWinner), "%s", v->text);
+            scan->winnerDone = 1;
+        }
+        break;
+    }
 }
 
-static int http_post_json(int sock, const char *json)
+static void shadowScanBegin(ShadowScan *scan)
 {
-    return http_post_path_json(sock, POSTHEADER, json);
+    memset(scan, 0, sizeof(*scan));
+    JsonStreamInit(&scan->js, g_shadowKeys, sizeof(g_shadowKeys) / sizeof(g_shadowKeys[0]),
+                   onShadowValue, scan);
 }
 
-static int http_get_shadow(int sock, char *resp, int respSize)
+// HttpConnReadStep() body sink for the shadow GET
+static void onShadowBody(void *ctx, const char *data, int len)
 {
-    char sendBuf[256];
-    char *p = sendBuf;
-    int ret;
+    JsonStreamFeed(&((ShadowScan *)ctx)->js, data, len);
+}
 
-    strcpy(p, GETHEADER); p += strlen(GETHEADER);
-    strcpy(p, HOSTHEADER); p += strlen(HOSTHEADER);
-    strcpy(p, CHEADER); p += strlen(CHEADER);
-    strcpy(p, "\r\n"); p += 2;
+// Mission fields of a shadow document, whether fetched by pollCloudMission()
+// or pushed on the delta topic
+static void applyMissionDoc(ShadowScan *scan)
+{
+    int wasReady = g_missionReady;
+    int ret = JsonStreamEnd(&scan->js);
 
-    ret = sl_Send(sock, sendBuf, strlen(sendBuf), 0);
-    if (ret < 0) return ret;
+    // What matched before a malformed or cut-off spot still counts
+    if (ret != 0) UART_PRINT("Shadow JSON error %d\r\n", ret);
 
-    ret = sl_Recv(sock, resp, respSize - 1, 0);
-    if (ret == SL_EAGAIN) return -1;
-    if (ret < 0) return ret;
-    resp[ret] = '\0';
-    return ret;
+    if (scan->hasLevel) {
+        g_missionDifficulty = clampInt(scan->level, 1, 5);
+        g_missionReady = 1;
+    }
+    if (scan->hasUrl || scan->ready) g_missionReady = 1;
+
+    if (g_missionReady && !wasReady && g_missionAskMs != 0) {
+        LatencyStatsAdd(&g_missionLatency, TimebaseMillis() - g_missionAskMs);
+        g_missionAskMs = 0;
+    }
 }
 
-static int extract_json_int_value(const char *json, const char *key, int *out)
+static void cloudFail(int err)
 {
-    char pattern[64];
-    const char *p;
+    g_cloudJob.result = err;
+    g_cloudJob.step = CLOUD_CLOSE;
+}
 
-    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
-    p = strstr(json, pattern);
-    if (!p) return -1;
-    p += strlen(pattern);
-    while (*p == ' ' || *p == '\t') p++;
-    if (sscanf(p, "%d", out) == 1) return 0;
-    return -1;
+// A keep-alive socket the server dropped while we were idle can still take
+// the send; the send or the read shows it. Such a request goes out once
+// more on a fresh connection, so only failures of one of those count.
+static int cloudRetry(void)
+{
+    if (!g_cloudJob.reused || g_cloudJob.retried) return 0;
+    g_cloudJob.retried = 1;
+    g_http.reconnects++;
+    HttpConnClose(&g_http);
+    g_cloudJob.step = CLOUD_CONNECT;
+    return 1;
+}
+
+// Only one request is under way at a time, and none while the cloud is
+// cooling down after a failure.
+static int cloudClaim(void)
+{
+    if (g_cloudJob.step != CLOUD_IDLE) return -1;
+    if (g_loopCount < g_nextCloudRetryLoop) return -1;
+    return 0;
+}
+
+// g_cloudJob.req holds reqLen bytes of request (none for CLOUD_OP_OPEN)
+static void cloudStart(int op, int reqLen)
+{
+    g_cloudJob.op = op;
+    g_cloudJob.reqLen = reqLen;
+    g_cloudJob.sent = 0;
+    g_cloudJob.retried = 0;
+    g_cloudJob.result = 0;
+    g_cloudJob.step = CLOUD_CONNECT;
 }
 
-static int extract_json_string_value(const char *json, const char *key, char *out, int outSize)
+// Moves the cloud request one step along: connect, send, receive, parse,
+// or close after a failure. Each call is a bounded slice of non-blocking
+// socket work, so a slow or silent endpoint costs loops rather than
+// stalling the OLED, IR and UART1 for seconds. The connection in g_http
+// stays open between requests; only the first after a failure or an idle
+// timeout pays for DNS and the handshake.
+static void cloudStep(void)
 {
-    char pattern[96];
-    const char *p;
-    int i = 0;
+    unsigned long now = TimebaseMillis();
+    int ret;
+
+    switch (g_cloudJob.step) {
+    case CLOUD_CONNECT:
+        ret = HttpConnConnect(&g_http, now);
+        if (ret == HTTP_CONN_PENDING) return;
+        if (ret < 0) {
+            snprintf(g_lastCloudOp, sizeof(g_lastCloudOp), "TLS");
+            cloudFail(ret);
+            return;
+        }
+        g_cloudOnline = 1;
+        g_cloudJob.reused = g_http.used;
+        g_cloudJob.sent = 0;
+        g_cloudJob.step = (g_cloudJob.op == CLOUD_OP_OPEN) ? CLOUD_IDLE : CLOUD_SEND;
+        return;
 
-    snprintf(pattern, sizeof(pattern), "\"%s\":\"", key);
-    p = strstr(json, pattern);
-    if (!p) return -1;
-    p += strlen(pattern);
+    case CLOUD_SEND:
+        // The mission request's answer is not waited for: HttpConnPoll()
+        // reads it off the connection in the background.
+        ret = HttpConnSendStep(&g_http, g_cloudJob.req, g_cloudJob.reqLen, &g_cloudJob.sent,
+                               g_cloudJob.op != CLOUD_OP_REQUEST, now);
+        if (ret == HTTP_CONN_PENDING) return;
+        // HttpConnPoll() lost the connection over an older response
+        if (ret == HTTP_CONN_ERR_NONE && g_cloudJob.sent == 0) {
+            g_cloudJob.step = CLOUD_CONNECT;
+            return;
+        }
+        if (ret < 0) {
+            if (!cloudRetry()) cloudFail(ret);
+            return;
+        }
+        if (g_cloudJob.op == CLOUD_OP_REQUEST) {
+            g_lastCloudError = 0;
+            g_cloudJob.step = CLOUD_IDLE;
+        } else {
+            if (g_cloudJob.op == CLOUD_OP_POLL) shadowScanBegin(&g_pollScan);
+            g_cloudJob.step = CLOUD_RECV;
+        }
+        return;
 
-    while (*p && *p != '"' && i < outSize - 1) {
-        if (*p == '\\' && *(p + 1)) p++;
-        out[i++] = *p++;
+    case CLOUD_RECV:
+        // The shadow document is tokenized slice by slice as it comes in;
+        // the report's answer is of no interest beyond its status
+        ret = HttpConnReadStep(&g_http, (g_cloudJob.op == CLOUD_OP_POLL) ? onShadowBody : 0,
+                               &g_pollScan, now);
+        if (ret == HTTP_CONN_PENDING) return;
+        if (ret == HTTP_CONN_ERR_NONE) ret = g_http.lastError;
+        // A report the server never answers has still gone out
+        if (ret == HTTP_CONN_ERR_TIMEOUT && g_cloudJob.op == CLOUD_OP_REPORT) ret = 200;
+        if (ret < 0) {
+            if ((ret != HTTP_CONN_ERR_STALE && ret != HTTP_CONN_ERR_CLOSED) || !cloudRetry()) {
+                cloudFail(ret);
+            }
+            return;
+        }
+        g_cloudJob.result = ret;
+        g_cloudJob.step = CLOUD_PARSE;
+        return;
+
+    case CLOUD_PARSE:
+        if (g_cloudJob.result >= 400) {
+            cloudFail(-2);
+            return;
+        }
+        if (g_cloudJob.op == CLOUD_OP_POLL) {
+            if (g_state == RS_MISSION) applyMissionDoc(&g_pollScan);
+        } else if (g_cloudJob.op == CLOUD_OP_REPORT) {
+            g_shadowDirty = 0;
+            g_roundReported = 1;
+        }
+        g_cloudOnline = 1;
+        g_lastCloudError = 0;
+        g_cloudJob.step = CLOUD_IDLE;
+        return;
+
+    case CLOUD_CLOSE:
+        cloudFailed(g_cloudJob.result);
+        if (g_cloudJob.op == CLOUD_OP_REQUEST) g_missionRequested = 0;
+        if (g_cloudJob.op == CLOUD_OP_REPORT) {
+            UART_PRINT("SYNC publish failed: err=%d\r\n", g_cloudJob.result);
+        }
+        g_cloudJob.step = CLOUD_IDLE;
+        return;
+
+    default:
+        return;
     }
-    out[i] = '\0';
-    return (i > 0) ? 0 : -1;
 }
 
 static int requestCloudMission(void)
@@ -587,76 +1075,53 @@ static int requestCloudMission(void)
     int ret;
 
     snprintf(g_lastCloudOp, sizeof(g_lastCloudOp), "REQ");
-    if (ensureTlsSocket() < 0) return -1;
-
     snprintf(payload, sizeof(payload),
              "{\"state\":{\"desired\":{\"cmd\":\"MISSION_REQUEST\",\"project\":\"AEGIS-172\",\"mission_level\":%d}}}",
              g_missionDifficulty);
 
-    ret = http_post_json(g_sockID, payload);
+    // With the MQTT session up the answer is pushed on the delta topic
+    if (mqttReady() &&
+        MqttPublish(&g_mqtt, SHADOW_TOPIC, payload, strlen(payload), 1, TimebaseMillis()) >= 0) {
+        g_missionAskMs = TimebaseMillis();
+        return 0;
+    }
+
+    if (cloudClaim() < 0) return -1;
+    ret = http_build_post(g_cloudJob.req, sizeof(g_cloudJob.req), POSTHEADER, payload);
     if (ret < 0) {
-        sl_Close(g_sockID);
-        g_sockID = -1;
-        g_cloudOnline = 0;
         g_lastCloudError = ret;
-        g_nextCloudRetryLoop = g_loopCount + CLOUD_RETRY_COOLDOWN_LOOPS;
         return -1;
-    } else {
-        sl_Close(g_sockID);
-        g_sockID = -1;
-        g_lastCloudError = 0;
     }
+    cloudStart(CLOUD_OP_REQUEST, ret);
+    g_missionAskMs = TimebaseMillis();
     return 0;
 }
 
 static int pollCloudMission(void)
 {
-    int missionLevel = 0;
+    int ret;
 
     snprintf(g_lastCloudOp, sizeof(g_lastCloudOp), "POLL");
-    if (ensureTlsSocket() < 0) return -1;
-    if (http_get_shadow(g_sockID, g_httpBuf, sizeof(g_httpBuf)) < 0) {
-        g_lastCloudError = -2;
-        sl_Close(g_sockID);
-        g_sockID = -1;
-        g_cloudOnline = 0;
-        g_nextCloudRetryLoop = g_loopCount + CLOUD_RETRY_COOLDOWN_LOOPS;
-        return -1;
-    }
-
-    if (extract_json_int_value(g_httpBuf, "mission_level", &missionLevel) == 0) {
-        g_missionDifficulty = clampInt(missionLevel, 1, 5);
-        g_missionReady = 1;
-    }
-
-    if (extract_json_string_value(g_httpBuf, "mission_url", g_s3MissionUrl, sizeof(g_s3MissionUrl)) == 0) {
-        g_missionReady = 1;
-    }
-
-    if (strstr(g_httpBuf, "\"mission_ready\":true") || strstr(g_httpBuf, "MISSION_READY")) {
-        g_missionReady = 1;
-    }
-
-    sl_Close(g_sockID);
-    g_sockID = -1;
-    g_lastCloudError = 0;
+    if (cloudClaim() < 0) return -1;
+    ret = http_build_get_shadow(g_cloudJob.req, sizeof(g_cloudJob.req));
+    if (ret < 0) return -1;
+    cloudStart(CLOUD_OP_POLL, ret);
     return 0;
 }
 
-static int awsShadowUpdate(int roundDone)
+static int buildShadowReport(char *payload, int payloadSize, int roundDone)
 {
-    char payload[512];
     int payloadLen;
-    int ret;
-
-    snprintf(g_lastCloudOp, sizeof(g_lastCloudOp), "SYNC");
-    if (ensureTlsSocket() < 0) return -1;
 
-    payloadLen = snprintf(payload, sizeof(payload),
+    payloadLen = snprintf(payload, payloadSize,
                           "{\"state\":{\"reported\":{\"project\":\"AEGIS-172\",\"cmd\":\"%s\",\"phase\":\"%s\","
                           "\"mission_level\":%d,\"defender_score\":%d,\"attacker_score\":%d,\"threat\":%d,"
                           "\"sector\":%d,\"shield\":%d,\"distance\":%d,\"winner\":\"%s\",\"round_done\":%s,"
-                          "\"telemetry_drops\":%lu}}}",
+                          "\"telemetry_drops\":%lu,\"link_baud\":%lu,\"latency_samples\":%lu,"
+                          "\"avg_latency_ms\":%lu,\"min_latency_ms\":%lu,\"p95_latency_ms\":%lu,"
+                          "\"max_latency_ms\":%lu,\"host_latency_ms\":%lu,\"frame_age_ms\":%ld,\"stale_frames\":%lu,"
+                          "\"tls_handshakes\":%lu,\"handshakes_avoided\":%lu,\"mission_latency_ms\":%lu,"
+                          "\"loop_worst_us\":%lu,\"slow_loops\":%lu}}}",
                           roundDone ? "ROUND_DONE" : "ROUND_UPDATE",
                           stateLabel(g_state),
                           g_missionDifficulty,
@@ -668,38 +1133,127 @@ static int awsShadowUpdate(int roundDone)
                           g_sensor.distCm,
                           winnerLabel(),
                           roundDone ? "true" : "false",
-                          g_softParseFail);
-    if (payloadLen <= 0 || payloadLen >= (int)sizeof(payload)) {
-        g_lastCloudError = -3;
-        return -1;
-    }
+                          g_softParseFail,
+                          g_baudRates[g_baudIdx],
+                          g_latency.count,
+                          LatencyStatsAvg(&g_latency),
+                          LatencyStatsMin(&g_latency),
+                          LatencyStatsPercentile(&g_latency, 95),
+                          g_latency.max,
+                          LatencyStatsAvg(&g_hostLatency),
+                          g_frameAgeMs,
+                          g_staleFrames,
+                          g_http.handshakes,
+                          g_http.avoided,
+                          LatencyStatsAvg(&g_missionLatency),
+                          g_loopWorstUs,
+                          g_loopSlow);
+    if (payloadLen <= 0 || payloadLen >= payloadSize) return -3;
+    return payloadLen;
+}
+
+static int awsShadowUpdate(int roundDone)
+{
+    char payload[768];
+    int ret;
+
+    snprintf(g_lastCloudOp, sizeof(g_lastCloudOp), "SYNC");
+    if (cloudClaim() < 0) return -1;
 
-    ret = http_post_json(g_sockID, payload);
+    ret = buildShadowReport(payload, sizeof(payload), roundDone);
+    if (ret > 0) ret = http_build_post(g_cloudJob.req, sizeof(g_cloudJob.req), POSTHEADER, payload);
     if (ret < 0) {
-        sl_Close(g_sockID);
-        g_sockID = -1;
-        g_cloudOnline = 0;
         g_lastCloudError = ret;
-        g_nextCloudRetryLoop = g_loopCount + CLOUD_RETRY_COOLDOWN_LOOPS;
         return -1;
-    } else {
-        sl_Close(g_sockID);
-        g_sockID = -1;
-        g_cloudOnline = 1;
-        g_shadowDirty = 0;
-        g_lastCloudError = 0;
     }
+
+    // cloudStep() clears g_shadowDirty and sets g_roundReported on the answer
+    cloudStart(CLOUD_OP_REPORT, ret);
     return 0;
 }
 
+static void onMqttMessage(void *ctx, const char *topic, int topicLen,
+                          const char *payload, int payloadLen)
+{
+    if (topicLen != (int)strlen(SHADOW_DELTA_TOPIC) ||
+        memcmp(topic, SHADOW_DELTA_TOPIC, topicLen) != 0) {
+        return;
+    }
+    shadowScanBegin(&g_pushScan);
+    JsonStreamFeed(&g_pushScan.js, payload, payloadLen);
+    if (g_state == RS_MISSION) applyMissionDoc(&g_pushScan);
+}
+
+// Keeps the MQTT session on the shadow topics up. The TLS connect is
+// stepped like the HTTP one and retried on the cloud cooldown; everything
+// after that runs from MqttPoll() without waiting.
+static void mqttService(void)
+{
+    static const char *const topics[1] = { SHADOW_DELTA_TOPIC };
+    unsigned long now = TimebaseMillis();
+    int ret;
+
+    if (g_mqtt.state == MQTT_DOWN) {
+        if (!g_mqttConnecting) {
+            if (!IS_IP_ACQUIRED(g_ulStatus) || g_loopCount < g_nextMqttRetryLoop) return;
+            g_nextMqttRetryLoop = g_loopCount + CLOUD_RETRY_COOLDOWN_LOOPS;
+
+            ret = tls_connect_begin(&g_mqttConnect, MQTT_PORT);
+            if (ret < 0) {
+                g_mqtt.lastError = ret;
+                return;
+            }
+            g_mqttConnecting = 1;
+        }
+
+        ret = tls_connect_poll(&g_mqttConnect);
+        if (ret == TLS_CONNECT_PENDING) return;
+        g_mqttConnecting = 0;
+        if (ret < 0) {
+            g_mqtt.lastError = ret;
+            return;
+        }
+        if (MqttConnect(&g_mqtt, g_mqttConnect.sock, MQTT_CLIENT_ID, MQTT_KEEPALIVE_S, now) < 0) return;
+    }
+
+    if (MqttPoll(&g_mqtt, now) < 0) return;
+
+    if (g_mqtt.state == MQTT_UP && g_mqtt.subscribeId == 0) {
+        MqttSubscribe(&g_mqtt, topics, 1, 1, now);
+    }
+
+    if (g_roundReportId != 0) {
+        if (g_mqtt.ackedId == g_roundReportId) {
+            g_roundReported = 1;
+            g_shadowDirty = 0;
+        }
+        // Acknowledged, or lost with the session: publishRoundEvent() retries
+        if (g_mqtt.inflightId != g_roundReportId) g_roundReportId = 0;
+    }
+}
+
 static int publishRoundEvent(void)
 {
-    int ret = awsShadowUpdate(1);
-    if (ret == 0) {
-        g_roundReported = 1;
-        return 0;
+    char payload[768];
+    int ret;
+
+    // Over MQTT the round only counts as reported once mqttService() sees
+    // the PUBACK; until then the client resends on its own.
+    if (mqttReady()) {
+        snprintf(g_lastCloudOp, sizeof(g_lastCloudOp), "SYNC");
+        if (g_roundReportId == 0) {
+            ret = buildShadowReport(payload, sizeof(payload), 1);
+            if (ret > 0) ret = MqttPublish(&g_mqtt, SHADOW_TOPIC, payload, ret, 1, TimebaseMillis());
+            if (ret > 0) g_roundReportId = ret;
+        }
+        if (g_roundReportId != 0) return 0;
     }
 
+    // Reported once cloudStep() has the response; a failure there is
+    // logged there too
+    ret = awsShadowUpdate(1);
+    if (ret == 0 || g_cloudJob.step != CLOUD_IDLE) return ret;
+
     UART_PRINT("SYNC publish failed: ret=%d err=%d\r\n", ret, g_lastCloudError);
     return ret;
 }
@@ -725,6 +1279,8 @@ static void updateShieldFromJoystick(void)
 
 static void setState(RoundState next)
 {
+    unsigned long now;
+
     g_state = next;
     g_stateStartLoop = g_loopCount;
     g_shadowDirty = 1;
@@ -756,6 +1312,7 @@ static void setState(RoundState next)
         g_buzzMode = 0;
         g_rgbCode = 5;
         g_missionReady = 0;
+        g_missionRequested = 0;
         g_lastMissionRequestLoop = g_loopCount - MISSION_REQUEST_RETRY_LOOPS;
         g_lastMissionPollLoop = g_loopCount;
     } else if (g_state == RS_PREP) {
@@ -769,6 +1326,9 @@ static void setState(RoundState next)
         g_lastScoreLoop = g_loopCount;
         g_stepMode = 2;
         g_roundReported = 0;
+        LatencyStatsReset(&g_latency);
+        LatencyStatsReset(&g_hostLatency);
+        g_lastEchoRef = 0;
     } else if (g_state == RS_JUDGE) {
         g_stepMode = 0;
         g_buzzMode = 0;
@@ -785,7 +1345,9 @@ static void setState(RoundState next)
         g_rgbCode = (g_defenderScore >= g_attackerScore) ? 1 : 3;
     }
 
-    UART_PRINT("STATE -> %s\n\r", stateLabel(g_state));
+    now = TimebaseMillis();
+    UART_PRINT("STATE -> %s t=%lu ct=%lu\n\r", stateLabel(g_state), now,
+               g_clock.synced ? ClockSyncToRemote(&g_clock, now) : 0);
 }
 
 static void sendControlFrame(void)
@@ -796,6 +1358,8 @@ static void sendControlFrame(void)
     static int lastRgb = -999;
     static int lastState = -999;
     char out[96];
+    LinkControl control;
+    unsigned long refMs = 0;
     int changed;
 
     changed = (g_servoDeg != lastServo) ||
@@ -808,9 +1372,29 @@ static void sendControlFrame(void)
     if (changed && loopsSince(g_lastControlLoop) < CONTROL_INTERVAL_LOOPS) return;
 
     g_lastControlLoop = g_loopCount;
-    snprintf(out, sizeof(out), "$C,%d,%d,%d,%d,%d\n",
-             g_servoDeg, g_stepMode, g_buzzMode, g_rgbCode, (int)g_state);
-    Uart1TxString(out);
+    // Only a frame that changes the outputs answers the last $S; keepalives
+    // carry 0 so the coprocessor does not echo them.
+    if (changed) {
+        refMs = g_sensor.ms;
+        if (g_sensorUnanswered && (g_state == RS_ACTIVE)) {
+            LatencyStatsAdd(&g_hostLatency, TimebaseMillis() - g_sensorRxMs);
+        }
+        g_sensorUnanswered = 0;
+    }
+    if (g_linkBinary) {
+        control.refMs = refMs;
+        control.servoDeg = g_servoDeg;
+        control.stepMode = g_stepMode;
+        control.buzzMode = g_buzzMode;
+        control.rgbCode = g_rgbCode;
+        control.state = (int)g_state;
+        Uart1TxFrame(out, LinkEncodeControl(&control, g_linkTxSeq++, (unsigned char *)out),
+                     TX_KIND_CONTROL);
+    } else {
+        snprintf(out, sizeof(out), "$C,%d,%d,%d,%d,%d,%lu\n",
+                 g_servoDeg, g_stepMode, g_buzzMode, g_rgbCode, (int)g_state, refMs);
+        Uart1TxFrame(out, strlen(out), TX_KIND_CONTROL);
+    }
     lastServo = g_servoDeg;
     lastStep = g_stepMode;
     lastBuzz = g_buzzMode;
@@ -818,31 +1402,78 @@ static void sendControlFrame(void)
     lastState = (int)g_state;
 }
 
-static int parseSensorFrame(const char *line)
-{
-    unsigned long ms = 0;
-    int sector = 0;
-    int distCm = 0;
-    int lux = 0;
-    int tilt = 0;
-    int tempC10 = 0;
-    int hum10 = 0;
-    int aux = 0;
-    int joy = 0;
-
-    if (sscanf(line, "$S,%lu,%d,%d,%d,%d,%d,%d,%d,%d",
-               &ms, &sector, &distCm, &lux, &tilt, &tempC10, &hum10, &aux, &joy) == 9) {
-        g_sensor.ms = ms;
-        g_sensor.sector = clampInt(sector, 0, SECTOR_COUNT - 1);
-        g_sensor.distCm = clampInt(distCm, 2, 400);
-        g_sensor.lux = clampInt(lux, 0, 1023);
-        g_sensor.tilt = 0;
-        g_sensor.tempC10 = clampInt(tempC10, -200, 800);
-        g_sensor.hum10 = clampInt(hum10, 0, 1000);
-        g_sensor.aux = aux;
-        g_sensor.joy = clampInt(joy, 0, 1023);
-        g_lastSensorLoop = g_loopCount;
-        g_waitingForSensor = 0;
+static void setRange(int sector, int cm)
+{
+    if (g_rangeCm[sector] == cm) return;
+    g_rangeCm[sector] = cm;
+    g_rangeStamp++;
+}
+
+// A delta sweep only means something on top of the sweep just before it;
+// after a gap, ignore deltas until the coprocessor's next key frame.
+static void applySweep(const LinkSweep *sweep)
+{
+    int i;
+
+    if (!sweep->key && ((g_sweepNo < 0) || (sweep->sweep != (unsigned char)(g_sweepNo + 1)))) {
+        if (g_sweepNo >= 0) g_sweepGaps++;
+        g_sweepNo = -1;
+        return;
+    }
+    for (i = 0; i < SECTOR_COUNT; i++) {
+        if (sweep->key) {
+            g_sweepBaseCm[i] = sweep->value[i];
+        } else if (sweep->mask & (1U << i)) {
+            g_sweepBaseCm[i] += sweep->value[i];
+        }
+        setRange(i, clampInt(g_sweepBaseCm[i], 2, RADAR_NO_ECHO_CM));
+    }
+    g_sweepNo = sweep->sweep;
+    g_sweepFrames++;
+}
+
+static void applySensorFrame(const LinkSensor *frame)
+{
+    g_sensor.ms = frame->ms;
+    g_sensor.sector = clampInt(frame->sector, 0, SECTOR_COUNT - 1);
+    g_sensor.distCm = clampInt(frame->distCm, 2, 400);
+    g_sensor.lux = clampInt(frame->lux, 0, 1023);
+    g_sensor.tilt = 0;
+    g_sensor.tempC10 = clampInt(frame->tempC10, -200, 800);
+    g_sensor.hum10 = clampInt(frame->hum10, 0, 1000);
+    g_sensor.aux = frame->aux;
+    g_sensor.joy = clampInt(frame->joy, 0, 1023);
+    setRange(g_sensor.sector, g_sensor.distCm);
+    g_lastSensorLoop = g_loopCount;
+    g_sensorRxMs = TimebaseMillis();
+    g_sensorUnanswered = 1;
+    g_waitingForSensor = 0;
+}
+
+// The coprocessor applied a control frame that answered its $S at refMs.
+// Both stamps come from its millis(), so no clock sync is needed; anything
+// negative, absurdly late or already counted is dropped.
+static void applyLatencyEcho(const LinkApplied *applied)
+{
+    unsigned long ms = applied->appliedMs - applied->refMs;
+
+    if ((applied->refMs == 0) || (applied->refMs == g_lastEchoRef)) return;
+    if ((applied->appliedMs < applied->refMs) || (ms > LATENCY_MAX_MS)) {
+        g_latencyRejected++;
+        return;
+    }
+    g_lastEchoRef = applied->refMs;
+    if (g_state == RS_ACTIVE) {
+        LatencyStatsAdd(&g_latency, ms);
+    }
+}
+
+static int parseSensorFrame(const char *line, int len)
+{
+    LinkSensor frame;
+
+    if (LinkParseSensorText(line, len, &frame) == 0) {
+        applySensorFrame(&frame);
         g_softParseOk++;
         return 0;
     }
@@ -851,8 +1482,262 @@ static int parseSensorFrame(const char *line)
     return -1;
 }
 
+// Ask the coprocessor to switch to binary frames. A peer that answers
+// "$A,PONG" (or never answers) only speaks ASCII, so give up after
+// LINK_PING_TRIES and keep the ASCII protocol.
+static void linkNegotiate(void)
+{
+    static const char ping[] = LINK_PING_BINARY "\n";
+
+    if (g_linkBinary || (g_linkPingTries >= LINK_PING_TRIES)) return;
+    if (loopsSince(g_lastLinkPingLoop) < LINK_PING_LOOPS) return;
+    g_lastLinkPingLoop = g_loopCount;
+    g_linkPingTries++;
+    Uart1TxFrame(ping, sizeof(ping) - 1, TX_KIND_NONE);
+}
+
+// Time to clock len bytes (8N1) out at the current rate, in ms.
+static unsigned long wireMs(int len)
+{
+    unsigned long baud = g_baudRates[g_baudIdx];
+
+    return ((unsigned long)len * 10000UL + baud / 2) / baud;
+}
+
+// Start a clock exchange. Only sent with the TX queue empty, so t1 is when
+// the line really starts going out, and never while a rate change is in
+// flight. A reply that never comes is simply superseded by the next ping.
+static void clockPing(void)
+{
+    char line[24];
+
+    // Until the first window closes there is no timebase at all, so fill
+    // it quickly
+    if (loopsSince(g_lastClockPingLoop) < (g_clock.synced ? CLOCK_PING_LOOPS : CLOCK_PING_LOOPS / 4)) return;
+    if ((g_baudState == BAUD_ASKED) || (g_baudState == BAUD_SWITCH)) return;
+    if (Uart1TxDepth() > 0) return;
+
+    g_lastClockPingLoop = g_loopCount;
+    g_clockPingT1 = TimebaseMillis();
+    g_clockPingLen = snprintf(line, sizeof(line), LINK_TIME_CMD "%lu\n", g_clockPingT1);
+    g_clockPingPending = Uart1TxFrame(line, g_clockPingLen, TX_KIND_NONE);
+}
+
+// The stamps mark the end of the request (t2, as the peer parses it) and
+// the start of the reply (t3), so take the serialization of each line out
+// of t1 and t4 before treating the two legs as symmetric.
+static void clockReply(const RxFrame *f, unsigned long t1, unsigned long t2, unsigned long t3)
+{
+    if (!g_clockPingPending || (t1 != g_clockPingT1)) return;
+    g_clockPingPending = 0;
+    ClockSyncAdd(&g_clock, t1 + wireMs(g_clockPingLen), t2, t3, f->rxMs - wireMs(f->len + 2));
+}
+
+// Age of the sensor frame just applied, from its coprocessor timestamp. No
+// frame can sit in the RX path for seconds, so an age that far off means
+// the coprocessor restarted and its millis() began again; that is a lost
+// timebase, not a stale frame.
+static void trackFrameAge(const RxFrame *f)
+{
+    long age;
+
+    if (!g_clock.synced) return;
+    age = (long)(f->rxMs - ClockSyncToLocal(&g_clock, g_sensor.ms));
+    if ((age > FRAME_AGE_LOST_MS) || (age < -FRAME_AGE_LOST_MS)) {
+        ClockSyncRestart(&g_clock);
+        g_clockPingPending = 0;
+        return;
+    }
+    g_frameAgeMs = age;
+    if (age > FRAME_STALE_MS) g_staleFrames++;
+}
+
+static unsigned long linkErrorCount(void)
+{
+    return g_softParseFail + g_linkRxErrors + g_uart1RxHwOverrun;
+}
+
+static void baudWindowStart(void)
+{
+    g_baudStateLoop = g_loopCount;
+    g_baudWindowOk = g_softParseOk;
+    g_baudWindowErr = linkErrorCount();
+}
+
+// Judge the frames seen since baudWindowStart(): -1 if the error rate is
+// over LINK_BAUD_MAX_ERR_PCT, 0 if too few frames arrived to tell, 1 if
+// the link is clean.
+static int baudWindowHealth(void)
+{
+    unsigned long ok = g_softParseOk - g_baudWindowOk;
+    unsigned long err = linkErrorCount() - g_baudWindowErr;
+
+    if ((err * 100UL) > ((ok + err) * LINK_BAUD_MAX_ERR_PCT)) return -1;
+    if (ok < LINK_BAUD_MIN_FRAMES) return 0;
+    return 1;
+}
+
+static void linkBaudRequest(int target)
+{
+    char cmd[24];
+    int n;
+
+    g_baudTarget = target;
+    g_baudState = BAUD_ASKED;
+    g_baudStateLoop = g_loopCount;
+    n = snprintf(cmd, sizeof(cmd), LINK_BAUD_CMD "%lu\n", g_baudRates[target]);
+    Uart1TxFrame(cmd, n, TX_KIND_NONE);
+}
+
+// Walk UART1 up the LINK_BAUD_RATES ladder while the link stays clean. Each
+// step is asked for with "$B,<baud>", switched once the coprocessor's ack is
+// in and our TX queue has drained, then kept only if LINK_BAUD_PROBE_LOOPS
+// of traffic at the new rate pass baudWindowHealth(). A failed rate becomes
+// the ceiling; a link that goes quiet drops straight back to the base rate,
+// which is where the coprocessor's own silence timeout puts it too.
+static void linkBaudStep(void)
+{
+    int health;
+    int prev;
+
+    if ((g_baudIdx > 0) && (g_baudState != BAUD_SWITCH) &&
+        (loopsSince(g_lastSensorLoop) > LINK_BAUD_SILENCE_LOOPS)) {
+        if (g_baudState == BAUD_PROBE) g_baudCeiling = g_baudIdx - 1;
+        g_baudFallbacks++;
+        g_baudState = BAUD_IDLE;
+        Uart1SetBaud(0);
+        baudWindowStart();
+        g_shadowDirty = 1;
+        return;
+    }
+
+    switch (g_baudState) {
+    case BAUD_IDLE:
+        if (loopsSince(g_baudStateLoop) < LINK_BAUD_DWELL_LOOPS) return;
+        health = baudWindowHealth();
+        g_baudAskTries = 0;
+        if ((health < 0) && (g_baudIdx > 0)) {
+            g_baudCeiling = g_baudIdx - 1;
+            g_baudFallbacks++;
+            linkBaudRequest(g_baudIdx - 1);
+        } else if ((health > 0) && (g_baudIdx < g_baudCeiling)) {
+            linkBaudRequest(g_baudIdx + 1);
+        } else {
+            baudWindowStart();
+        }
+        return;
+
+    case BAUD_ASKED:
+        if (loopsSince(g_baudStateLoop) < LINK_BAUD_ACK_LOOPS) return;
+        if (++g_baudAskTries < LINK_BAUD_ASK_TRIES) {
+            linkBaudRequest(g_baudTarget);
+            return;
+        }
+        if (g_baudTarget < g_baudIdx) {
+            // Too noisy for the ack to get through: step down anyway and
+            // let the silence timeout sort out a peer that stayed behind.
+            g_baudState = BAUD_SWITCH;
+            return;
+        }
+        // No "$B" support on the other end; stay at this rate for good.
+        g_baudCeiling = g_baudIdx;
+        g_baudState = BAUD_IDLE;
+        baudWindowStart();
+        return;
+
+    case BAUD_SWITCH:
+        if ((Uart1TxDepth() > 0) || MAP_UARTBusy(UARTA1_BASE)) return;
+        prev = g_baudIdx;
+        Uart1SetBaud(g_baudTarget);
+        g_baudState = (g_baudTarget > prev) ? BAUD_PROBE : BAUD_IDLE;
+        g_lastSensorLoop = g_loopCount;
+        baudWindowStart();
+        g_shadowDirty = 1;
+        return;
+
+    case BAUD_PROBE:
+        if (loopsSince(g_baudStateLoop) < LINK_BAUD_PROBE_LOOPS) return;
+        if (baudWindowHealth() > 0) {
+            g_baudState = BAUD_IDLE;
+            baudWindowStart();
+            return;
+        }
+        g_baudCeiling = g_baudIdx - 1;
+        g_baudFallbacks++;
+        g_baudAskTries = 0;
+        linkBaudRequest(g_baudIdx - 1);
+        return;
+    }
+}
+
+// Returns 0 if the frame updated g_sensor.
+static int handleBusFrame(const RxFrame *f)
+{
+    const char *line = f->data;
+    LinkFrame frame;
+    unsigned long baud;
+    unsigned long t1, t2, t3;
+
+    if (f->kind == RX_BINARY) {
+        if (LinkDecode((const unsigned char *)f->data, f->len, &frame) <= 0) {
+            g_linkRxErrors++;
+            return -1;
+        }
+        g_linkRxFrames++;
+        if (frame.type == LINK_TYPE_APPLIED) {
+            applyLatencyEcho(&frame.u.applied);
+            return -1;
+        }
+        if (frame.type == LINK_TYPE_SWEEP) {
+            applySweep(&frame.u.sweep);
+            return -1;
+        }
+        if (frame.type != LINK_TYPE_SENSOR) return -1;
+        applySensorFrame(&frame.u.sensor);
+        trackFrameAge(f);
+        g_softParseOk++;
+        return 0;
+    }
+
+    if (sscanf(line, LINK_BAUD_ACK "%lu", &baud) == 1) {
+        if ((g_baudState == BAUD_ASKED) && (baud == g_baudRates[g_baudTarget])) {
+            g_baudState = BAUD_SWITCH;
+        }
+        return -1;
+    }
+    if (sscanf(line, LINK_TIME_ACK "%lu,%lu,%lu", &t1, &t2, &t3) == 3) {
+        clockReply(f, t1, t2, t3);
+        return -1;
+    }
+    if (strcmp(line, LINK_PONG_BINARY) == 0) {
+        g_linkBinary = 1;
+        return -1;
+    }
+    if (strncmp(line, "$A,PONG", 7) == 0) {
+        g_linkPingTries = LINK_PING_TRIES;
+        return -1;
+    }
+    if (LinkParseAppliedText(line, f->len, &frame.u.applied) == 0) {
+        applyLatencyEcho(&frame.u.applied);
+        return -1;
+    }
+    if (g_linkBinary && (strncmp(line, "$S,", 3) == 0)) {
+        // The coprocessor restarted and is back on ASCII; renegotiate.
+        g_linkBinary = 0;
+        g_linkPingTries = 0;
+    }
+    if (parseSensorFrame(line, f->len) < 0) return -1;
+    trackFrameAge(f);
+    return 0;
+}
+
 static void handleIrButton(int button)
 {
+    if (button == BTN_LOG_VIEW) {
+        g_logView = !g_logView;
+        return;
+    }
+
     if (button == BTN_ABORT || button == BTN_RESET) {
         setState(RS_BOOT);
         return;
@@ -877,7 +1762,7 @@ static void handleIrButton(int button)
     }
 
     if (button == BTN_MISSION && g_state == RS_MISSION) {
-        requestCloudMission();
+        if (requestCloudMission() == 0) g_missionRequested = 1;
         return;
     }
 
@@ -989,7 +1874,24 @@ static void updateStateMachine(void)
     }
 
     if (g_state == RS_MISSION) {
-        if (elapsed >= MISSION_WAIT_LOOPS) {
+        // The request goes out first and is not waited for. With the MQTT
+        // session up the answer is pushed; otherwise the polls behind the
+        // request share its connection, so only the first can pay a handshake.
+        if (!g_missionReady && !g_forceLocalMission) {
+            if (!g_missionRequested && loopsSince(g_lastMissionRequestLoop) >= MISSION_REQUEST_RETRY_LOOPS) {
+                g_lastMissionRequestLoop = g_loopCount;
+                g_missionRequested = (requestCloudMission() == 0);
+            } else if (g_missionRequested && !mqttReady() &&
+                       loopsSince(g_lastMissionPollLoop) >= MISSION_POLL_LOOPS) {
+                // Waits its turn behind a request still under way
+                if (pollCloudMission() == 0) g_lastMissionPollLoop = g_loopCount;
+            }
+        }
+
+        // A poll already on the wire gets to finish, as it did when it held
+        // up the whole loop; HTTP_CONN_TIMEOUT_MS still bounds it.
+        if (elapsed >= MISSION_WAIT_LOOPS &&
+            !(g_cloudJob.op == CLOUD_OP_POLL && g_cloudJob.step != CLOUD_IDLE)) {
             setState(RS_PREP);
         }
         return;
@@ -1081,7 +1983,43 @@ static void drawSectorMarkers(int cx, int cy)
     }
 }
 
-static void drawRadar(void)
+// Rings and sector spokes: redrawn only when the screen is rebuilt.
+static unsigned int rangeColor(int cm)
+{
+    if (cm < DIST_NEAR) return RED;
+    if (cm < DIST_MED) return YELLOW;
+    if (cm < DIST_FAR) return MAGENTA;
+    return WHITE;
+}
+
+// One dot per sector with an echo inside RADAR_RANGE_CM, further out for
+// further returns.
+static void drawRangeReturns(int cx, int cy)
+{
+    int i;
+    int r;
+
+    for (i = 0; i < SECTOR_COUNT; i++) {
+        if (g_rangeCm[i] >= RADAR_RANGE_CM) continue;
+        r = 6 + (g_rangeCm[i] * 26) / RADAR_RANGE_CM;
+        fillRect(cx + (g_sectorDx[i] * r) / 32 - 1, cy + (g_sectorDy[i] * r) / 32 - 1, 2, 2,
+                 rangeColor(g_rangeCm[i]));
+    }
+}
+
+static void drawRadarBackground(void)
+{
+    int cx = 64;
+    int cy = 66;
+
+    drawCircle(cx, cy, 34, WHITE);
+    drawCircle(cx, cy, 22, BLUE);
+    drawSectorMarkers(cx, cy);
+}
+
+// Everything on the radar that moves. With the framebuffer these are drawn
+// under a save-under log so the next frame can lift them off again.
+static void drawRadarSprites(void)
 {
     int cx = 64;
     int cy = 66;
@@ -1092,9 +2030,7 @@ static void drawRadar(void)
     int sweepX = cx + g_sectorDx[g_sensor.sector];
     int sweepY = cy + g_sectorDy[g_sensor.sector];
 
-    drawCircle(cx, cy, 34, WHITE);
-    drawCircle(cx, cy, 22, BLUE);
-    drawSectorMarkers(cx, cy);
+    drawRangeReturns(cx, cy);
     drawLine(cx, cy, sweepX, sweepY, CYAN);
     fillCircle(threatX, threatY, 4, (g_cachedThreat >= 9) ? RED : YELLOW);
     fillCircle(shieldX, shieldY, 4, GREEN);
@@ -1125,14 +2061,42 @@ static void drawThreatMeter(int threat)
     }
 }
 
-static void drawOLED(void)
+// Screen regions drawOLED() can render independently. drawOLED() works
+// through pending chunks in this order and stops once DRAW_BUDGET_US is
+// spent, so a full rebuild is spread over several loop passes instead of
+// starving UART parsing for a whole frame.
+#define DRAW_LAYOUT           0x01
+#define DRAW_RADAR            0x02
+#define DRAW_SCORE            0x04
+#define DRAW_FOOTER           0x08
+#define DRAW_HEADER           0x10
+#define DRAW_ALL              0x1F
+
+static int s_radarRebuild = 1;
+
+static int roundRemaining(void)
 {
-    char line[40];
-    char line2[40];
     unsigned long elapsed = loopsSince(g_stateStartLoop);
     int remaining = 0;
-    int currentAttackMode;
-    static int s_init = 0;
+
+    if (g_state == RS_ACTIVE) {
+        if (elapsed < ACTIVE_ROUND_LOOPS) {
+            remaining = (int)((ACTIVE_ROUND_LOOPS - elapsed) / 50);
+        }
+    } else if (g_state == RS_PREP) {
+        remaining = (int)((PREP_LOOPS - elapsed) / 40);
+    }
+    if (remaining < 0) remaining = 0;
+    return remaining;
+}
+
+// Compare what is on screen with the game state and return the chunks
+// that need redrawing. A state change clears the screen, so it needs all.
+static int drawDirtyChunks(void)
+{
+    int remaining = roundRemaining();
+    int currentAttackMode = attackMode();
+    int dirty = 0;
     static RoundState s_state = (RoundState)(-1);
     static int s_cloudOnline = -1;
     static int s_missionReady = -1;
@@ -1147,126 +2111,35 @@ static void drawOLED(void)
     static int s_dist = -1;
     static int s_remaining = -1;
     static int s_attackMode = -1;
-    int headerDirty;
-    int scoreDirty;
-    int radarDirty;
-    int footerDirty;
-
-    if (loopsSince(g_lastDrawLoop) < DRAW_INTERVAL_LOOPS) return;
-    g_lastDrawLoop = g_loopCount;
+    static unsigned long s_rangeStamp = 0;
 
-    if (g_state == RS_ACTIVE) {
-        if (elapsed < ACTIVE_ROUND_LOOPS) {
-            remaining = (int)((ACTIVE_ROUND_LOOPS - elapsed) / 50);
+    if (s_state != g_state) {
+        dirty = DRAW_ALL;
+    } else {
+        if ((s_cloudOnline != g_cloudOnline) ||
+            (s_missionReady != g_missionReady) ||
+            (s_missionDifficulty != g_missionDifficulty)) {
+            dirty |= DRAW_HEADER;
         }
-    } else if (g_state == RS_PREP) {
-        remaining = (int)((PREP_LOOPS - elapsed) / 40);
-    }
-    if (remaining < 0) remaining = 0;
-    currentAttackMode = attackMode();
-
-    if (!s_init || s_state != g_state) {
-        fillScreen(BLACK);
-        fillRect(0, 0, 128, 14, BLUE);
-        fillRect(0, 108, 128, 20, CYAN);
-        drawText(4, 18, CYAN, BLACK, "DEF");
-        drawText(4, 48, MAGENTA, BLACK, "ATK");
-        s_init = 1;
-        s_cloudOnline = -1;
-        s_missionReady = -1;
-        s_missionDifficulty = -1;
-        s_defenderScore = -1;
-        s_attackerScore = -1;
-        s_sensorSector = -1;
-        s_shieldSector = -1;
-        s_threatSector = -1;
-        s_threat = -1;
-        s_blocked = -1;
-        s_dist = -1;
-        s_remaining = -1;
-        s_attackMode = -1;
-    }
-
-    headerDirty = (s_state != g_state) ||
-                  (s_cloudOnline != g_cloudOnline) ||
-                  (s_missionReady != g_missionReady) ||
-                  (s_missionDifficulty != g_missionDifficulty);
-    scoreDirty = (s_state != g_state) ||
-                 (s_defenderScore != g_defenderScore) ||
-                 (s_attackerScore != g_attackerScore);
-    radarDirty = (s_state != g_state) ||
-                 (s_sensorSector != g_sensor.sector) ||
-                 (s_shieldSector != g_shieldSector) ||
-                 (s_threatSector != g_cachedThreatSector) ||
-                 (s_threat != g_cachedThreat) ||
-                 (s_blocked != g_cachedBlocked);
-    footerDirty = (s_state != g_state) ||
-                  (s_threat != g_cachedThreat) ||
-                  (s_dist != g_sensor.distCm) ||
-                  (s_shieldSector != g_shieldSector) ||
-                  (s_threatSector != g_cachedThreatSector) ||
-                  (s_remaining != remaining) ||
-                  (s_attackMode != currentAttackMode);
-
-    if (headerDirty) {
-        fillRect(0, 0, 128, 14, BLUE);
-        drawText(2, 3, WHITE, BLUE, stateLabel(g_state));
-        snprintf(line, sizeof(line), "M%d %-5s", g_missionDifficulty, cloudLabel());
-        drawText(56, 3, WHITE, BLUE, line);
-    }
-
-    if (scoreDirty) {
-        fillRect(0, 28, 24, 12, BLACK);
-        snprintf(line, sizeof(line), "%03d", g_defenderScore % 1000);
-        drawText(4, 30, WHITE, BLACK, line);
-
-        fillRect(0, 58, 24, 12, BLACK);
-        snprintf(line, sizeof(line), "%03d", g_attackerScore % 1000);
-        drawText(4, 60, WHITE, BLACK, line);
-    }
-
-    if (radarDirty) {
-        fillRect(24, 16, 96, 92, BLACK);
-        drawRadar();
-        drawThreatMeter(g_cachedThreat);
-        if (g_state == RS_END) {
-            fillRect(20, 46, 88, 22, BLACK);
-            drawRect(20, 46, 88, 22, WHITE);
-            snprintf(line, sizeof(line), "%s WINS", winnerLabel());
-            drawText(34, 53, WHITE, BLACK, line);
+        if ((s_defenderScore != g_defenderScore) ||
+            (s_attackerScore != g_attackerScore)) {
+            dirty |= DRAW_SCORE;
         }
-    }
-
-    if (footerDirty) {
-        fillRect(0, 108, 128, 20, CYAN);
-        if (g_state == RS_BOOT) {
-            drawText(2, 111, BLACK, CYAN, "1 START  5 RESET");
-            drawText(2, 119, BLACK, CYAN, "GRN=YOU ORG=THRT");
-        } else if (g_state == RS_CALIBRATE) {
-            drawText(2, 111, BLACK, CYAN, "CALIBRATING");
-            drawText(2, 119, BLACK, CYAN, "HOLD STEADY");
-        } else if (g_state == RS_MISSION) {
-            drawText(2, 111, BLACK, CYAN, "AWS MISSION");
-            snprintf(line, sizeof(line), "M%d %-5s", g_missionDifficulty, cloudLabel());
-            drawText(2, 119, BLACK, CYAN, line);
-        } else if (g_state == RS_PREP) {
-            drawText(2, 111, BLACK, CYAN, "JOY MOVE  HAND THRT");
-            snprintf(line, sizeof(line), "4/6/8 ATK   %02d", remaining);
-            drawText(2, 119, BLACK, CYAN, line);
-        } else if (g_state == RS_ACTIVE) {
-            snprintf(line, sizeof(line), "TH%02d D%03d %s", g_cachedThreat, g_sensor.distCm, attackLabel());
-            drawText(2, 111, BLACK, CYAN, line);
-            snprintf(line2, sizeof(line2), "JOY SHLD  4P6J8B");
-            drawText(2, 119, BLACK, CYAN, line2);
-        } else if (g_state == RS_END) {
-            drawText(2, 111, BLACK, CYAN, "END 5 RESET");
-            snprintf(line, sizeof(line), "%s WINS", winnerLabel());
-            drawText(2, 119, BLACK, CYAN, line);
-        } else {
-            snprintf(line, sizeof(line), "T%02d D%03d %-5s", g_cachedThreat, g_sensor.distCm, attackLabel());
-            drawText(2, 111, BLACK, CYAN, line);
-            snprintf(line2, sizeof(line2), "S%02d H%02d %02d", g_cachedThreatSector, g_shieldSector, remaining);
-            drawText(2, 119, BLACK, CYAN, line2);
+        if ((s_sensorSector != g_sensor.sector) ||
+            (s_shieldSector != g_shieldSector) ||
+            (s_threatSector != g_cachedThreatSector) ||
+            (s_threat != g_cachedThreat) ||
+            (s_blocked != g_cachedBlocked) ||
+            (s_rangeStamp != g_rangeStamp)) {
+            dirty |= DRAW_RADAR;
+        }
+        if ((s_threat != g_cachedThreat) ||
+            (s_dist != g_sensor.distCm) ||
+            (s_shieldSector != g_shieldSector) ||
+            (s_threatSector != g_cachedThreatSector) ||
+            (s_remaining != remaining) ||
+            (s_attackMode != currentAttackMode)) {
+            dirty |= DRAW_FOOTER;
         }
     }
 
@@ -1284,6 +2157,240 @@ static void drawOLED(void)
     s_dist = g_sensor.distCm;
     s_remaining = remaining;
     s_attackMode = currentAttackMode;
+    s_rangeStamp = g_rangeStamp;
+    return dirty;
+}
+
+static void drawLayoutChunk(void)
+{
+    fillScreen(BLACK);
+    fillRect(0, 0, 128, 14, BLUE);
+    fillRect(0, 108, 128, 20, CYAN);
+    drawText(4, 18, CYAN, BLACK, "DEF");
+    drawText(4, 48, MAGENTA, BLACK, "ATK");
+    if (g_state == RS_BOOT) {
+        drawSprite(1, 76, &sprite_shield);
+    } else if (g_state == RS_END) {
+        drawSprite(1, 76, &sprite_trophy);
+    }
+    discardSaveUnder();
+    s_radarRebuild = 1;
+}
+
+// Sits on top of the radar and clips the score boxes, so both the radar
+// and score chunks repaint it.
+static void drawEndBanner(void)
+{
+    char line[40];
+
+    fillRect(20, 46, 88, 22, BLACK);
+    drawRect(20, 46, 88, 22, WHITE);
+    snprintf(line, sizeof(line), "%s WINS", winnerLabel());
+    drawText(34, 53, WHITE, BLACK, line);
+}
+
+static void drawRadarChunk(void)
+{
+    // The threat meter and END banner overlap the sprites and are
+    // repainted on top each time, so they never need saving.
+    if (s_radarRebuild || !restoreSaveUnder()) {
+        discardSaveUnder();
+        fillRect(24, 16, 96, 92, BLACK);
+        drawRadarBackground();
+        s_radarRebuild = 0;
+    }
+    beginSaveUnder();
+    drawRadarSprites();
+    endSaveUnder();
+    drawThreatMeter(g_cachedThreat);
+    if (g_state == RS_END) drawEndBanner();
+}
+
+static void drawScoreChunk(void)
+{
+    char line[40];
+
+    fillRect(0, 28, 24, 12, BLACK);
+    snprintf(line, sizeof(line), "%03d", g_defenderScore % 1000);
+    drawText(4, 30, WHITE, BLACK, line);
+
+    fillRect(0, 58, 24, 12, BLACK);
+    snprintf(line, sizeof(line), "%03d", g_attackerScore % 1000);
+    drawText(4, 60, WHITE, BLACK, line);
+
+    if (g_state == RS_END) drawEndBanner();
+}
+
+static void drawFooterChunk(void)
+{
+    char line[40];
+    char line2[40];
+    int remaining = roundRemaining();
+
+    fillRect(0, 108, 128, 20, CYAN);
+    if (g_state == RS_BOOT) {
+        drawText(2, 111, BLACK, CYAN, "1 START  5 RESET");
+        drawText(2, 119, BLACK, CYAN, "GRN=YOU ORG=THRT");
+    } else if (g_state == RS_CALIBRATE) {
+        drawText(2, 111, BLACK, CYAN, "CALIBRATING");
+        drawText(2, 119, BLACK, CYAN, "HOLD STEADY");
+    } else if (g_state == RS_MISSION) {
+        drawText(2, 111, BLACK, CYAN, "AWS MISSION");
+        snprintf(line, sizeof(line), "M%d %-5s", g_missionDifficulty, cloudLabel());
+        drawText(2, 119, BLACK, CYAN, line);
+    } else if (g_state == RS_PREP) {
+        drawText(2, 111, BLACK, CYAN, "JOY MOVE  HAND THRT");
+        snprintf(line, sizeof(line), "4/6/8 ATK   %02d", remaining);
+        drawText(2, 119, BLACK, CYAN, line);
+    } else if (g_state == RS_ACTIVE) {
+        snprintf(line, sizeof(line), "TH%02d D%03d %s", g_cachedThreat, g_sensor.distCm, attackLabel());
+        drawText(2, 111, BLACK, CYAN, line);
+        snprintf(line2, sizeof(line2), "JOY SHLD  4P6J8B");
+        drawText(2, 119, BLACK, CYAN, line2);
+    } else if (g_state == RS_END) {
+        drawText(2, 111, BLACK, CYAN, "END 5 RESET");
+        snprintf(line, sizeof(line), "%s WINS", winnerLabel());
+        drawText(2, 119, BLACK, CYAN, line);
+    } else {
+        snprintf(line, sizeof(line), "T%02d D%03d %-5s", g_cachedThreat, g_sensor.distCm, attackLabel());
+        drawText(2, 111, BLACK, CYAN, line);
+        snprintf(line2, sizeof(line2), "S%02d H%02d %02d", g_cachedThreatSector, g_shieldSector, remaining);
+        drawText(2, 119, BLACK, CYAN, line2);
+    }
+}
+
+static void drawHeaderChunk(void)
+{
+    char line[40];
+
+    fillRect(0, 0, 128, 14, BLUE);
+    drawText(2, 3, WHITE, BLUE, stateLabel(g_state));
+    snprintf(line, sizeof(line), "M%d %-5s", g_missionDifficulty, cloudLabel());
+    drawText(56, 3, WHITE, BLUE, line);
+}
+
+// Diagnostics page: LOG_VIEW_LINES text rows in a ring over the whole of
+// GDDRAM. A new line overwrites the oldest slot and the panel start line
+// moves down one row of text, so scrolling costs one 6x8 line of pixels
+// instead of a repaint. The start line is only moved once the line has
+// been flushed (see flushOLED), so the stale slot never shows.
+static int s_logHead = 0;
+
+static void logViewPush(const char *text)
+{
+    char line[LOG_VIEW_CHARS + 1];
+
+    if (!g_oledFlushPending) g_oledTxMark = txByteCount();
+    snprintf(line, sizeof(line), "%-21s", text);
+    drawText(0, s_logHead * 8, GREEN, BLACK, line);
+    s_logHead = (s_logHead + 1) % LOG_VIEW_LINES;
+    g_logStartPending = s_logHead * 8;
+    g_oledFlushPending = 1;
+}
+
+static void logViewEnter(void)
+{
+    g_drawPending = 0;
+    discardSaveUnder();
+    fillScreen(BLACK);
+    s_logHead = 0;
+    logViewPush("AEGIS-172 DIAG");
+}
+
+// Put the panel back to row 0 once the rebuilt game screen is flushed.
+static void logViewExit(void)
+{
+    g_drawPending = DRAW_ALL;
+    g_logStartPending = 0;
+}
+
+// Render pending chunks until the loop's time budget runs out. At least one
+// chunk is drawn per call so a slow chunk cannot stall the screen; whatever
+// is left stays in g_drawPending for the next pass, and the frame is only
+// handed to flushOLED() once it is complete.
+static void drawOLED(void)
+{
+    static const struct {
+        int bit;
+        void (*draw)(void);
+    } s_chunks[] = {
+        {DRAW_LAYOUT, drawLayoutChunk},
+        {DRAW_RADAR, drawRadarChunk},
+        {DRAW_SCORE, drawScoreChunk},
+        {DRAW_FOOTER, drawFooterChunk},
+        {DRAW_HEADER, drawHeaderChunk},
+    };
+    static int s_logView = 0;
+    unsigned long start;
+    unsigned long spent = 0;
+    int wasIdle;
+    int i;
+
+    if (s_logView != g_logView) {
+        s_logView = g_logView;
+        if (g_logView) {
+            logViewEnter();
+        } else {
+            logViewExit();
+        }
+    }
+    if (g_logView) return;
+
+    wasIdle = (g_drawPending == 0);
+    if (loopsSince(g_lastDrawLoop) >= DRAW_INTERVAL_LOOPS) {
+        g_lastDrawLoop = g_loopCount;
+        g_drawPending |= drawDirtyChunks();
+    }
+    if (!g_drawPending) return;
+    if (wasIdle && !g_oledFlushPending) g_oledTxMark = txByteCount();
+
+    start = TimebaseMicros();
+    for (i = 0; i < (int)(sizeof(s_chunks) / sizeof(s_chunks[0])); i++) {
+        if (!(g_drawPending & s_chunks[i].bit)) continue;
+        if (spent >= DRAW_BUDGET_US) break;
+        s_chunks[i].draw();
+        g_drawPending &= ~s_chunks[i].bit;
+        spent = TimebaseMicros() - start;
+    }
+
+    if (spent > g_drawWorstUs) g_drawWorstUs = spent;
+    if (spent > DRAW_BUDGET_US) g_drawOverruns++;
+    if (g_drawPending) {
+        g_drawCarryovers++;
+        return;
+    }
+    g_oledFlushPending = 1;
+}
+
+static void OledFlushDoneHandler(void)
+{
+    g_oledFlushDone++;
+}
+
+// Hand the last rendered frame to the display DMA. If the previous frame is
+// still being clocked out, retry on the next loop pass; rendering meanwhile
+// keeps landing in the framebuffer.
+static void flushOLED(void)
+{
+    if ((g_logStartPending >= 0) && !g_oledFlushPending && !g_drawPending &&
+        !flushBusy()) {
+        setStartLine((unsigned char)g_logStartPending);
+        g_logStartPending = -1;
+    }
+    if (!g_oledFlushPending) return;
+    if (!flushDisplay()) {
+        g_oledFlushDeferred++;
+        return;
+    }
+    g_oledFrameBytes = txByteCount() - g_oledTxMark;
+    g_oledFlushPending = 0;
+}
+
+static void noteLoopTime(unsigned long us)
+{
+    if (us > g_loopWorstUs) g_loopWorstUs = us;
+    if (us > g_loopWindowWorstUs) g_loopWindowWorstUs = us;
+    if (us > LOOP_SLOW_US) g_loopSlow++;
 }
 
 static void logStatus(void)
@@ -1291,27 +2398,100 @@ static void logStatus(void)
     if (loopsSince(g_lastLogLoop) < LOG_INTERVAL_LOOPS) return;
     g_lastLogLoop = g_loopCount;
 
-    UART_PRINT("DBG state=%s txL=%lu rxB=%lu rxL=%lu ok=%lu bad=%lu ovf=%lu irE=%lu irC=%lu joy=%d dist=%d tilt=%d cloud=%s op=%s err=%d\n\r",
+    UART_PRINT("DBG state=%s txL=%lu txq=%u txp=%lu txd=%lu txc=%lu rxB=%lu rxL=%lu ok=%lu bad=%lu lnk=%s lrf=%lu lre=%lu bd=%lu bdc=%lu bdf=%lu ovf=%lu rdr=%lu hwo=%lu rpk=%lu rxp=%lu rlt=%lu lat=%lu/%lu/%lu/%lu n=%lu lrj=%lu hlat=%lu clk=%s off=%ld dr=%ld rtt=%lu cst=%lu age=%ld stl=%lu swp=%lu/%lu irE=%lu irC=%lu joy=%d dist=%d tilt=%d oled=%lu ofl=%lu ofd=%lu dov=%lu dco=%lu dwu=%lu lpw=%lu/%lu lps=%lu tls=%lu/%lu hrc=%lu hid=%lu hdp=%lu dns=%lu/%lu/%lu mq=%d/%lu/%lu/%lu mlat=%lu/%lu cw=%s cloud=%s op=%s err=%d\n\r",
                stateLabel(g_state),
                g_uart1TxLines,
+               Uart1TxDepth(),
+               g_uart1TxPeak,
+               g_uart1TxDropped,
+               g_uart1TxCoalesced,
                g_uart1RxBytes,
                g_uart1RxLines,
                g_softParseOk,
                g_softParseFail,
+               g_linkBinary ? "bin" : "asc",
+               g_linkRxFrames,
+               g_linkRxErrors,
+               g_baudRates[g_baudIdx],
+               g_baudRates[g_baudCeiling],
+               g_baudFallbacks,
                g_uart1RxOverflow,
+               g_uart1RxRing.dropped,
+               g_uart1RxHwOverrun,
+               g_uart1RxRing.peak,
+               g_uart1RxPeak,
+               g_uart1RxLate,
+               LatencyStatsMin(&g_latency),
+               LatencyStatsAvg(&g_latency),
+               LatencyStatsPercentile(&g_latency, 95),
+               g_latency.max,
+               g_latency.count,
+               g_latencyRejected,
+               LatencyStatsAvg(&g_hostLatency),
+               g_clock.synced ? "ok" : "-",
+               ClockSyncOffset(&g_clock, TimebaseMillis()),
+               g_clock.driftPpm,
+               g_clock.rttMs,
+               g_clock.steps,
+               g_frameAgeMs,
+               g_staleFrames,
+               g_sweepFrames,
+               g_sweepGaps,
                g_irEdgeCount,
                g_irCodeCount,
                g_sensor.joy,
                g_sensor.distCm,
                g_sensor.tilt,
+               g_oledFrameBytes,
+               g_oledFlushDone,
+               g_oledFlushDeferred,
+               g_drawOverruns,
+               g_drawCarryovers,
+               g_drawWorstUs,
+               g_loopWindowWorstUs,
+               g_loopWorstUs,
+               g_loopSlow,
+               g_http.handshakes,
+               g_http.avoided,
+               g_http.reconnects,
+               g_http.idleCloses,
+               g_http.dropped,
+               g_dnsCache.hits,
+               g_dnsCache.lookups,
+               g_dnsCache.staleHits,
+               g_mqtt.state,
+               g_mqtt.received,
+               g_mqtt.acked,
+               g_mqtt.resent,
+               LatencyStatsAvg(&g_missionLatency),
+               g_missionLatency.count,
+               g_cloudWinner[0] ? g_cloudWinner : "-",
                cloudLabel(),
                g_lastCloudOp,
                g_lastCloudError);
+    g_loopWindowWorstUs = 0;
+
+    if (g_logView) {
+        char line[40];
+
+        snprintf(line, sizeof(line), "%-4s IR%lu/%lu J%d", stateLabel(g_state),
+                 g_irCodeCount, g_irEdgeCount, g_sensor.joy);
+        logViewPush(line);
+        snprintf(line, sizeof(line), "RX%lu OK%lu B%lu D%lu", g_uart1RxBytes,
+                 g_softParseOk, g_softParseFail,
+                 g_uart1RxRing.dropped + g_uart1RxHwOverrun);
+        logViewPush(line);
+        snprintf(line, sizeof(line), "OL%lu DV%lu W%lu %s", g_oledFrameBytes,
+                 g_drawOverruns, g_drawWorstUs, cloudLabel());
+        logViewPush(line);
+    }
 }
 
 int main(void)
 {
+    unsigned long loopStartUs;
     int button;
+    const RxFrame *rx;
 
     BoardInit();
     PinMuxConfig();
@@ -1323,8 +2503,10 @@ int main(void)
     GPIO_IF_LedConfigure(LED1 | LED3);
     GPIO_IF_LedOff(MCU_ALL_LED_IND);
 
+    TimebaseInit();
     SPIInit();
     Adafruit_Init();
+    setFlushCallback(OledFlushDoneHandler);
     fillScreen(BLACK);
     setTextSize(1);
     setTextColor(WHITE, BLACK);
@@ -1333,35 +2515,31 @@ int main(void)
     Uart1Init();
     I2C_IF_Open(I2C_MASTER_MODE_FST);
 
+    HttpConnInit(&g_http, SERVER_PORT);
+    MqttInit(&g_mqtt, onMqttMessage, 0);
     g_app_config.host = (signed char *)SERVER_NAME;
     g_app_config.port = SERVER_PORT;
 
     if (connectToAccessPoint() == SUCCESS) {
         set_time();
-        g_sockID = tls_connect();
-        if (g_sockID >= 0) {
-            sl_Close(g_sockID);
-            g_sockID = -1;
-            g_cloudOnline = 1;
-        } else {
-            g_sockID = -1;
-            g_cloudOnline = 0;
-        }
+        // Connected in the background and kept open for the first shadow
+        // request
+        cloudStart(CLOUD_OP_OPEN, 0);
     }
 
     setState(RS_BOOT);
 
     while (1) {
-        Uart1PollRx();
-
-        if (g_sensorReady) {
-            if (parseSensorFrame(g_readyLine) == 0) {
-                g_shadowDirty = 1;
+        loopStartUs = TimebaseMicros();
+        // The slot queue holds only a few frames; refill it from the ring
+        // until both are empty
+        while (Uart1PollRx() > 0) {
+            while ((rx = Uart1RxPeek()) != 0) {
+                if (handleBusFrame(rx) == 0) {
+                    g_shadowDirty = 1;
+                }
+                Uart1RxRelease();
             }
-            g_softIdx = 0;
-            g_softLine[0] = '\0';
-            g_readyLine[0] = '\0';
-            g_sensorReady = 0;
         }
 
         if (g_codeReady) {
@@ -1375,10 +2553,18 @@ int main(void)
         }
 
         updateStateMachine();
+        HttpConnPoll(&g_http, TimebaseMillis());
+        cloudStep();
+        mqttService();
+        linkNegotiate();
+        clockPing();
+        linkBaudStep();
         sendControlFrame();
 
         drawOLED();
+        flushOLED();
         logStatus();
+        noteLoopTime(TimebaseMicros() - loopStartUs);
 
         MAP_UtilsDelay(LOOP_DELAY_TICKS);
         g_loopCount++;
@@ -0,0 +1,149 @@
+// Host micro-benchmark for the ASCII sensor frame parser.
+//
+// Runs every line of the corpus through LinkParseSensorText() and through
+// the nine-field sscanf() that parseSensorFrame() used before it, checks
+// that the two agree, and times both. The tokenizer is stricter than
+// sscanf (no leading blanks, '+' signs, overlong numbers or trailing
+// bytes), so lines that only sscanf accepts are listed rather than failed.
+// A line that only the tokenizer accepts, or a field the two decode
+// differently, is a bug and makes the run fail.
+//
+//   frame_bench <corpus file> [iterations]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "utils/link_codec.h"
+
+#define MAX_LINES       1024
+#define LINE_MAX_LEN    128
+#define DEFAULT_ITERS   2000
+
+typedef struct {
+    char text[LINE_MAX_LEN];
+    int len;
+} Line;
+
+static Line s_lines[MAX_LINES];
+static int s_lineCount = 0;
+
+static int loadCorpus(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char buf[LINE_MAX_LEN];
+    int len;
+
+    if (!f) {
+        printf("cannot open %s\n", path);
+        return -1;
+    }
+    while (fgets(buf, sizeof(buf), f) && s_lineCount < MAX_LINES) {
+        len = (int)strcspn(buf, "\r\n");
+        buf[len] = '\0';
+        if (len == 0 || buf[0] == '#') continue;
+        memcpy(s_lines[s_lineCount].text, buf, len + 1);
+        s_lines[s_lineCount].len = len;
+        s_lineCount++;
+    }
+    fclose(f);
+    return s_lineCount;
+}
+
+// The parser main.c used before LinkParseSensorText().
+static int parseScanf(const char *line, LinkSensor *frame)
+{
+    if (sscanf(line, "$S,%lu,%d,%d,%d,%d,%d,%d,%d,%d",
+               &frame->ms, &frame->sector, &frame->distCm, &frame->lux, &frame->tilt,
+               &frame->tempC10, &frame->hum10, &frame->aux, &frame->joy) == 9) {
+        return 0;
+    }
+    return -1;
+}
+
+static int sameFrame(const LinkSensor *a, const LinkSensor *b)
+{
+    return a->ms == b->ms && a->sector == b->sector && a->distCm == b->distCm &&
+           a->lux == b->lux && a->tilt == b->tilt && a->tempC10 == b->tempC10 &&
+           a->hum10 == b->hum10 && a->aux == b->aux && a->joy == b->joy;
+}
+
+static double nowNs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Returns the number of lines accepted per pass, so the compiler cannot
+// drop the work.
+static double timeParser(int useScanf, int iters, int *accepted)
+{
+    LinkSensor frame;
+    double start;
+    int i, j, ok = 0;
+
+    start = nowNs();
+    for (i = 0; i < iters; i++) {
+        ok = 0;
+        for (j = 0; j < s_lineCount; j++) {
+            if (useScanf) {
+                ok += (parseScanf(s_lines[j].text, &frame) == 0);
+            } else {
+                ok += (LinkParseSensorText(s_lines[j].text, s_lines[j].len, &frame) == 0);
+            }
+        }
+    }
+    *accepted = ok;
+    return (nowNs() - start) / ((double)iters * s_lineCount);
+}
+
+int main(int argc, char **argv)
+{
+    LinkSensor a, b;
+    int iters = DEFAULT_ITERS;
+    int i, ra, rb;
+    int both = 0, neither = 0, scanfOnly = 0, bugs = 0;
+    int okScanf, okTok;
+    double nsScanf, nsTok;
+
+    if (argc < 2) {
+        printf("usage: %s <corpus file> [iterations]\n", argv[0]);
+        return 2;
+    }
+    if (argc > 2) iters = atoi(argv[2]);
+    if (loadCorpus(argv[1]) <= 0) return 2;
+
+    for (i = 0; i < s_lineCount; i++) {
+        memset(&a, 0, sizeof(a));
+        memset(&b, 0, sizeof(b));
+        ra = parseScanf(s_lines[i].text, &a);
+        rb = LinkParseSensorText(s_lines[i].text, s_lines[i].len, &b);
+        if (ra == 0 && rb == 0) {
+            both++;
+            if (!sameFrame(&a, &b)) {
+                printf("MISMATCH   %s\n", s_lines[i].text);
+                bugs++;
+            }
+        } else if (ra == 0) {
+            scanfOnly++;
+            printf("scanf-only %s\n", s_lines[i].text);
+        } else if (rb == 0) {
+            printf("tok-only   %s\n", s_lines[i].text);
+            bugs++;
+        } else {
+            neither++;
+        }
+    }
+
+    nsScanf = timeParser(1, iters, &okScanf);
+    nsTok = timeParser(0, iters, &okTok);
+
+    printf("lines=%d both=%d neither=%d scanf-only=%d bugs=%d\n",
+           s_lineCount, both, neither, scanfOnly, bugs);
+    printf("sscanf     %8.1f ns/line  accepted=%d\n", nsScanf, okScanf);
+    printf("tokenizer  %8.1f ns/line  accepted=%d  speedup=%.1fx\n",
+           nsTok, okTok, nsScanf / nsTok);
+    return bugs ? 1 : 0;
+}
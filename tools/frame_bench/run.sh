@@ -0,0 +1,19 @@
+#!/usr/bin/env bash
+# Build and run the sensor frame parser benchmark on the host.
+#
+#   tools/frame_bench/run.sh [iterations]
+set -euo pipefail
+
+BENCH_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(cd "$BENCH_DIR/../.." && pwd)"
+OUT_DIR="$BENCH_DIR/out"
+CC="${CC:-cc}"
+
+mkdir -p "$OUT_DIR"
+"$CC" -std=gnu99 -O2 -Wall \
+  -I"$ROOT_DIR" \
+  "$BENCH_DIR/frame_bench.c" \
+  "$ROOT_DIR/utils/link_codec.c" \
+  -o "$OUT_DIR/frame_bench"
+
+"$OUT_DIR/frame_bench" "$BENCH_DIR/corpus.txt" "$@"
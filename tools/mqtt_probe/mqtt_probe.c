@@ -0,0 +1,203 @@
+// Host check of utils/mqtt_client.c against a real MQTT 3.1.1 broker, and
+// of how long a mission pushed on the shadow delta topic takes to reach the
+// device.
+//
+// Two clients share the broker. "lambda" publishes a delta document the
+// way AWS IoT does when the mission Lambda writes the shadow, stamped with
+// its send time. "device" subscribes like the firmware and picks the
+// document apart the same way; the time from publish to the device holding
+// mission_level is the push latency. Each round the device also publishes
+// a QoS 1 report and times the PUBACK. A round with no delivery or no
+// acknowledgement within ROUND_TIMEOUT_US makes the run fail.
+//
+//   mqtt_probe [host] [port] [rounds]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "utils/mqtt_client.h"
+#include "sl_posix.h"
+
+// Same thing name and topics as main.c
+#define SHADOW_TOPIC        "$aws/things/akge_cc3200_board/shadow/update"
+#define SHADOW_DELTA_TOPIC  SHADOW_TOPIC "/delta"
+
+#define DEFAULT_ROUNDS      50
+#define MAX_ROUNDS          1000
+#define ROUND_TIMEOUT_US    2000000L
+#define KEEPALIVE_S         30
+
+typedef struct {
+    int rounds;
+    int delivered;
+    int wrongLevel;
+    int expectLevel;
+    int got;
+    long pushUs[MAX_ROUNDS];
+    long ackUs[MAX_ROUNDS];
+    int acks;
+} Probe;
+
+static long nowUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+static unsigned long nowMs(void)
+{
+    return (unsigned long)(nowUs() / 1000);
+}
+
+// What the firmware does with a delta: find mission_level and act on it
+static void onDeviceMessage(void *ctx, const char *topic, int topicLen,
+                            const char *payload, int payloadLen)
+{
+    Probe *probe = (Probe *)ctx;
+    const char *p;
+    long sentUs;
+    int level;
+
+    if (topicLen != (int)strlen(SHADOW_DELTA_TOPIC) ||
+        memcmp(topic, SHADOW_DELTA_TOPIC, topicLen) != 0) {
+        return;
+    }
+    p = strstr(payload, "\"mission_level\":");
+    if (!p || sscanf(p + 16, "%d", &level) != 1) return;
+
+    p = strstr(payload, "\"probe_us\":");
+    if (!p || sscanf(p + 11, "%ld", &sentUs) != 1) return;
+
+    if (level != probe->expectLevel) probe->wrongLevel++;
+    probe->pushUs[probe->delivered++] = nowUs() - sentUs;
+    probe->got = 1;
+}
+
+static int openClient(MqttClient *client, const char *host, int port, const char *id)
+{
+    long deadline = nowUs() + ROUND_TIMEOUT_US;
+    int sock = ProbeConnect(host, port);
+
+    if (sock < 0) {
+        printf("cannot connect to %s:%d\n", host, port);
+        return -1;
+    }
+    if (MqttConnect(client, sock, id, KEEPALIVE_S, nowMs()) < 0) return -1;
+    while (client->state == MQTT_CONNECTING && nowUs() < deadline) {
+        MqttPoll(client, nowMs());
+        usleep(200);
+    }
+    if (client->state != MQTT_UP) {
+        printf("%s: no CONNACK (err %d)\n", id, client->lastError);
+        return -1;
+    }
+    return 0;
+}
+
+static int cmpLong(const void *a, const void *b)
+{
+    long x = *(const long *)a;
+    long y = *(const long *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void printStats(const char *name, long *samples, int count)
+{
+    long sum = 0;
+    int i;
+
+    if (count == 0) {
+        printf("%-8s no samples\n", name);
+        return;
+    }
+    qsort(samples, count, sizeof(samples[0]), cmpLong);
+    for (i = 0; i < count; i++) sum += samples[i];
+    printf("%-8s n=%d min=%ldus avg=%ldus p95=%ldus max=%ldus\n", name, count,
+           samples[0], sum / count, samples[(count * 95 + 99) / 100 - 1], samples[count - 1]);
+}
+
+int main(int argc, char **argv)
+{
+    static Probe probe;
+    static MqttClient device;
+    static MqttClient lambda;
+    const char *host = (argc > 1) ? argv[1] : "127.0.0.1";
+    int port = (argc > 2) ? atoi(argv[2]) : 1883;
+    const char *topics[1] = { SHADOW_DELTA_TOPIC };
+    char doc[192];
+    int rounds = (argc > 3) ? atoi(argv[3]) : DEFAULT_ROUNDS;
+    int failed = 0;
+    int r;
+
+    if (rounds < 1) rounds = 1;
+    if (rounds > MAX_ROUNDS) rounds = MAX_ROUNDS;
+
+    MqttInit(&device, onDeviceMessage, &probe);
+    MqttInit(&lambda, 0, 0);
+    if (openClient(&device, host, port, "aegis-probe-device") < 0) return 1;
+    if (openClient(&lambda, host, port, "aegis-probe-lambda") < 0) return 1;
+
+    MqttSubscribe(&device, topics, 1, 1, nowMs());
+    while (!device.subscribed && device.state == MQTT_UP && device.waiting > 0) {
+        MqttPoll(&device, nowMs());
+        usleep(200);
+    }
+    if (!device.subscribed) {
+        printf("subscribe refused (err %d)\n", device.lastError);
+        return 1;
+    }
+
+    for (r = 0; r < rounds; r++) {
+        long startUs;
+        long ackStartUs;
+        int reportId;
+        int acked = 0;
+
+        probe.got = 0;
+        probe.expectLevel = 1 + r % 5;
+        snprintf(doc, sizeof(doc),
+                 "{\"version\":%d,\"state\":{\"mission_ready\":true,\"mission_level\":%d},"
+                 "\"probe_us\":%ld}",
+                 r + 1, probe.expectLevel, nowUs());
+        if (MqttPublish(&lambda, SHADOW_DELTA_TOPIC, doc, strlen(doc), 1, nowMs()) < 0) {
+            printf("round %d: lambda publish failed (err %d)\n", r, lambda.lastError);
+            failed = 1;
+            break;
+        }
+
+        snprintf(doc, sizeof(doc), "{\"state\":{\"reported\":{\"cmd\":\"ROUND_UPDATE\",\"round\":%d}}}", r);
+        ackStartUs = nowUs();
+        reportId = MqttPublish(&device, SHADOW_TOPIC, doc, strlen(doc), 1, nowMs());
+
+        startUs = nowUs();
+        while ((!probe.got || !acked) && nowUs() - startUs < ROUND_TIMEOUT_US) {
+            if (MqttPoll(&device, nowMs()) < 0 || MqttPoll(&lambda, nowMs()) < 0) break;
+            if (!acked && reportId > 0 && device.ackedId == reportId) {
+                probe.ackUs[probe.acks++] = nowUs() - ackStartUs;
+                acked = 1;
+            }
+            usleep(50);
+        }
+        if (!probe.got || !acked) {
+            printf("round %d: %s%s\n", r, probe.got ? "" : "no delta ", acked ? "" : "no PUBACK");
+            failed = 1;
+        }
+        probe.rounds++;
+    }
+
+    printf("rounds=%d delivered=%d wrong_level=%d\n", probe.rounds, probe.delivered, probe.wrongLevel);
+    printStats("push", probe.pushUs, probe.delivered);
+    printStats("puback", probe.ackUs, probe.acks);
+    printf("device pub=%lu rx=%lu acked=%lu resent=%lu pings=%lu oversized=%lu\n",
+           device.published, device.received, device.acked, device.resent,
+           device.pings, device.oversized);
+
+    MqttDisconnect(&device);
+    MqttDisconnect(&lambda);
+    return (failed || probe.wrongLevel) ? 1 : 0;
+}
@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+# Build the MQTT client for Linux and run it against a broker, e.g. a local
+#   mosquitto -p 1883
+# Reports delta push latency and QoS 1 round trips; see mqtt_probe.c.
+#
+#   tools/mqtt_probe/run.sh [host] [port] [rounds]
+set -euo pipefail
+
+PROBE_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(cd "$PROBE_DIR/../.." && pwd)"
+OUT_DIR="$PROBE_DIR/out"
+CC="${CC:-cc}"
+
+mkdir -p "$OUT_DIR"
+"$CC" -std=gnu99 -O2 -Wall \
+  -I"$ROOT_DIR/tools/oled_sim/sdk" -I"$PROBE_DIR" -I"$ROOT_DIR" \
+  "$PROBE_DIR/mqtt_probe.c" \
+  "$PROBE_DIR/sl_posix.c" \
+  "$ROOT_DIR/utils/mqtt_client.c" \
+  -o "$OUT_DIR/mqtt_probe"
+
+"$OUT_DIR/mqtt_probe" "$@"
@@ -0,0 +1,61 @@
+// The few SimpleLink socket calls utils/mqtt_client.c makes, on top of
+// POSIX sockets, so the client can be run on Linux against a local broker.
+// Plain TCP only: the TLS the CC3200 does in the socket layer has no
+// counterpart here, which is fine for protocol and latency checks.
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "simplelink.h"
+#include "sl_posix.h"
+
+int ProbeConnect(const char *host, int port)
+{
+    struct addrinfo hints;
+    struct addrinfo *res;
+    char portText[8];
+    int one = 1;
+    int fd;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    snprintf(portText, sizeof(portText), "%d", port);
+    if (getaddrinfo(host, portText, &hints, &res) != 0) return -1;
+
+    fd = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (fd >= 0 && connect(fd, res->ai_addr, res->ai_addrlen) != 0) {
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    if (fd >= 0) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+short sl_Send(short sd, const void *buf, short len, short flags)
+{
+    ssize_t ret = send(sd, buf, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+
+    if (ret < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? SL_EAGAIN : -1;
+    return (short)ret;
+}
+
+// Non-blocking, as the firmware sets SL_SO_NONBLOCKING on its MQTT socket
+short sl_Recv(short sd, void *buf, short len, short flags)
+{
+    ssize_t ret = recv(sd, buf, len, MSG_DONTWAIT);
+
+    if (ret < 0) return (errno == EAGAIN || errno == EWOULDBLOCK) ? SL_EAGAIN : -1;
+    return (short)ret;
+}
+
+short sl_Close(short sd)
+{
+    return (short)close(sd);
+}
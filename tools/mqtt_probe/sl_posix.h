@@ -0,0 +1,7 @@
+#ifndef SL_POSIX_H_
+#define SL_POSIX_H_
+
+// Blocking TCP connect; the descriptor works with sl_Send/sl_Recv/sl_Close.
+int ProbeConnect(const char *host, int port);
+
+#endif /* SL_POSIX_H_ */
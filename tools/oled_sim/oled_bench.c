@@ -0,0 +1,325 @@
+// Render-cost benchmark and golden-image check for the OLED screens.
+//
+// main.c is compiled in directly (its entry point renamed) so drawOLED()
+// and the real game globals are used unchanged. Each RoundState screen is
+// rendered twice: once on entry, which rebuilds the whole screen, and once
+// after the sweep moves a sector, which is the common per-frame case.
+// The diagnostics log view is then scrolled past one full wrap of GDDRAM,
+// and last come shapes and text clipped at the panel edges.
+//
+//   oled_bench <out dir> <golden file> [--update]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define main aegis_firmware_main
+#include "main.c"
+#undef main
+
+#include "ssd1351_emu.h"
+
+#define MAX_SCREENS     32
+#define SWEEP_FRAMES    2000
+#define LOG_LINES       40
+
+typedef struct {
+    char name[24];
+    unsigned long hash;
+} Golden;
+
+static Golden s_golden[MAX_SCREENS];
+static int s_goldenCount = 0;
+static Golden s_seen[MAX_SCREENS];
+static int s_seenCount = 0;
+static int s_mismatches = 0;
+
+static void loadGolden(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    char line[80];
+
+    if (!f) return;
+    while (fgets(line, sizeof(line), f) && (s_goldenCount < MAX_SCREENS)) {
+        Golden *g = &s_golden[s_goldenCount];
+        if ((line[0] == '#') || (line[0] == '\n')) continue;
+        if (sscanf(line, "%23s %lx", g->name, &g->hash) == 2) s_goldenCount++;
+    }
+    fclose(f);
+}
+
+static int saveGolden(const char *path)
+{
+    FILE *f = fopen(path, "w");
+    int i;
+
+    if (!f) return -1;
+    fprintf(f, "# screen hash (FNV-1a of the emulated GDDRAM), see oled_bench.c\n");
+    for (i = 0; i < s_seenCount; i++) {
+        fprintf(f, "%s %08lx\n", s_seen[i].name, s_seen[i].hash);
+    }
+    fclose(f);
+    return 0;
+}
+
+static const Golden *findGolden(const char *name)
+{
+    int i;
+
+    for (i = 0; i < s_goldenCount; i++) {
+        if (strcmp(s_golden[i].name, name) == 0) return &s_golden[i];
+    }
+    return 0;
+}
+
+// Hash what is on the emulated panel now, compare it with the golden and
+// save the snapshots. before holds the counters from ahead of the drawing.
+static void recordFrame(const char *outDir, const char *tag, const EmuStats *before)
+{
+    EmuStats after;
+    const Golden *g;
+    char name[24];
+    char path[256];
+    unsigned long hash;
+    int i, n = 0;
+
+    for (i = 0; tag[i] && (n < (int)sizeof(name) - 1); i++) {
+        if (tag[i] != ' ') name[n++] = tag[i];
+    }
+    name[n] = '\0';
+
+    emuStats(&after);
+    hash = emuHash();
+
+    g = findGolden(name);
+    if (g && (g->hash != hash)) s_mismatches++;
+    printf("%-12s bytes=%6lu cs=%4lu windows=%4lu dma=%6lu hash=%08lx%s\n",
+           name,
+           after.bytes - before->bytes,
+           after.csCycles - before->csCycles,
+           after.windows - before->windows,
+           after.dmaBytes - before->dmaBytes,
+           hash,
+           !g ? " (new)" : ((g->hash != hash) ? " MISMATCH" : ""));
+
+    if (s_seenCount < MAX_SCREENS) {
+        strcpy(s_seen[s_seenCount].name, name);
+        s_seen[s_seenCount].hash = hash;
+        s_seenCount++;
+    }
+    snprintf(path, sizeof(path), "%s/%s.ppm", outDir, name);
+    emuWritePPM(path);
+    snprintf(path, sizeof(path), "%s/%s.png", outDir, name);
+    emuWritePNG(path);
+}
+
+// Render one frame through the same path the main loop takes and report
+// what it put on the wire.
+static void benchFrame(const char *outDir, const char *tag)
+{
+    EmuStats before;
+
+    emuStats(&before);
+    g_lastDrawLoop = g_loopCount - DRAW_INTERVAL_LOOPS;
+    do {
+        drawOLED();
+    } while (g_drawPending);
+    flushOLED();
+    recordFrame(outDir, tag, &before);
+}
+
+// Flush what was drawn outside drawOLED(), which flushOLED() alone would
+// not know about.
+static void flushDrawn(void)
+{
+    g_oledFlushPending = 1;
+    flushOLED();
+}
+
+// Lines, circles and text hanging over every edge of the panel. Each build
+// mode must clip them to exactly the pixels drawPixel() would have left.
+static void benchEdges(const char *outDir)
+{
+    EmuStats before;
+
+    fillScreen(BLACK);
+    flushDrawn();
+    emuStats(&before);
+    drawLine(-20, 10, 40, 30, RED);
+    drawLine(-10, -30, 20, 50, YELLOW);
+    drawLine(100, -15, 140, 60, GREEN);
+    drawLine(10, 120, 60, 140, BLUE);
+    drawLine(-5, 64, 135, 64, CYAN);
+    drawLine(64, -5, 64, 135, MAGENTA);
+    drawLine(127, 0, 127, 127, WHITE);
+    drawLine(0, 127, 127, 127, WHITE);
+    drawCircle(0, 0, 20, WHITE);
+    drawCircle(127, 127, 30, YELLOW);
+    drawCircle(64, -10, 25, CYAN);
+    fillCircle(127, 40, 12, GREEN);
+    fillCircle(10, 127, 15, RED);
+    fillCircle(-4, 70, 9, BLUE);
+    flushDrawn();
+    recordFrame(outDir, "EDGE-shapes", &before);
+
+    fillScreen(BLACK);
+    flushDrawn();
+    emuStats(&before);
+    setTextSize(1);
+    setTextColor(WHITE, BLUE);
+    setCursor(-3, -4);
+    Outstr("CLIP TOP LEFT");
+    setCursor(90, 124);
+    Outstr("BOTTOM");
+    setTextColor(YELLOW, YELLOW);
+    setCursor(-8, 40);
+    Outstr("SEE THROUGH EDGE");
+    setTextSize(2);
+    setTextColor(GREEN, BLACK);
+    setCursor(100, 60);
+    Outstr("BIG");
+    setCursor(-7, 100);
+    Outstr("Wx");
+    setTextColor(RED, RED);
+    setCursor(110, -9);
+    Outstr("QZ");
+    setTextSize(1);
+    setTextColor(WHITE, BLACK);
+    flushDrawn();
+    recordFrame(outDir, "EDGE-text", &before);
+}
+
+// Push one line into the log view and let the loop flush it and move the
+// start line, which takes two passes.
+static void benchLogLine(int i)
+{
+    char text[24];
+
+    snprintf(text, sizeof(text), "LINE %02d OK%d", i, i * 7);
+    logViewPush(text);
+    flushOLED();
+    flushOLED();
+}
+
+// One return per band of the radar colours, plus sectors with no echo.
+static const int s_ranges[SECTOR_COUNT] = {
+    400, 90, 400, 30, 10, 400, 55, 400, 20, 400, 400, 75, 400, 38, 400, 400
+};
+
+// Fixed game state so every run draws the same pixels.
+static void setScene(RoundState state)
+{
+    int i;
+
+    g_state = state;
+    g_loopCount += 100;
+    g_stateStartLoop = g_loopCount;
+    g_cachedThreat = 5;
+    g_cachedThreatSector = 3;
+    g_cachedBlocked = 1;
+    g_shieldSector = 4;
+    g_sensor.sector = 3;
+    g_sensor.distCm = 30;
+    g_defenderScore = 12;
+    g_attackerScore = 7;
+    for (i = 0; i < SECTOR_COUNT; i++) {
+        g_rangeCm[i] = s_ranges[i];
+    }
+    g_rangeStamp++;
+}
+
+static void moveSweep(void)
+{
+    g_sensor.sector = (g_sensor.sector + 1) % SECTOR_COUNT;
+    g_cachedThreatSector = g_sensor.sector;
+    g_loopCount += 5;
+}
+
+int main(int argc, char **argv)
+{
+    const char *outDir;
+    const char *goldenPath;
+    char tag[32];
+    EmuStats before, after;
+    clock_t start;
+    int update;
+    int s, i;
+
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s <out dir> <golden file> [--update]\n", argv[0]);
+        return 2;
+    }
+    outDir = argv[1];
+    goldenPath = argv[2];
+    update = (argc > 3) && (strcmp(argv[3], "--update") == 0);
+    if (!update) loadGolden(goldenPath);
+
+    SPIInit();
+    Adafruit_Init();
+    setFlushCallback(OledFlushDoneHandler);
+    fillScreen(BLACK);
+    setTextSize(1);
+    setTextColor(WHITE, BLACK);
+
+    for (s = RS_BOOT; s <= RS_END; s++) {
+        setScene((RoundState)s);
+        snprintf(tag, sizeof(tag), "%s-full", stateLabel(g_state));
+        benchFrame(outDir, tag);
+        moveSweep();
+        snprintf(tag, sizeof(tag), "%s-sector", stateLabel(g_state));
+        benchFrame(outDir, tag);
+    }
+
+    // Steady-state cost of the ACTIVE screen with the sweep turning.
+    setScene(RS_ACTIVE);
+    g_lastDrawLoop = g_loopCount - DRAW_INTERVAL_LOOPS;
+    do {
+        drawOLED();
+    } while (g_drawPending);
+    flushOLED();
+    emuStats(&before);
+    start = clock();
+    for (i = 0; i < SWEEP_FRAMES; i++) {
+        moveSweep();
+        g_lastDrawLoop = g_loopCount - DRAW_INTERVAL_LOOPS;
+        do {
+            drawOLED();
+        } while (g_drawPending);
+        flushOLED();
+    }
+    emuStats(&after);
+    printf("ACT-sweep    bytes/frame=%lu cs/frame=%lu host-cpu=%.1fus/frame\n",
+           (after.bytes - before.bytes) / SWEEP_FRAMES,
+           (after.csCycles - before.csCycles) / SWEEP_FRAMES,
+           (double)(clock() - start) * 1e6 / CLOCKS_PER_SEC / SWEEP_FRAMES);
+
+    // Log view: enter, then scroll a full wrap and a half.
+    g_logView = 1;
+    benchFrame(outDir, "LOG-enter");
+    flushOLED();
+    emuStats(&before);
+    for (i = 0; i < LOG_LINES; i++) benchLogLine(i);
+    emuStats(&after);
+    printf("LOG-scroll   bytes/line=%lu cs/line=%lu\n",
+           (after.bytes - before.bytes) / LOG_LINES,
+           (after.csCycles - before.csCycles) / LOG_LINES);
+    benchLogLine(LOG_LINES);
+    benchFrame(outDir, "LOG-scrolled");
+    g_logView = 0;
+    benchFrame(outDir, "LOG-exit");
+    flushOLED();
+    benchFrame(outDir, "LOG-exit-row0");
+
+    benchEdges(outDir);
+
+    if (update) {
+        if (saveGolden(goldenPath) != 0) return 1;
+        printf("golden hashes written to %s\n", goldenPath);
+        return 0;
+    }
+    if (s_mismatches) {
+        printf("%d screen(s) differ from %s\n", s_mismatches, goldenPath);
+        return 1;
+    }
+    return 0;
+}
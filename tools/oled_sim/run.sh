@@ -0,0 +1,43 @@
+#!/usr/bin/env bash
+# Build the firmware's display path for Linux against the SSD1351 emulator,
+# render every RoundState screen and compare them with golden.txt.
+#
+#   tools/oled_sim/run.sh              framebuffer + DMA build (default)
+#   tools/oled_sim/run.sh --direct     SSD1351_FRAMEBUFFER=0
+#   tools/oled_sim/run.sh --no-dma     SSD1351_DMA=0
+#   tools/oled_sim/run.sh --update     rewrite golden.txt from this run
+#
+# Snapshots (.ppm and .png) and the binary land in tools/oled_sim/out/.
+set -euo pipefail
+
+SIM_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(cd "$SIM_DIR/../.." && pwd)"
+OUT_DIR="$SIM_DIR/out"
+CC="${CC:-cc}"
+DEFS=()
+BENCH_ARGS=()
+
+for arg in "$@"; do
+  case "$arg" in
+    --direct) DEFS+=("-DSSD1351_FRAMEBUFFER=0") ;;
+    --no-dma) DEFS+=("-DSSD1351_DMA=0") ;;
+    --update) BENCH_ARGS+=("--update") ;;
+    *)
+      echo "unknown option: $arg"
+      exit 2
+      ;;
+  esac
+done
+
+mkdir -p "$OUT_DIR"
+"$CC" -std=gnu99 -O1 -Wall ${DEFS[@]+"${DEFS[@]}"} \
+  -I"$SIM_DIR/sdk" -I"$SIM_DIR" -I"$ROOT_DIR" \
+  "$SIM_DIR/oled_bench.c" \
+  "$SIM_DIR/ssd1351_emu.c" \
+  "$SIM_DIR/sdk_stubs.c" \
+  "$ROOT_DIR/Adafruit_OLED.c" \
+  "$ROOT_DIR/Adafruit_GFX.c" \
+  "$ROOT_DIR"/utils/*.c \
+  -o "$OUT_DIR/oled_bench"
+
+"$OUT_DIR/oled_bench" "$OUT_DIR" "$SIM_DIR/golden.txt" ${BENCH_ARGS[@]+"${BENCH_ARGS[@]}"}
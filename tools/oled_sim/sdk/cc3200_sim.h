@@ -0,0 +1,248 @@
+// Host stand-ins for the CC3200 driverlib, board support and peripheral
+// headers, just enough for the firmware sources to compile on Linux. The
+// register and constant values are only placeholders unless
+// ssd1351_emu.c relies on them.
+#ifndef CC3200_SIM_H
+#define CC3200_SIM_H
+
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+typedef unsigned char tBoolean;
+
+#define HWREG(x) (*((volatile unsigned long *)sim_reg((unsigned long)(x))))
+volatile unsigned long *sim_reg(unsigned long addr);
+
+#define GSPI_BASE 0x44021000
+#define GPIOA0_BASE 0x40004000
+#define GPIOA1_BASE 0x40005000
+#define GPIOA2_BASE 0x40006000
+#define GPIOA3_BASE 0x40007000
+#define UARTA0_BASE 0x4000C000
+#define UARTA1_BASE 0x4000D000
+#define TIMERA0_BASE 0x40030000
+#define TIMERA1_BASE 0x40031000
+#define TIMERA2_BASE 0x40032000
+#define TIMERA3_BASE 0x40033000
+#define NVIC_ST_CURRENT 0xE000E018
+#define FAULT_SYSTICK 15
+#define INT_GPIOA1 17
+#define INT_UARTA1 22
+#define INT_GSPI 65
+#define INT_UDMA 62
+#define INT_UDMAERR 63
+#define GPIO_PIN_0 0x01
+#define GPIO_PIN_1 0x02
+#define GPIO_PIN_4 0x10
+#define GPIO_PIN_6 0x40
+#define GPIO_FALLING_EDGE 0
+#define GPIO_DIR_MODE_IN 0
+#define GPIO_DIR_MODE_OUT 1
+#define SPI_MODE_MASTER 0
+#define SPI_SUB_MODE_0 0
+#define SPI_SW_CTRL_CS 0x01000000
+#define SPI_4PIN_MODE 0x00000010
+#define SPI_TURBO_OFF 0
+#define SPI_CS_ACTIVELOW 0x40
+#define SPI_WL_8 0x380
+#define SPI_WL_16 0x780
+#define SPI_TX_FIFO 0x08000000
+#define SPI_RX_FIFO 0x10000000
+#define SPI_CS_ENABLE 1
+#define SPI_CS_DISABLE 2
+#define SPI_INT_DMATX 0x20000000
+#define SPI_INT_DMARX 0x10000000
+#define SPI_INT_EOW 0x20000
+#define SPI_RX_DMA 0x00008000
+#define SPI_TX_DMA 0x00004000
+#define PRCM_GSPI 1
+#define PRCM_UARTA1 2
+#define PRCM_UARTA0 3
+#define PRCM_TIMERA2 4
+#define PRCM_UDMA 5
+#define PRCM_RUN_MODE_CLK 1
+#define UART_CONFIG_WLEN_8 0x60
+#define UART_CONFIG_STOP_ONE 0
+#define UART_CONFIG_PAR_NONE 0
+#define UART_INT_RX 0x10
+#define UART_INT_RT 0x40
+#define UART_INT_TX 0x20
+#define UART_INT_OE 0x400
+#define UART_FIFO_TX1_8 0
+#define UART_FIFO_TX4_8 2
+#define UART_FIFO_RX4_8 0x10
+#define UART_FIFO_RX2_8 0x08
+#define UART_TXINT_MODE_EOT 0x10
+#define UART_RXERROR_OVERRUN 0x08
+#define TIMER_CFG_PERIODIC_UP 0x12
+#define TIMER_A 0xff
+#define SUCCESS 0
+#define FAILURE -1
+#define ASSERT_ON_ERROR(e) do { if ((e) < 0) return (e); } while (0)
+
+// spi
+void SPIReset(unsigned long b);
+void SPIConfigSetExpClk(unsigned long b, unsigned long clk, unsigned long rate, unsigned long mode, unsigned long sub, unsigned long cfg);
+void SPIEnable(unsigned long b);
+void SPIDisable(unsigned long b);
+void SPICSEnable(unsigned long b);
+void SPICSDisable(unsigned long b);
+void SPIDataPut(unsigned long b, unsigned long d);
+void SPIDataGet(unsigned long b, unsigned long *d);
+long SPIDataPutNonBlocking(unsigned long b, unsigned long d);
+long SPIDataGetNonBlocking(unsigned long b, unsigned long *d);
+void SPIFIFOEnable(unsigned long b, unsigned long f);
+void SPIFIFOLevelSet(unsigned long b, unsigned long tx, unsigned long rx);
+long SPITransfer(unsigned long b, unsigned char *out, unsigned char *in, unsigned long n, unsigned long flags);
+void SPIWordCountSet(unsigned long b, unsigned long n);
+void SPIIntRegister(unsigned long b, void (*fn)(void));
+void SPIIntEnable(unsigned long b, unsigned long f);
+void SPIIntDisable(unsigned long b, unsigned long f);
+unsigned long SPIIntStatus(unsigned long b, tBoolean m);
+void SPIIntClear(unsigned long b, unsigned long f);
+void SPIDmaEnable(unsigned long b, unsigned long f);
+void SPIDmaDisable(unsigned long b, unsigned long f);
+
+// gpio
+void GPIOPinWrite(unsigned long b, unsigned char pins, unsigned char val);
+long GPIOPinRead(unsigned long b, unsigned char pins);
+unsigned long GPIOIntStatus(unsigned long b, tBoolean m);
+void GPIOIntClear(unsigned long b, unsigned long f);
+void GPIOIntRegister(unsigned long b, void (*fn)(void));
+void GPIOIntTypeSet(unsigned long b, unsigned char p, unsigned long t);
+void GPIOIntEnable(unsigned long b, unsigned long f);
+void GPIODirModeSet(unsigned long b, unsigned char p, unsigned long m);
+
+// prcm / int / systick / utils
+unsigned long PRCMPeripheralClockGet(unsigned long p);
+void PRCMPeripheralClkEnable(unsigned long p, unsigned long m);
+void PRCMPeripheralReset(unsigned long p);
+void PRCMCC3200MCUInit(void);
+void IntVTableBaseSet(unsigned long a);
+void IntMasterEnable(void);
+void IntMasterDisable(void);
+void IntEnable(unsigned long i);
+void IntDisable(unsigned long i);
+void IntPrioritySet(unsigned long i, unsigned char p);
+void SysTickPeriodSet(unsigned long p);
+void SysTickIntRegister(void (*fn)(void));
+void SysTickIntEnable(void);
+void SysTickEnable(void);
+unsigned long SysTickValueGet(void);
+void UtilsDelay(unsigned long n);
+
+// timer
+void TimerConfigure(unsigned long b, unsigned long c);
+void TimerLoadSet(unsigned long b, unsigned long t, unsigned long v);
+void TimerEnable(unsigned long b, unsigned long t);
+unsigned long TimerValueGet(unsigned long b, unsigned long t);
+void TimerPrescaleSet(unsigned long b, unsigned long t, unsigned long v);
+
+// uart
+void UARTConfigSetExpClk(unsigned long b, unsigned long clk, unsigned long baud, unsigned long cfg);
+void UARTEnable(unsigned long b);
+void UARTDisable(unsigned long b);
+tBoolean UARTCharsAvail(unsigned long b);
+long UARTCharGet(unsigned long b);
+long UARTCharGetNonBlocking(unsigned long b);
+void UARTCharPut(unsigned long b, unsigned char c);
+tBoolean UARTCharPutNonBlocking(unsigned long b, unsigned char c);
+tBoolean UARTSpaceAvail(unsigned long b);
+tBoolean UARTBusy(unsigned long b);
+void UARTIntRegister(unsigned long b, void (*fn)(void));
+void UARTIntEnable(unsigned long b, unsigned long f);
+void UARTIntDisable(unsigned long b, unsigned long f);
+unsigned long UARTIntStatus(unsigned long b, tBoolean m);
+void UARTIntClear(unsigned long b, unsigned long f);
+void UARTFIFOLevelSet(unsigned long b, unsigned long tx, unsigned long rx);
+void UARTFIFOEnable(unsigned long b);
+unsigned long UARTRxErrorGet(unsigned long b);
+void UARTRxErrorClear(unsigned long b);
+void UARTTxIntModeSet(unsigned long b, unsigned long m);
+
+// pin
+#define PIN_01 0
+#define PIN_02 1
+#define PIN_03 2
+#define PIN_05 4
+#define PIN_07 6
+#define PIN_08 7
+#define PIN_18 17
+#define PIN_53 52
+#define PIN_55 54
+#define PIN_57 56
+#define PIN_58 57
+#define PIN_59 58
+#define PIN_64 63
+#define PIN_MODE_0 0
+#define PIN_MODE_1 1
+#define PIN_MODE_3 3
+#define PIN_MODE_6 6
+#define PIN_MODE_7 7
+void PinTypeI2C(unsigned long p, unsigned long m);
+void PinTypeGPIO(unsigned long p, unsigned long m, tBoolean od);
+void PinTypeSPI(unsigned long p, unsigned long m);
+void PinTypeUART(unsigned long p, unsigned long m);
+
+// udma
+#define UDMA_CH31_GSPI_TX 0x1f
+#define UDMA_CH30_GSPI_RX 0x1e
+#define UDMA_PRI_SELECT 0
+#define UDMA_ALT_SELECT 0x20
+#define UDMA_SIZE_8 0
+#define UDMA_SRC_INC_8 0
+#define UDMA_SRC_INC_NONE 0xc000000
+#define UDMA_DST_INC_NONE 0xc0000000
+#define UDMA_ARB_1 0
+#define UDMA_ARB_4 0x8000
+#define UDMA_MODE_BASIC 1
+#define UDMA_MODE_PINGPONG 3
+#define UDMA_MODE_STOP 0
+#define UDMA_ATTR_ALTSELECT 1
+#define UDMA_ATTR_USEBURST 2
+#define UDMA_ATTR_REQMASK 4
+#define UDMA_ATTR_HIGH_PRIORITY 8
+#define UDMA_ATTR_ALL 0xf
+#define MCSPI_O_TX0 0x138
+#define MCSPI_O_RX0 0x13C
+typedef struct {
+    volatile void *pvSrcEndAddr;
+    volatile void *pvDstEndAddr;
+    volatile unsigned long ulControl;
+    volatile unsigned long ulSpare;
+} tDMAControlTable;
+void uDMAEnable(void);
+void uDMAControlBaseSet(void *b);
+void *uDMAControlBaseGet(void);
+void uDMAChannelAssign(unsigned long m);
+void uDMAChannelAttributeDisable(unsigned long c, unsigned long a);
+void uDMAChannelControlSet(unsigned long c, unsigned long ctl);
+void uDMAChannelTransferSet(unsigned long c, unsigned long m, void *src, void *dst, unsigned long n);
+void uDMAChannelEnable(unsigned long c);
+void uDMAChannelDisable(unsigned long c);
+tBoolean uDMAChannelIsEnabled(unsigned long c);
+unsigned long uDMAChannelModeGet(unsigned long c);
+void uDMAIntRegister(unsigned long i, void (*fn)(void));
+void uDMAErrorStatusClear(void);
+unsigned long uDMAErrorStatusGet(void);
+unsigned long uDMAIntStatus(void);
+void uDMAIntClear(unsigned long m);
+
+// uart_if / gpio_if / common / pinmux / i2c_if
+#define UART_PRINT Report
+int Report(const char *fmt, ...);
+void InitTerm(void);
+void ClearTerm(void);
+#define LED1 1
+#define LED3 4
+#define MCU_ALL_LED_IND 0
+#define MCU_RED_LED_GPIO 9
+#define MCU_GREEN_LED_GPIO 11
+#define MCU_IP_ALLOC_IND 9
+void GPIO_IF_LedConfigure(unsigned char l);
+void GPIO_IF_LedOff(char l);
+void GPIO_IF_LedOn(char l);
+void PinMuxConfig(void);
+int I2C_IF_Open(unsigned long m);
+
+#endif
@@ -0,0 +1 @@
+#include "cc3200_sim.h"
@@ -0,0 +1,98 @@
+// The ROM-or-library MAP_ wrappers collapse to the plain driverlib calls.
+#ifndef ROM_MAP_SIM_H
+#define ROM_MAP_SIM_H
+
+#include "cc3200_sim.h"
+
+#define MAP_GPIODirModeSet GPIODirModeSet
+#define MAP_GPIOIntClear GPIOIntClear
+#define MAP_GPIOIntEnable GPIOIntEnable
+#define MAP_GPIOIntRegister GPIOIntRegister
+#define MAP_GPIOIntStatus GPIOIntStatus
+#define MAP_GPIOIntTypeSet GPIOIntTypeSet
+#define MAP_GPIOPinRead GPIOPinRead
+#define MAP_GPIOPinWrite GPIOPinWrite
+#define MAP_IntDisable IntDisable
+#define MAP_IntEnable IntEnable
+#define MAP_IntMasterDisable IntMasterDisable
+#define MAP_IntMasterEnable IntMasterEnable
+#define MAP_IntPrioritySet IntPrioritySet
+#define MAP_IntVTableBaseSet IntVTableBaseSet
+#define MAP_PRCMCC3200MCUInit PRCMCC3200MCUInit
+#define MAP_PRCMPeripheralClkEnable PRCMPeripheralClkEnable
+#define MAP_PRCMPeripheralClockGet PRCMPeripheralClockGet
+#define MAP_PRCMPeripheralReset PRCMPeripheralReset
+#define MAP_PinTypeGPIO PinTypeGPIO
+#define MAP_PinTypeI2C PinTypeI2C
+#define MAP_PinTypeSPI PinTypeSPI
+#define MAP_PinTypeUART PinTypeUART
+#define MAP_SPICSDisable SPICSDisable
+#define MAP_SPICSEnable SPICSEnable
+#define MAP_SPIConfigSetExpClk SPIConfigSetExpClk
+#define MAP_SPIDataGet SPIDataGet
+#define MAP_SPIDataGetNonBlocking SPIDataGetNonBlocking
+#define MAP_SPIDataPut SPIDataPut
+#define MAP_SPIDataPutNonBlocking SPIDataPutNonBlocking
+#define MAP_SPIDisable SPIDisable
+#define MAP_SPIDmaDisable SPIDmaDisable
+#define MAP_SPIDmaEnable SPIDmaEnable
+#define MAP_SPIEnable SPIEnable
+#define MAP_SPIFIFOEnable SPIFIFOEnable
+#define MAP_SPIFIFOLevelSet SPIFIFOLevelSet
+#define MAP_SPIIntClear SPIIntClear
+#define MAP_SPIIntDisable SPIIntDisable
+#define MAP_SPIIntEnable SPIIntEnable
+#define MAP_SPIIntRegister SPIIntRegister
+#define MAP_SPIIntStatus SPIIntStatus
+#define MAP_SPIReset SPIReset
+#define MAP_SPITransfer SPITransfer
+#define MAP_SPIWordCountSet SPIWordCountSet
+#define MAP_SysTickEnable SysTickEnable
+#define MAP_SysTickIntEnable SysTickIntEnable
+#define MAP_SysTickIntRegister SysTickIntRegister
+#define MAP_SysTickPeriodSet SysTickPeriodSet
+#define MAP_SysTickValueGet SysTickValueGet
+#define MAP_TimerConfigure TimerConfigure
+#define MAP_TimerEnable TimerEnable
+#define MAP_TimerLoadSet TimerLoadSet
+#define MAP_TimerPrescaleSet TimerPrescaleSet
+#define MAP_TimerValueGet TimerValueGet
+#define MAP_UARTBusy UARTBusy
+#define MAP_UARTCharGet UARTCharGet
+#define MAP_UARTCharGetNonBlocking UARTCharGetNonBlocking
+#define MAP_UARTCharPut UARTCharPut
+#define MAP_UARTCharPutNonBlocking UARTCharPutNonBlocking
+#define MAP_UARTCharsAvail UARTCharsAvail
+#define MAP_UARTConfigSetExpClk UARTConfigSetExpClk
+#define MAP_UARTDisable UARTDisable
+#define MAP_UARTEnable UARTEnable
+#define MAP_UARTFIFOEnable UARTFIFOEnable
+#define MAP_UARTFIFOLevelSet UARTFIFOLevelSet
+#define MAP_UARTIntClear UARTIntClear
+#define MAP_UARTIntDisable UARTIntDisable
+#define MAP_UARTIntEnable UARTIntEnable
+#define MAP_UARTIntRegister UARTIntRegister
+#define MAP_UARTIntStatus UARTIntStatus
+#define MAP_UARTRxErrorClear UARTRxErrorClear
+#define MAP_UARTRxErrorGet UARTRxErrorGet
+#define MAP_UARTSpaceAvail UARTSpaceAvail
+#define MAP_UARTTxIntModeSet UARTTxIntModeSet
+#define MAP_UtilsDelay UtilsDelay
+#define MAP_uDMAChannelAssign uDMAChannelAssign
+#define MAP_uDMAChannelAttributeDisable uDMAChannelAttributeDisable
+#define MAP_uDMAChannelControlSet uDMAChannelControlSet
+#define MAP_uDMAChannelDisable uDMAChannelDisable
+#define MAP_uDMAChannelEnable uDMAChannelEnable
+#define MAP_uDMAChannelIsEnabled uDMAChannelIsEnabled
+#define MAP_uDMAChannelModeGet uDMAChannelModeGet
+#define MAP_uDMAChannelTransferSet uDMAChannelTransferSet
+#define MAP_uDMAControlBaseGet uDMAControlBaseGet
+#define MAP_uDMAControlBaseSet uDMAControlBaseSet
+#define MAP_uDMAEnable uDMAEnable
+#define MAP_uDMAErrorStatusClear uDMAErrorStatusClear
+#define MAP_uDMAErrorStatusGet uDMAErrorStatusGet
+#define MAP_uDMAIntClear uDMAIntClear
+#define MAP_uDMAIntRegister uDMAIntRegister
+#define MAP_uDMAIntStatus uDMAIntStatus
+
+#endif
@@ -0,0 +1,129 @@
+// Types, constants and prototypes from the SimpleLink host driver that the
+// firmware references. Everything here is stubbed out in sdk_stubs.c; the
+// emulator never talks to a network processor.
+#ifndef SIMPLELINK_SIM_H
+#define SIMPLELINK_SIM_H
+
+#include "cc3200_sim.h"
+
+typedef unsigned char _u8;
+typedef signed char _i8;
+typedef unsigned short _u16;
+typedef short _i16;
+typedef unsigned int _u32;
+typedef int _i32;
+
+#define SL_EAGAIN (-11)
+#define SL_EALREADY (-114)
+#define SL_ESECSNOVERIFY (-453)
+#define SL_ECLOSE (-450)
+#define SL_AF_INET 2
+#define SL_SOCK_STREAM 1
+#define SL_SEC_SOCKET 100
+#define SL_SOL_SOCKET 1
+#define SL_SO_RCVTIMEO 20
+#define SL_SO_NONBLOCKING 24
+#define SL_SO_SECMETHOD 25
+#define SL_SO_SECURE_MASK 26
+#define SL_SO_SECURE_FILES_CA_FILE_NAME 27
+#define SL_SO_SECURE_FILES_CERTIFICATE_FILE_NAME 28
+#define SL_SO_SECURE_FILES_PRIVATE_KEY_FILE_NAME 29
+#define SL_SO_SEC_METHOD_TLSV1_2 6
+#define SL_SEC_MASK_TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA256 (1<<13)
+#define SL_DEVICE_GENERAL_CONFIGURATION 1
+#define SL_DEVICE_GENERAL_CONFIGURATION_DATE_TIME 11
+#define SL_DEVICE_GENERAL_VERSION 12
+#define SSID_LEN_MAX 32
+#define BSSID_LEN_MAX 6
+#define SL_BSSID_LENGTH 6
+#define ROLE_STA 0
+#define ROLE_AP 2
+#define SL_POLICY_CONNECTION 0x10
+#define SL_POLICY_SCAN 0x20
+#define SL_POLICY_PM 0x30
+#define SL_NORMAL_POLICY 0
+#define SL_CONNECTION_POLICY(a,b,c,d,e) 0
+#define SL_SCAN_POLICY(a) 0
+#define SL_IPV4_STA_P2P_CL_DHCP_ENABLE 4
+#define SL_WLAN_CFG_GENERAL_PARAM_ID 0
+#define WLAN_GENERAL_PARAM_OPT_STA_TX_POWER 0
+#define SL_REMOVE_RX_FILTER 0
+#define SL_STOP_TIMEOUT 200
+#define SL_WLAN_CONNECT_EVENT 1
+#define SL_WLAN_DISCONNECT_EVENT 2
+#define SL_USER_INITIATED_DISCONNECTION 200
+#define SL_NETAPP_IPV4_IPACQUIRED_EVENT 1
+#define SL_SOCKET_TX_FAILED_EVENT 1
+#define SL_IPV4_BYTE(v,i) ((v >> (8*i)) & 0xFF)
+#define SL_DRIVER_VERSION "sim"
+#define FS_MODE_OPEN_READ 0
+#define FS_MODE_OPEN_WRITE 1
+#define FS_MODE_OPEN_CREATE(sz, flags) (2 | ((sz) << 8))
+#define _FS_FILE_OPEN_FLAG_COMMIT 1
+#define SL_FS_ERR_FILE_NOT_EXISTS (-11)
+#define SL_POOL_IS_EMPTY (-2000)
+#define SL_ERROR_BSD_EAGAIN SL_EAGAIN
+#define STATUS_BIT_CONNECTION 0
+#define STATUS_BIT_IP_AQUIRED 1
+#define SET_STATUS_BIT(s,b) ((s) |= (1<<(b)))
+#define CLR_STATUS_BIT(s,b) ((s) &= ~(1<<(b)))
+#define CLR_STATUS_BIT_ALL(s) ((s) = 0)
+#define IS_CONNECTED(s) ((s) & 1)
+#define IS_IP_ACQUIRED(s) ((s) & 2)
+#define SSID_NAME "sim"
+#define SECURITY_KEY "sim"
+#define SECURITY_TYPE 0
+
+typedef struct { unsigned long tv_sec; unsigned long tv_usec; } SlTimeval_t;
+typedef struct { unsigned long NonblockingEnabled; } SlSockNonblocking_t;
+typedef struct { unsigned short sin_family; unsigned short sin_port; struct { unsigned long s_addr; } sin_addr; char sin_zero[8]; } SlSockAddrIn_t;
+typedef struct { unsigned short sa_family; unsigned char sa_data[14]; } SlSockAddr_t;
+typedef struct { unsigned char ssid_name[32]; unsigned char ssid_len; unsigned char bssid[6]; unsigned char reason_code; } slWlanConnectAsyncResponse_t;
+typedef struct { unsigned long Event; union { slWlanConnectAsyncResponse_t STAandP2PModeWlanConnected; slWlanConnectAsyncResponse_t STAandP2PModeDisconnected; } EventData; } SlWlanEvent_t;
+typedef struct { unsigned long ip; unsigned long gateway; } SlIpV4AcquiredAsync_t;
+typedef struct { unsigned long Event; union { SlIpV4AcquiredAsync_t ipAcquiredV4; } EventData; } SlNetAppEvent_t;
+typedef struct { int x;
+} SlHttpServerEvent_t;
+typedef struct { int x;
+} SlHttpServerResponse_t;
+typedef struct { struct { int status; int sender; } deviceEvent; } SlDevEvData_t;
+typedef struct { unsigned long Event; SlDevEvData_t EventData; } SlDeviceEvent_t;
+typedef struct { int sd; int status; } SlSockTxFail_t;
+typedef struct { unsigned long Event; struct { SlSockTxFail_t SockTxFailData; } socketAsyncEvent; } SlSockEvent_t;
+typedef struct { unsigned char NwpVersion[4]; struct { unsigned char FwVersion[4]; unsigned char PhyVersion[4]; } ChipFwAndPhyVersion; } SlVersionFull;
+typedef struct { unsigned char FilterIdMask[8]; unsigned char Padding[4]; } _WlanRxFilterOperationCommandBuff_t;
+typedef struct { unsigned char Key[64]; unsigned char KeyLen; unsigned char Type; } SlSecParamsInt_t;
+typedef struct { char *Key; unsigned char KeyLen; unsigned char Type; } SlSecParams_t;
+typedef struct { unsigned long FileLen; unsigned long AllocatedLen; unsigned long Token[4]; } SlFsFileInfo_t;
+typedef unsigned long SlFdSet_t;
+
+short sl_Socket(short d, short t, short p);
+short sl_Close(short sd);
+short sl_Connect(short sd, const SlSockAddr_t *a, short len);
+short sl_Send(short sd, const void *buf, short len, short flags);
+short sl_Recv(short sd, void *buf, short len, short flags);
+short sl_SetSockOpt(short sd, short level, short opt, const void *val, unsigned short len);
+short sl_NetAppDnsGetHostByName(signed char *name, unsigned short len, unsigned long *ip, unsigned char fam);
+unsigned short sl_Htons(unsigned short v);
+unsigned long sl_Htonl(unsigned long v);
+short sl_Start(const void *a, const void *b, const void *c);
+short sl_Stop(unsigned short t);
+short sl_DevSet(unsigned char id, unsigned char opt, unsigned char len, unsigned char *val);
+short sl_DevGet(unsigned char id, unsigned char *opt, unsigned char *len, unsigned char *val);
+short sl_WlanPolicySet(unsigned char t, unsigned char p, unsigned char *v, unsigned char l);
+short sl_WlanProfileDel(short i);
+short sl_WlanDisconnect(void);
+short sl_WlanSetMode(unsigned char m);
+short sl_NetCfgSet(unsigned char id, unsigned char opt, unsigned char len, unsigned char *v);
+short sl_WlanSet(unsigned short id, unsigned short opt, unsigned short len, unsigned char *v);
+short sl_NetAppMDNSUnRegisterService(const signed char *n, unsigned char l);
+short sl_WlanRxFilterSet(unsigned char op, const unsigned char *buf, unsigned short len);
+short sl_WlanConnect(const signed char *ssid, short l, unsigned char *mac, const SlSecParams_t *p, const void *e);
+long sl_FsOpen(const unsigned char *name, unsigned long mode, unsigned long *token, long *fh);
+short sl_FsClose(long fh, unsigned char *cert, unsigned char *sig, unsigned long len);
+long sl_FsRead(long fh, unsigned long off, unsigned char *buf, unsigned long len);
+long sl_FsWrite(long fh, unsigned long off, unsigned char *buf, unsigned long len);
+short sl_FsDel(const unsigned char *name, unsigned long token);
+void _SlNonOsMainLoopTask(void);
+
+#endif
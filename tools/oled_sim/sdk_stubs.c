@@ -0,0 +1,522 @@
+// No-op stand-ins for the driverlib, board-support and SimpleLink calls the
+// firmware makes outside the display path. Calls that return a status
+// report success with zero data, so the network code just sees no traffic.
+#include "cc3200_sim.h"
+#include "simplelink.h"
+
+//*****************************************************************************
+// spi
+//*****************************************************************************
+void SPIReset(unsigned long b)
+{
+}
+
+void SPIConfigSetExpClk(unsigned long b, unsigned long clk, unsigned long rate, unsigned long mode, unsigned long sub, unsigned long cfg)
+{
+}
+
+void SPIEnable(unsigned long b)
+{
+}
+
+void SPIDisable(unsigned long b)
+{
+}
+
+void SPICSDisable(unsigned long b)
+{
+}
+
+long SPIDataPutNonBlocking(unsigned long b, unsigned long d)
+{
+    return 0;
+}
+
+long SPIDataGetNonBlocking(unsigned long b, unsigned long *d)
+{
+    return 0;
+}
+
+void SPIFIFOEnable(unsigned long b, unsigned long f)
+{
+}
+
+void SPIFIFOLevelSet(unsigned long b, unsigned long tx, unsigned long rx)
+{
+}
+
+void SPIWordCountSet(unsigned long b, unsigned long n)
+{
+}
+
+void SPIIntEnable(unsigned long b, unsigned long f)
+{
+}
+
+void SPIIntDisable(unsigned long b, unsigned long f)
+{
+}
+
+unsigned long SPIIntStatus(unsigned long b, tBoolean m)
+{
+    return 0;
+}
+
+void SPIIntClear(unsigned long b, unsigned long f)
+{
+}
+
+void SPIDmaDisable(unsigned long b, unsigned long f)
+{
+}
+
+//*****************************************************************************
+// gpio
+//*****************************************************************************
+long GPIOPinRead(unsigned long b, unsigned char pins)
+{
+    return 0;
+}
+
+unsigned long GPIOIntStatus(unsigned long b, tBoolean m)
+{
+    return 0;
+}
+
+void GPIOIntClear(unsigned long b, unsigned long f)
+{
+}
+
+void GPIOIntRegister(unsigned long b, void (*fn)(void))
+{
+}
+
+void GPIOIntTypeSet(unsigned long b, unsigned char p, unsigned long t)
+{
+}
+
+void GPIOIntEnable(unsigned long b, unsigned long f)
+{
+}
+
+void GPIODirModeSet(unsigned long b, unsigned char p, unsigned long m)
+{
+}
+
+//*****************************************************************************
+// prcm / int / systick / utils
+//*****************************************************************************
+unsigned long PRCMPeripheralClockGet(unsigned long p)
+{
+    return 0;
+}
+
+void PRCMPeripheralClkEnable(unsigned long p, unsigned long m)
+{
+}
+
+void PRCMPeripheralReset(unsigned long p)
+{
+}
+
+void PRCMCC3200MCUInit(void)
+{
+}
+
+void IntVTableBaseSet(unsigned long a)
+{
+}
+
+void IntMasterEnable(void)
+{
+}
+
+void IntMasterDisable(void)
+{
+}
+
+void IntEnable(unsigned long i)
+{
+}
+
+void IntDisable(unsigned long i)
+{
+}
+
+void IntPrioritySet(unsigned long i, unsigned char p)
+{
+}
+
+void SysTickPeriodSet(unsigned long p)
+{
+}
+
+void SysTickIntRegister(void (*fn)(void))
+{
+}
+
+void SysTickIntEnable(void)
+{
+}
+
+void SysTickEnable(void)
+{
+}
+
+unsigned long SysTickValueGet(void)
+{
+    return 0;
+}
+
+void UtilsDelay(unsigned long n)
+{
+}
+
+//*****************************************************************************
+// timer
+//*****************************************************************************
+void TimerConfigure(unsigned long b, unsigned long c)
+{
+}
+
+void TimerLoadSet(unsigned long b, unsigned long t, unsigned long v)
+{
+}
+
+void TimerEnable(unsigned long b, unsigned long t)
+{
+}
+
+unsigned long TimerValueGet(unsigned long b, unsigned long t)
+{
+    return 0;
+}
+
+void TimerPrescaleSet(unsigned long b, unsigned long t, unsigned long v)
+{
+}
+
+//*****************************************************************************
+// uart
+//*****************************************************************************
+void UARTConfigSetExpClk(unsigned long b, unsigned long clk, unsigned long baud, unsigned long cfg)
+{
+}
+
+void UARTEnable(unsigned long b)
+{
+}
+
+void UARTDisable(unsigned long b)
+{
+}
+
+tBoolean UARTCharsAvail(unsigned long b)
+{
+    return 0;
+}
+
+long UARTCharGet(unsigned long b)
+{
+    return 0;
+}
+
+long UARTCharGetNonBlocking(unsigned long b)
+{
+    return 0;
+}
+
+void UARTCharPut(unsigned long b, unsigned char c)
+{
+}
+
+tBoolean UARTCharPutNonBlocking(unsigned long b, unsigned char c)
+{
+    return 0;
+}
+
+tBoolean UARTSpaceAvail(unsigned long b)
+{
+    return 0;
+}
+
+tBoolean UARTBusy(unsigned long b)
+{
+    return 0;
+}
+
+void UARTIntRegister(unsigned long b, void (*fn)(void))
+{
+}
+
+void UARTIntEnable(unsigned long b, unsigned long f)
+{
+}
+
+void UARTIntDisable(unsigned long b, unsigned long f)
+{
+}
+
+unsigned long UARTIntStatus(unsigned long b, tBoolean m)
+{
+    return 0;
+}
+
+void UARTIntClear(unsigned long b, unsigned long f)
+{
+}
+
+void UARTFIFOLevelSet(unsigned long b, unsigned long tx, unsigned long rx)
+{
+}
+
+void UARTFIFOEnable(unsigned long b)
+{
+}
+
+unsigned long UARTRxErrorGet(unsigned long b)
+{
+    return 0;
+}
+
+void UARTRxErrorClear(unsigned long b)
+{
+}
+
+void UARTTxIntModeSet(unsigned long b, unsigned long m)
+{
+}
+
+//*****************************************************************************
+// pin
+//*****************************************************************************
+void PinTypeI2C(unsigned long p, unsigned long m)
+{
+}
+
+void PinTypeGPIO(unsigned long p, unsigned long m, tBoolean od)
+{
+}
+
+void PinTypeSPI(unsigned long p, unsigned long m)
+{
+}
+
+void PinTypeUART(unsigned long p, unsigned long m)
+{
+}
+
+//*****************************************************************************
+// udma
+//*****************************************************************************
+void uDMAEnable(void)
+{
+}
+
+void uDMAChannelAssign(unsigned long m)
+{
+}
+
+void uDMAChannelAttributeDisable(unsigned long c, unsigned long a)
+{
+}
+
+void uDMAChannelControlSet(unsigned long c, unsigned long ctl)
+{
+}
+
+void uDMAIntRegister(unsigned long i, void (*fn)(void))
+{
+}
+
+void uDMAErrorStatusClear(void)
+{
+}
+
+unsigned long uDMAErrorStatusGet(void)
+{
+    return 0;
+}
+
+unsigned long uDMAIntStatus(void)
+{
+    return 0;
+}
+
+void uDMAIntClear(unsigned long m)
+{
+}
+
+//*****************************************************************************
+// uart_if / gpio_if / common / pinmux / i2c_if
+//*****************************************************************************
+void InitTerm(void)
+{
+}
+
+void ClearTerm(void)
+{
+}
+
+void GPIO_IF_LedConfigure(unsigned char l)
+{
+}
+
+void GPIO_IF_LedOff(char l)
+{
+}
+
+void GPIO_IF_LedOn(char l)
+{
+}
+
+void PinMuxConfig(void)
+{
+}
+
+int I2C_IF_Open(unsigned long m)
+{
+    return 0;
+}
+
+//*****************************************************************************
+// simplelink
+//*****************************************************************************
+short sl_Socket(short d, short t, short p)
+{
+    return 0;
+}
+
+short sl_Close(short sd)
+{
+    return 0;
+}
+
+short sl_Connect(short sd, const SlSockAddr_t *a, short len)
+{
+    return 0;
+}
+
+short sl_Send(short sd, const void *buf, short len, short flags)
+{
+    return 0;
+}
+
+short sl_Recv(short sd, void *buf, short len, short flags)
+{
+    return 0;
+}
+
+short sl_SetSockOpt(short sd, short level, short opt, const void *val, unsigned short len)
+{
+    return 0;
+}
+
+short sl_NetAppDnsGetHostByName(signed char *name, unsigned short len, unsigned long *ip, unsigned char fam)
+{
+    return 0;
+}
+
+unsigned short sl_Htons(unsigned short v)
+{
+    return 0;
+}
+
+unsigned long sl_Htonl(unsigned long v)
+{
+    return 0;
+}
+
+short sl_Start(const void *a, const void *b, const void *c)
+{
+    return 0;
+}
+
+short sl_Stop(unsigned short t)
+{
+    return 0;
+}
+
+short sl_DevSet(unsigned char id, unsigned char opt, unsigned char len, unsigned char *val)
+{
+    return 0;
+}
+
+short sl_DevGet(unsigned char id, unsigned char *opt, unsigned char *len, unsigned char *val)
+{
+    return 0;
+}
+
+short sl_WlanPolicySet(unsigned char t, unsigned char p, unsigned char *v, unsigned char l)
+{
+    return 0;
+}
+
+short sl_WlanProfileDel(short i)
+{
+    return 0;
+}
+
+short sl_WlanDisconnect(void)
+{
+    return 0;
+}
+
+short sl_WlanSetMode(unsigned char m)
+{
+    return 0;
+}
+
+short sl_NetCfgSet(unsigned char id, unsigned char opt, unsigned char len, unsigned char *v)
+{
+    return 0;
+}
+
+short sl_WlanSet(unsigned short id, unsigned short opt, unsigned short len, unsigned char *v)
+{
+    return 0;
+}
+
+short sl_NetAppMDNSUnRegisterService(const signed char *n, unsigned char l)
+{
+    return 0;
+}
+
+short sl_WlanRxFilterSet(unsigned char op, const unsigned char *buf, unsigned short len)
+{
+    return 0;
+}
+
+short sl_WlanConnect(const signed char *ssid, short l, unsigned char *mac, const SlSecParams_t *p, const void *e)
+{
+    return 0;
+}
+
+long sl_FsOpen(const unsigned char *name, unsigned long mode, unsigned long *token, long *fh)
+{
+    return 0;
+}
+
+short sl_FsClose(long fh, unsigned char *cert, unsigned char *sig, unsigned long len)
+{
+    return 0;
+}
+
+long sl_FsRead(long fh, unsigned long off, unsigned char *buf, unsigned long len)
+{
+    return 0;
+}
+
+long sl_FsWrite(long fh, unsigned long off, unsigned char *buf, unsigned long len)
+{
+    return 0;
+}
+
+short sl_FsDel(const unsigned char *name, unsigned long token)
+{
+    return 0;
+}
+
+void _SlNonOsMainLoopTask(void)
+{
+}
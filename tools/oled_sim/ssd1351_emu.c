@@ -0,0 +1,354 @@
+// Fake GSPI, GPIO and uDMA for the SSD1351 driver. Every byte the driver
+// sends is fed through a small SSD1351 command decoder that keeps its own
+// copy of GDDRAM, so the image is what the panel would show.
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "cc3200_sim.h"
+#include "ssd1351_emu.h"
+
+#define EMU_W           128
+#define EMU_H           128
+#define OLED_DC_PIN     GPIO_PIN_6
+
+#define CMD_SETCOLUMN   0x15
+#define CMD_SETROW      0x75
+#define CMD_WRITERAM    0x5C
+#define CMD_STARTLINE   0xA1
+
+static EmuStats s_stats;
+static unsigned short s_ram[EMU_H][EMU_W];
+static unsigned long s_regs[64];
+
+// decoder state
+static int s_dc = 0;
+static int s_cmd = 0;
+static int s_argc = 0;
+static unsigned char s_args[8];
+static int s_col0 = 0, s_col1 = EMU_W - 1, s_row0 = 0, s_row1 = EMU_H - 1;
+static int s_cx = 0, s_cy = 0;
+static int s_startLine = 0;
+static int s_haveHigh = 0;
+static unsigned char s_high = 0;
+
+volatile unsigned long *sim_reg(unsigned long addr)
+{
+    return &s_regs[(addr >> 2) & 63];
+}
+
+static void feed(unsigned char b)
+{
+    s_stats.bytes++;
+
+    if (!s_dc) {
+        s_cmd = b;
+        s_argc = 0;
+        if (b == CMD_WRITERAM) {
+            s_stats.windows++;
+            s_cx = s_col0;
+            s_cy = s_row0;
+            s_haveHigh = 0;
+        }
+        return;
+    }
+
+    if (s_cmd == CMD_WRITERAM) {
+        if (!s_haveHigh) {
+            s_high = b;
+            s_haveHigh = 1;
+            return;
+        }
+        s_haveHigh = 0;
+        if ((s_cx < EMU_W) && (s_cy < EMU_H)) {
+            s_ram[s_cy][s_cx] = (unsigned short)((s_high << 8) | b);
+        }
+        if (++s_cx > s_col1) {
+            s_cx = s_col0;
+            if (++s_cy > s_row1) s_cy = s_row0;
+        }
+        return;
+    }
+
+    if (s_argc < (int)sizeof(s_args)) s_args[s_argc++] = b;
+    if ((s_cmd == CMD_SETCOLUMN) && (s_argc == 2)) {
+        s_col0 = s_args[0];
+        s_col1 = s_args[1];
+    } else if ((s_cmd == CMD_SETROW) && (s_argc == 2)) {
+        s_row0 = s_args[0];
+        s_row1 = s_args[1];
+    } else if ((s_cmd == CMD_STARTLINE) && (s_argc == 1)) {
+        s_startLine = s_args[0] % EMU_H;
+    }
+}
+
+//*****************************************************************************
+// GPIO / GSPI
+//*****************************************************************************
+void GPIOPinWrite(unsigned long base, unsigned char pins, unsigned char val)
+{
+    if ((base == GPIOA3_BASE) && (pins & OLED_DC_PIN)) {
+        s_dc = (val & OLED_DC_PIN) ? 1 : 0;
+    }
+}
+
+void SPICSEnable(unsigned long base)
+{
+    s_stats.csCycles++;
+}
+
+void SPIDataPut(unsigned long base, unsigned long data)
+{
+    feed((unsigned char)data);
+}
+
+void SPIDataGet(unsigned long base, unsigned long *data)
+{
+    *data = 0;
+}
+
+long SPITransfer(unsigned long base, unsigned char *out, unsigned char *in,
+                 unsigned long len, unsigned long flags)
+{
+    unsigned long i;
+
+    if (flags & SPI_CS_ENABLE) s_stats.csCycles++;
+    for (i = 0; i < len; i++) {
+        if (out) feed(out[i]);
+        if (in) in[i] = 0;
+    }
+    return 0;
+}
+
+//*****************************************************************************
+// uDMA: enabling GSPI DMA moves the whole TX transfer at once and then
+// raises the GSPI interrupt. Re-arming from inside the handler is queued
+// and run by the outermost call instead of recursing.
+//*****************************************************************************
+static unsigned char *s_dmaSrc[32];
+static unsigned long s_dmaLen[32];
+static int s_dmaOn[32];
+static void *s_dmaBase = 0;
+static void (*s_spiIsr)(void) = 0;
+static int s_dmaDepth = 0;
+static int s_dmaPending = 0;
+
+void uDMAControlBaseSet(void *base)
+{
+    s_dmaBase = base;
+}
+
+void *uDMAControlBaseGet(void)
+{
+    return s_dmaBase;
+}
+
+void uDMAChannelTransferSet(unsigned long ch, unsigned long mode, void *src,
+                            void *dst, unsigned long len)
+{
+    ch &= 31;
+    s_dmaSrc[ch] = (unsigned char *)src;
+    s_dmaLen[ch] = len;
+}
+
+void uDMAChannelEnable(unsigned long ch)
+{
+    s_dmaOn[ch & 31] = 1;
+}
+
+void uDMAChannelDisable(unsigned long ch)
+{
+    s_dmaOn[ch & 31] = 0;
+}
+
+tBoolean uDMAChannelIsEnabled(unsigned long ch)
+{
+    return s_dmaOn[ch & 31];
+}
+
+unsigned long uDMAChannelModeGet(unsigned long ch)
+{
+    return s_dmaOn[ch & 31] ? UDMA_MODE_BASIC : UDMA_MODE_STOP;
+}
+
+void SPIIntRegister(unsigned long base, void (*handler)(void))
+{
+    s_spiIsr = handler;
+}
+
+void SPIDmaEnable(unsigned long base, unsigned long flags)
+{
+    unsigned long i;
+    unsigned long tx = UDMA_CH31_GSPI_TX & 31;
+    unsigned long rx = UDMA_CH30_GSPI_RX & 31;
+
+    s_dmaPending = 1;
+    if (s_dmaDepth) return;
+
+    s_dmaDepth = 1;
+    while (s_dmaPending) {
+        s_dmaPending = 0;
+        if (!s_dmaOn[tx] || !s_dmaOn[rx]) continue;
+        for (i = 0; i < s_dmaLen[tx]; i++) feed(s_dmaSrc[tx][i]);
+        s_stats.dmaBytes += s_dmaLen[tx];
+        s_dmaOn[tx] = 0;
+        s_dmaOn[rx] = 0;
+        if (s_spiIsr) s_spiIsr();
+    }
+    s_dmaDepth = 0;
+}
+
+//*****************************************************************************
+// UART_PRINT goes to stdout so the firmware's debug lines stay visible.
+//*****************************************************************************
+int Report(const char *fmt, ...)
+{
+    va_list ap;
+    int ret;
+
+    va_start(ap, fmt);
+    ret = vprintf(fmt, ap);
+    va_end(ap);
+    return ret;
+}
+
+//*****************************************************************************
+// Snapshots: what the panel shows, so GDDRAM rows are taken from the start
+// line onward.
+//*****************************************************************************
+static const unsigned short *shownRow(int y)
+{
+    return s_ram[(y + s_startLine) % EMU_H];
+}
+
+void emuStats(EmuStats *out)
+{
+    *out = s_stats;
+}
+
+// FNV-1a over the displayed RGB565 image, for golden-image comparisons.
+unsigned long emuHash(void)
+{
+    unsigned long h = 2166136261UL;
+    int x, y;
+
+    for (y = 0; y < EMU_H; y++) {
+        for (x = 0; x < EMU_W; x++) {
+            h ^= shownRow(y)[x];
+            h = (h * 16777619UL) & 0xFFFFFFFFUL;
+        }
+    }
+    return h;
+}
+
+static void toRGB(unsigned short c, unsigned char *rgb)
+{
+    rgb[0] = (unsigned char)(((c >> 11) & 0x1F) * 255 / 31);
+    rgb[1] = (unsigned char)(((c >> 5) & 0x3F) * 255 / 63);
+    rgb[2] = (unsigned char)((c & 0x1F) * 255 / 31);
+}
+
+int emuWritePPM(const char *path)
+{
+    FILE *f = fopen(path, "wb");
+    unsigned char rgb[3];
+    int x, y;
+
+    if (!f) return -1;
+    fprintf(f, "P6\n%d %d\n255\n", EMU_W, EMU_H);
+    for (y = 0; y < EMU_H; y++) {
+        for (x = 0; x < EMU_W; x++) {
+            toRGB(shownRow(y)[x], rgb);
+            fwrite(rgb, 1, 3, f);
+        }
+    }
+    fclose(f);
+    return 0;
+}
+
+static unsigned long crc32(unsigned long crc, const unsigned char *buf, unsigned long len)
+{
+    int k;
+
+    crc ^= 0xFFFFFFFFUL;
+    while (len--) {
+        crc ^= *buf++;
+        for (k = 0; k < 8; k++) {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1)));
+        }
+    }
+    return crc ^ 0xFFFFFFFFUL;
+}
+
+static void put32(unsigned char *p, unsigned long v)
+{
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+}
+
+static void pngChunk(FILE *f, const char *type, const unsigned char *data, unsigned long len)
+{
+    unsigned char hdr[8];
+    unsigned long crc;
+
+    put32(hdr, len);
+    memcpy(hdr + 4, type, 4);
+    crc = crc32(0, hdr + 4, 4);
+    crc = crc32(crc, data, len);
+    fwrite(hdr, 1, 8, f);
+    fwrite(data, 1, len, f);
+    put32(hdr, crc);
+    fwrite(hdr, 1, 4, f);
+}
+
+// PNG with the image data in one stored (uncompressed) deflate block, so
+// no zlib is needed; 128 rows of 1 + 384 bytes fit under the 64 KiB limit.
+int emuWritePNG(const char *path)
+{
+    static const unsigned char sig[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    enum { RAW = EMU_H * (1 + EMU_W * 3) };
+    static unsigned char idat[2 + 5 + RAW + 4];
+    unsigned char ihdr[13];
+    unsigned char *raw = idat + 7;
+    unsigned long a = 1, b = 0, i;
+    FILE *f;
+    int x, y;
+
+    for (y = 0; y < EMU_H; y++) {
+        unsigned char *row = raw + y * (1 + EMU_W * 3);
+        row[0] = 0; // filter: none
+        for (x = 0; x < EMU_W; x++) toRGB(shownRow(y)[x], row + 1 + x * 3);
+    }
+    for (i = 0; i < RAW; i++) {
+        a = (a + raw[i]) % 65521UL;
+        b = (b + a) % 65521UL;
+    }
+
+    idat[0] = 0x78;                 // zlib: deflate, 32K window
+    idat[1] = 0x01;
+    idat[2] = 0x01;                 // final stored block
+    idat[3] = RAW & 0xFF;
+    idat[4] = (RAW >> 8) & 0xFF;
+    idat[5] = ~RAW & 0xFF;
+    idat[6] = (~RAW >> 8) & 0xFF;
+    put32(raw + RAW, (b << 16) | a);
+
+    put32(ihdr, EMU_W);
+    put32(ihdr + 4, EMU_H);
+    ihdr[8] = 8;                    // bit depth
+    ihdr[9] = 2;                    // truecolour
+    ihdr[10] = 0;
+    ihdr[11] = 0;
+    ihdr[12] = 0;
+
+    f = fopen(path, "wb");
+    if (!f) return -1;
+    fwrite(sig, 1, sizeof(sig), f);
+    pngChunk(f, "IHDR", ihdr, sizeof(ihdr));
+    pngChunk(f, "IDAT", idat, sizeof(idat));
+    pngChunk(f, "IEND", ihdr, 0);
+    fclose(f);
+    return 0;
+}
@@ -0,0 +1,19 @@
+// Host-side SSD1351 emulator: the fake GSPI/GPIO/uDMA layer decodes the
+// command stream the driver clocks out into a 128x128 RGB565 image and
+// counts what it cost on the wire.
+#ifndef SSD1351_EMU_H
+#define SSD1351_EMU_H
+
+typedef struct {
+    unsigned long bytes;    // command + data bytes on MOSI
+    unsigned long csCycles; // CS assertions
+    unsigned long windows;  // SETCOLUMN/SETROW address windows opened
+    unsigned long dmaBytes; // subset of bytes moved by the uDMA model
+} EmuStats;
+
+void emuStats(EmuStats *out);
+unsigned long emuHash(void);
+int emuWritePPM(const char *path);
+int emuWritePNG(const char *path);
+
+#endif
@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+"""Convert PNG artwork into run-length encoded Sprite arrays for the OLED.
+
+    tools/png2sprite/png2sprite.py [--matte 000000] -o aegis_sprites.h art/*.png
+
+Every pixel is reduced to RGB565 and looked up in a per-sprite palette of at
+most 256 colours. Pixels with alpha below 128 map to one transparent palette
+entry, unless --matte gives a colour to flatten them onto; opaque sprites
+are streamed through a single panel window. The index stream is row-major
+and packed PackBits-style; see the Sprite comment in Adafruit_GFX.h for the
+token format drawSprite() decodes.
+
+Only the Python standard library is used (zlib for the PNG IDAT stream).
+"""
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+PNG_SIG = b"\x89PNG\r\n\x1a\n"
+RUN_MAX = 128
+TRANSPARENT = -1
+
+
+def fail(msg):
+    sys.exit("png2sprite: " + msg)
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def read_png(path):
+    """Return (width, height, rows) with rows of (r, g, b, a) tuples."""
+    with open(path, "rb") as f:
+        blob = f.read()
+    if not blob.startswith(PNG_SIG):
+        fail("%s: not a PNG file" % path)
+
+    pos = len(PNG_SIG)
+    idat = b""
+    plte = []
+    trns = b""
+    header = None
+    while pos < len(blob):
+        length, kind = struct.unpack(">I4s", blob[pos:pos + 8])
+        body = blob[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            header = struct.unpack(">IIBBBBB", body)
+        elif kind == b"PLTE":
+            plte = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b"tRNS":
+            trns = body
+        elif kind == b"IDAT":
+            idat += body
+        elif kind == b"IEND":
+            break
+    if header is None:
+        fail("%s: missing IHDR" % path)
+
+    width, height, depth, ctype, _, _, interlace = header
+    if depth != 8 or interlace != 0:
+        fail("%s: only 8-bit, non-interlaced PNGs are supported" % path)
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}.get(ctype)
+    if channels is None:
+        fail("%s: unsupported colour type %d" % (path, ctype))
+
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    prev = bytearray(stride)
+    rows = []
+    for y in range(height):
+        base = y * (stride + 1)
+        kind = raw[base]
+        line = bytearray(raw[base + 1:base + 1 + stride])
+        for i in range(stride):
+            left = line[i - channels] if i >= channels else 0
+            up = prev[i]
+            ul = prev[i - channels] if i >= channels else 0
+            if kind == 1:
+                line[i] = (line[i] + left) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + up) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + ((left + up) >> 1)) & 0xFF
+            elif kind == 4:
+                line[i] = (line[i] + paeth(left, up, ul)) & 0xFF
+            elif kind != 0:
+                fail("%s: bad filter type %d" % (path, kind))
+        prev = line
+
+        row = []
+        for x in range(width):
+            px = line[x * channels:(x + 1) * channels]
+            if ctype == 0:
+                rgba = (px[0], px[0], px[0], 255)
+            elif ctype == 2:
+                rgba = (px[0], px[1], px[2], 255)
+            elif ctype == 3:
+                alpha = trns[px[0]] if px[0] < len(trns) else 255
+                rgba = plte[px[0]] + (alpha,)
+            elif ctype == 4:
+                rgba = (px[0], px[0], px[0], px[1])
+            else:
+                rgba = tuple(px)
+            row.append(rgba)
+        rows.append(row)
+    return width, height, rows
+
+
+def rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def index_pixels(path, rows, matte):
+    palette = []
+    lookup = {}
+    indices = []
+    for row in rows:
+        for r, g, b, a in row:
+            if a >= 128:
+                key = rgb565(r, g, b)
+            elif matte is not None:
+                key = matte
+            else:
+                key = TRANSPARENT
+            if key not in lookup:
+                lookup[key] = len(palette)
+                palette.append(key)
+            indices.append(lookup[key])
+    if len(palette) > 256:
+        fail("%s: %d colours after RGB565 reduction, limit is 256"
+             % (path, len(palette)))
+    transparent = lookup.get(TRANSPARENT, -1)
+    return palette, transparent, indices
+
+
+def encode(indices):
+    """PackBits-style runs: repeats of 3+ (2+ when no literal is open)
+    become 2-byte tokens, everything else is gathered into literals."""
+    out = bytearray()
+    literal = []
+
+    def flush_literal():
+        while literal:
+            chunk = literal[:RUN_MAX]
+            del literal[:RUN_MAX]
+            out.append(0x80 | (len(chunk) - 1))
+            out.extend(chunk)
+
+    i = 0
+    while i < len(indices):
+        run = 1
+        while (i + run < len(indices) and run < RUN_MAX and
+               indices[i + run] == indices[i]):
+            run += 1
+        if run >= 3 or (run == 2 and not literal):
+            flush_literal()
+            out.append(run - 1)
+            out.append(indices[i])
+            i += run
+        else:
+            literal.append(indices[i])
+            i += 1
+    flush_literal()
+    return out
+
+
+def c_name(path):
+    stem = os.path.splitext(os.path.basename(path))[0]
+    return "sprite_" + re.sub(r"[^0-9A-Za-z]+", "_", stem).strip("_").lower()
+
+
+def emit(name, width, height, palette, transparent, data):
+    lines = ["// %dx%d, %d colours, %d bytes of runs (%d raw)"
+             % (width, height, len(palette), len(data), width * height * 2),
+             "static const unsigned short %s_palette[%d] = {"
+             % (name, len(palette))]
+    colours = ["0x%04X" % (0 if c == TRANSPARENT else c) for c in palette]
+    for i in range(0, len(colours), 8):
+        lines.append("  " + ", ".join(colours[i:i + 8]) + ",")
+    lines.append("};")
+    lines.append("static const unsigned char %s_data[%d] = {" % (name, len(data)))
+    for i in range(0, len(data), 12):
+        lines.append("  " + ", ".join("0x%02X" % b for b in data[i:i + 12]) + ",")
+    lines.append("};")
+    lines.append("static const Sprite %s = {%d, %d, %d, %s_palette, %s_data};"
+                 % (name, width, height, transparent, name, name))
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("-o", "--output", required=True, help="C header to write")
+    parser.add_argument("--matte", metavar="RRGGBB",
+                        help="draw transparent pixels in this colour instead")
+    parser.add_argument("png", nargs="+", help="input PNG files")
+    args = parser.parse_args()
+
+    matte = None
+    if args.matte is not None:
+        if not re.fullmatch(r"[0-9A-Fa-f]{6}", args.matte):
+            fail("--matte wants RRGGBB hex, got %s" % args.matte)
+        value = int(args.matte, 16)
+        matte = rgb565(value >> 16, (value >> 8) & 0xFF, value & 0xFF)
+
+    guard = re.sub(r"[^0-9A-Za-z]+", "_", os.path.basename(args.output)).upper()
+    parts = ["// Generated by tools/png2sprite/png2sprite.py; do not edit.",
+             "// Sources: " + " ".join(os.path.basename(p) for p in args.png) +
+             ("" if args.matte is None else " (matte %s)" % args.matte.upper()),
+             "",
+             "#ifndef _%s" % guard,
+             "#define _%s" % guard,
+             "",
+             '#include "Adafruit_GFX.h"']
+    for path in args.png:
+        width, height, rows = read_png(path)
+        if width > 128 or height > 128:
+            fail("%s: %dx%d is larger than the panel" % (path, width, height))
+        palette, transparent, indices = index_pixels(path, rows, matte)
+        parts.append("")
+        parts.append(emit(c_name(path), width, height, palette, transparent,
+                          encode(indices)))
+    parts.append("")
+    parts.append("#endif // _%s" % guard)
+
+    with open(args.output, "w", newline="\n") as f:
+        f.write("\n".join(parts) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,73 @@
+/*
+ * byte_ring.c
+ *
+ *  Single-producer/single-consumer byte FIFO for passing data between an
+ *  interrupt handler and the main loop without masking interrupts.
+ */
+#include "byte_ring.h"
+
+//*****************************************************************************
+//
+//! \brief Attach a buffer to the ring and empty it
+//!
+//! \param ring is the ring to set up
+//! \param buf is its storage
+//! \param size is the length of buf; must be a power of two
+//!
+//! \return None
+//!
+//*****************************************************************************
+void ByteRingInit(ByteRing *ring, unsigned char *buf, unsigned long size) {
+    ring->buf = buf;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->dropped = 0;
+    ring->peak = 0;
+}
+
+//*****************************************************************************
+//
+//! \brief Append a byte. The data is stored before head is published, so the
+//! consumer never sees a slot that has not been written yet.
+//!
+//! \return 1 if stored, 0 if the ring was full
+//!
+//*****************************************************************************
+int ByteRingPut(ByteRing *ring, unsigned char c) {
+    unsigned long head = ring->head;
+    unsigned long used = head - ring->tail;
+
+    if (used > ring->mask) {
+        ring->dropped++;
+        return 0;
+    }
+    ring->buf[head & ring->mask] = c;
+    ring->head = head + 1;
+    if (used + 1 > ring->peak) ring->peak = used + 1;
+    return 1;
+}
+
+//*****************************************************************************
+//
+//! \brief Take the oldest byte
+//!
+//! \return 1 if a byte was read into *c, 0 if the ring was empty
+//!
+//*****************************************************************************
+int ByteRingGet(ByteRing *ring, unsigned char *c) {
+    unsigned long tail = ring->tail;
+
+    if (tail == ring->head) return 0;
+    *c = ring->buf[tail & ring->mask];
+    ring->tail = tail + 1;
+    return 1;
+}
+
+unsigned long ByteRingCount(const ByteRing *ring) {
+    return ring->head - ring->tail;
+}
+
+unsigned long ByteRingFree(const ByteRing *ring) {
+    return ring->mask + 1 - (ring->head - ring->tail);
+}
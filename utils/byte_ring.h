@@ -0,0 +1,34 @@
+/*
+ * byte_ring.h
+ *
+ *  Single-producer/single-consumer byte FIFO for passing data between an
+ *  interrupt handler and the main loop without masking interrupts.
+ */
+
+#ifndef UTILS_BYTE_RING_H_
+#define UTILS_BYTE_RING_H_
+
+// head is only written by the producer and tail only by the consumer; both
+// run freely and wrap through the full unsigned range, so the fill level is
+// always head - tail. size must be a power of two.
+typedef struct {
+    volatile unsigned char *buf;
+    unsigned long mask;
+    volatile unsigned long head;
+    volatile unsigned long tail;
+    volatile unsigned long dropped;   // bytes refused because the ring was full
+    volatile unsigned long peak;      // highest fill level seen by the producer
+} ByteRing;
+
+void ByteRingInit(ByteRing *ring, unsigned char *buf, unsigned long size);
+
+// Producer side. Returns 0 (and counts the byte as dropped) when full.
+int ByteRingPut(ByteRing *ring, unsigned char c);
+
+// Consumer side. Returns 0 when empty.
+int ByteRingGet(ByteRing *ring, unsigned char *c);
+
+unsigned long ByteRingCount(const ByteRing *ring);
+unsigned long ByteRingFree(const ByteRing *ring);
+
+#endif /* UTILS_BYTE_RING_H_ */
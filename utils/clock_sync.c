@@ -0,0 +1,139 @@
+/*
+ * clock_sync.c
+ *
+ *  NTP-style offset and drift estimate between the local millisecond clock
+ *  and a peer's, from timestamped request/reply exchanges.
+ */
+#include "clock_sync.h"
+
+static long clampLong(long value, long lo, long hi) {
+    if (value < lo) return lo;
+    if (value > hi) return hi;
+    return value;
+}
+
+static long absLong(long value) {
+    return (value < 0) ? -value : value;
+}
+
+//*****************************************************************************
+//
+//! \brief Forget the estimate and any exchanges in the current window
+//!
+//! \return None
+//!
+//*****************************************************************************
+void ClockSyncReset(ClockSync *sync) {
+    sync->synced = 0;
+    sync->offsetMs = 0;
+    sync->driftPpm = 0;
+    sync->refLocalMs = 0;
+    sync->rttMs = 0;
+    sync->driftValid = 0;
+    sync->anchorOffsetMs = 0;
+    sync->anchorLocalMs = 0;
+    sync->windowCount = 0;
+    sync->bestOffsetMs = 0;
+    sync->bestRttMs = 0;
+    sync->bestLocalMs = 0;
+    sync->samples = 0;
+    sync->rejected = 0;
+    sync->steps = 0;
+}
+
+void ClockSyncRestart(ClockSync *sync) {
+    if (sync->synced) sync->steps++;
+    sync->synced = 0;
+    sync->windowCount = 0;
+}
+
+long ClockSyncOffset(const ClockSync *sync, unsigned long localMs) {
+    long long dt;
+
+    if (!sync->synced) return 0;
+    dt = (long)(localMs - sync->refLocalMs);
+    return sync->offsetMs + (long)(dt * sync->driftPpm / 1000000LL);
+}
+
+unsigned long ClockSyncToRemote(const ClockSync *sync, unsigned long localMs) {
+    return localMs + (unsigned long)ClockSyncOffset(sync, localMs);
+}
+
+// The offset barely moves over one offset's worth of time, so evaluating it
+// at remoteMs - offsetMs instead of the exact local time is good to well
+// under a millisecond.
+unsigned long ClockSyncToLocal(const ClockSync *sync, unsigned long remoteMs) {
+    unsigned long approx = remoteMs - (unsigned long)sync->offsetMs;
+
+    return remoteMs - (unsigned long)ClockSyncOffset(sync, approx);
+}
+
+// Take the window's best exchange into the estimate.
+static void closeWindow(ClockSync *sync) {
+    long predicted = ClockSyncOffset(sync, sync->bestLocalMs);
+    long measured;
+    unsigned long span;
+
+    if (!sync->synced || (absLong(sync->bestOffsetMs - predicted) > CLOCK_SYNC_STEP_MS)) {
+        // First window, or the peer's clock jumped (it restarted): start
+        // over from this exchange. The drift belongs to the oscillator, not
+        // the boot, so it is kept.
+        if (sync->synced) sync->steps++;
+        sync->synced = 1;
+        sync->offsetMs = sync->bestOffsetMs;
+        sync->refLocalMs = sync->bestLocalMs;
+        sync->anchorOffsetMs = sync->bestOffsetMs;
+        sync->anchorLocalMs = sync->bestLocalMs;
+        sync->rttMs = sync->bestRttMs;
+        return;
+    }
+
+    span = sync->bestLocalMs - sync->anchorLocalMs;
+    if (span >= CLOCK_SYNC_SPAN_MS) {
+        measured = (long)((long long)(sync->bestOffsetMs - sync->anchorOffsetMs) * 1000000LL / (long)span);
+        measured = clampLong(measured, -CLOCK_SYNC_DRIFT_MAX, CLOCK_SYNC_DRIFT_MAX);
+        sync->driftPpm = sync->driftValid ? sync->driftPpm + (measured - sync->driftPpm) / 4 : measured;
+        sync->driftValid = 1;
+        sync->anchorOffsetMs = sync->bestOffsetMs;
+        sync->anchorLocalMs = sync->bestLocalMs;
+    }
+
+    // Move halfway toward the new measurement so one lucky or unlucky
+    // window cannot yank the timebase around.
+    predicted = ClockSyncOffset(sync, sync->bestLocalMs);
+    sync->offsetMs = predicted + (sync->bestOffsetMs - predicted) / 2;
+    sync->refLocalMs = sync->bestLocalMs;
+    sync->rttMs = sync->bestRttMs;
+}
+
+//*****************************************************************************
+//
+//! \brief Record one request/reply exchange. The offset assumes the two legs
+//! took equally long, so it is off by at most half the round trip; the
+//! caller should take serialization time out of t1 and t4 when the request
+//! and reply differ much in length.
+//!
+//! \return 1 if a window closed, 0 if recorded, -1 if discarded
+//!
+//*****************************************************************************
+int ClockSyncAdd(ClockSync *sync, unsigned long t1, unsigned long t2,
+                 unsigned long t3, unsigned long t4) {
+    long rtt = (long)(t4 - t1) - (long)(t3 - t2);
+    long offset = ((long)(t2 - t1) + (long)(t3 - t4)) / 2;
+
+    if ((rtt < 0) || ((unsigned long)rtt > CLOCK_SYNC_RTT_MAX_MS) || ((long)(t3 - t2) < 0)) {
+        sync->rejected++;
+        return -1;
+    }
+    sync->samples++;
+    if ((sync->windowCount == 0) || ((unsigned long)rtt < sync->bestRttMs)) {
+        sync->bestOffsetMs = offset;
+        sync->bestRttMs = (unsigned long)rtt;
+        sync->bestLocalMs = t1 + (t4 - t1) / 2;
+    }
+    if (++sync->windowCount < CLOCK_SYNC_WINDOW) return 0;
+
+    closeWindow(sync);
+    sync->windowCount = 0;
+    return 1;
+}
@@ -0,0 +1,62 @@
+/*
+ * clock_sync.h
+ *
+ *  NTP-style offset and drift estimate between the local millisecond clock
+ *  and a peer's, from timestamped request/reply exchanges.
+ */
+
+#ifndef UTILS_CLOCK_SYNC_H_
+#define UTILS_CLOCK_SYNC_H_
+
+// Each window of exchanges contributes only its shortest round trip, which
+// is the one least skewed by queueing on either side.
+#define CLOCK_SYNC_WINDOW       6
+#define CLOCK_SYNC_RTT_MAX_MS   1000UL  // slower replies are discarded
+#define CLOCK_SYNC_STEP_MS      500L    // a jump this large means the peer restarted
+#define CLOCK_SYNC_SPAN_MS      10000UL // shortest baseline for a drift update
+#define CLOCK_SYNC_DRIFT_MAX    20000L  // ppm; AVR boards on a resonator can be ~5000 off
+
+// offsetMs is remote - local at local time refLocalMs, and the peer's clock
+// runs driftPpm parts per million fast, so
+//   remote(t) = t + offsetMs + driftPpm * (t - refLocalMs) / 1000000.
+typedef struct {
+    int synced;
+    long offsetMs;
+    long driftPpm;
+    unsigned long refLocalMs;
+    unsigned long rttMs;            // round trip of the last accepted window
+
+    int driftValid;
+    long anchorOffsetMs;            // raw window minimum the drift is measured from
+    unsigned long anchorLocalMs;
+
+    int windowCount;
+    long bestOffsetMs;
+    unsigned long bestRttMs;
+    unsigned long bestLocalMs;
+
+    unsigned long samples;
+    unsigned long rejected;
+    unsigned long steps;            // estimator restarts after a clock jump
+} ClockSync;
+
+void ClockSyncReset(ClockSync *sync);
+
+// The peer's clock is known to have jumped (e.g. it restarted): drop the
+// offset and the open window but keep the drift, which belongs to the
+// oscillator. The next full window re-syncs.
+void ClockSyncRestart(ClockSync *sync);
+
+// One exchange: t1 local send, t2 remote receive, t3 remote send, t4 local
+// receive. Returns 1 when it closed a window and moved the estimate, 0 when
+// it was only recorded, -1 when it was discarded.
+int ClockSyncAdd(ClockSync *sync, unsigned long t1, unsigned long t2,
+                 unsigned long t3, unsigned long t4);
+
+// remote - local at local time localMs; 0 until the first window closes.
+long ClockSyncOffset(const ClockSync *sync, unsigned long localMs);
+
+unsigned long ClockSyncToLocal(const ClockSync *sync, unsigned long remoteMs);
+unsigned long ClockSyncToRemote(const ClockSync *sync, unsigned long localMs);
+
+#endif /* UTILS_CLOCK_SYNC_H_ */
@@ -0,0 +1,205 @@
+/*
+ * dns_cache.c
+ *
+ *  Host -> IPv4 cache in front of sl_NetAppDnsGetHostByName(), kept in the
+ *  SimpleLink file system so a reset can connect without a lookup.
+ */
+#include "dns_cache.h"
+
+#include <string.h>
+
+#include "simplelink.h"
+
+#define DNS_CACHE_MAGIC     0x444E5331UL    // "DNS1"
+
+// File layout. Only addresses go to flash; the age of an entry means
+// nothing across a reset.
+typedef struct {
+    unsigned long magic;
+    struct {
+        char host[DNS_CACHE_HOST_MAX];
+        unsigned long ip;
+    } rec[DNS_CACHE_ENTRIES];
+} DnsCacheFile;
+
+static DnsCacheEntry *findEntry(DnsCache *cache, const char *host) {
+    int i;
+
+    for (i = 0; i < DNS_CACHE_ENTRIES; i++) {
+        if (cache->entry[i].host[0] && strcmp(cache->entry[i].host, host) == 0) {
+            return &cache->entry[i];
+        }
+    }
+    return 0;
+}
+
+// The host's slot, else a free one, else the one resolved longest ago
+static DnsCacheEntry *claimEntry(DnsCache *cache, const char *host, unsigned long nowMs) {
+    DnsCacheEntry *e = findEntry(cache, host);
+    int i;
+
+    if (e) return e;
+
+    e = &cache->entry[0];
+    for (i = 0; i < DNS_CACHE_ENTRIES; i++) {
+        if (cache->entry[i].host[0] == '\0') {
+            e = &cache->entry[i];
+            break;
+        }
+        if (nowMs - cache->entry[i].resolvedMs > nowMs - e->resolvedMs) {
+            e = &cache->entry[i];
+        }
+    }
+
+    memset(e, 0, sizeof(*e));
+    strncpy(e->host, host, DNS_CACHE_HOST_MAX - 1);
+    return e;
+}
+
+static void loadFile(DnsCache *cache, unsigned long nowMs) {
+    DnsCacheFile file;
+    long fh;
+    long ret;
+    int i;
+
+    if (sl_FsOpen((const unsigned char *)DNS_CACHE_FILE, FS_MODE_OPEN_READ, 0, &fh) < 0) return;
+    ret = sl_FsRead(fh, 0, (unsigned char *)&file, sizeof(file));
+    sl_FsClose(fh, 0, 0, 0);
+    if (ret != (long)sizeof(file) || file.magic != DNS_CACHE_MAGIC) return;
+
+    for (i = 0; i < DNS_CACHE_ENTRIES; i++) {
+        DnsCacheEntry *e = &cache->entry[i];
+
+        file.rec[i].host[DNS_CACHE_HOST_MAX - 1] = '\0';
+        if (file.rec[i].host[0] == '\0' || file.rec[i].ip == 0) continue;
+        strcpy(e->host, file.rec[i].host);
+        e->ip = file.rec[i].ip;
+        e->savedIp = e->ip;
+        e->savedMs = nowMs;
+        e->resolvedMs = nowMs;
+    }
+}
+
+// Whether e's fresh answer should go to flash: the file has nothing for
+// the host, or what it has failed or is past DNS_CACHE_SAVE_MS. A mere
+// change of address, which rotating endpoints give on most lookups, is
+// not enough.
+static int needsSave(const DnsCacheEntry *e, unsigned long nowMs) {
+    if (e->ip == e->savedIp) return 0;
+    return e->savedIp == 0 || e->failed || nowMs - e->savedMs >= DNS_CACHE_SAVE_MS;
+}
+
+// Rewrites the whole table; see needsSave() for when.
+static void saveFile(DnsCache *cache, unsigned long nowMs) {
+    DnsCacheFile file;
+    long fh;
+    long ret;
+    int i;
+
+    memset(&file, 0, sizeof(file));
+    file.magic = DNS_CACHE_MAGIC;
+    for (i = 0; i < DNS_CACHE_ENTRIES; i++) {
+        DnsCacheEntry *e = &cache->entry[i];
+
+        if (e->host[0] == '\0' || e->ip == 0) continue;
+        strcpy(file.rec[i].host, e->host);
+        file.rec[i].ip = e->ip;
+    }
+
+    ret = sl_FsOpen((const unsigned char *)DNS_CACHE_FILE, FS_MODE_OPEN_WRITE, 0, &fh);
+    if (ret < 0) {
+        ret = sl_FsOpen((const unsigned char *)DNS_CACHE_FILE,
+                        FS_MODE_OPEN_CREATE(sizeof(file), _FS_FILE_OPEN_FLAG_COMMIT), 0, &fh);
+    }
+    if (ret < 0) return;
+
+    ret = sl_FsWrite(fh, 0, (unsigned char *)&file, sizeof(file));
+    sl_FsClose(fh, 0, 0, 0);
+    if (ret != (long)sizeof(file)) return;
+
+    for (i = 0; i < DNS_CACHE_ENTRIES; i++) {
+        DnsCacheEntry *e = &cache->entry[i];
+
+        if (e->ip != e->savedIp) {
+            e->savedIp = e->ip;
+            e->savedMs = nowMs;
+        }
+        e->failed = 0;
+    }
+    cache->saves++;
+}
+
+//*****************************************************************************
+//
+//! \brief Empty the table and the counters. The file is left alone and is
+//! read again on the next resolve.
+//!
+//! \return None
+//!
+//*****************************************************************************
+void DnsCacheInit(DnsCache *cache) {
+    memset(cache, 0, sizeof(*cache));
+}
+
+//*****************************************************************************
+//
+//! \brief Resolve host through the cache; see dns_cache.h
+//!
+//! \return DNS_CACHE_LOOKUP, DNS_CACHE_HIT, DNS_CACHE_STALE or the lookup's
+//! negative error
+//!
+//*****************************************************************************
+long DnsCacheResolve(DnsCache *cache, const char *host, unsigned long *ip,
+                     unsigned long nowMs) {
+    DnsCacheEntry *e;
+    unsigned long addr = 0;
+    long ret;
+
+    if (!cache->loaded) {
+        cache->loaded = 1;
+        loadFile(cache, nowMs);
+    }
+
+    e = findEntry(cache, host);
+    if (e && e->ip != 0 && nowMs - e->resolvedMs < DNS_CACHE_TTL_MS) {
+        cache->hits++;
+        *ip = e->ip;
+        return DNS_CACHE_HIT;
+    }
+
+    cache->lookups++;
+    ret = sl_NetAppDnsGetHostByName((signed char *)host, strlen(host), &addr, SL_AF_INET);
+    if (ret < 0 || addr == 0) {
+        if (e && e->ip != 0 && nowMs - e->resolvedMs < DNS_CACHE_TTL_MS + DNS_CACHE_STALE_MS) {
+            cache->staleHits++;
+            *ip = e->ip;
+            return DNS_CACHE_STALE;
+        }
+        cache->failures++;
+        return (ret < 0) ? ret : -1;
+    }
+
+    e = claimEntry(cache, host, nowMs);
+    e->ip = addr;
+    e->resolvedMs = nowMs;
+    if (needsSave(e, nowMs)) saveFile(cache, nowMs);
+
+    *ip = addr;
+    return DNS_CACHE_LOOKUP;
+}
+
+//*****************************************************************************
+//
+//! \brief Drop host's address; see dns_cache.h
+//!
+//! \return None
+//!
+//*****************************************************************************
+void DnsCacheForget(DnsCache *cache, const char *host) {
+    DnsCacheEntry *e = findEntry(cache, host);
+
+    if (e) {
+        e->ip = 0;
+        e->failed = 1;
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * dns_cache.h
+ *
+ *  Host -> IPv4 cache in front of sl_NetAppDnsGetHostByName(), kept in the
+ *  SimpleLink file system so a reset can connect without a lookup.
+ */
+
+#ifndef UTILS_DNS_CACHE_H_
+#define UTILS_DNS_CACHE_H_
+
+#define DNS_CACHE_ENTRIES   2
+#define DNS_CACHE_HOST_MAX  64
+// SimpleLink does not hand back the record's TTL, so every entry gets this
+// one; a bad entry is dropped as soon as a connect to it fails
+// (DnsCacheForget).
+#define DNS_CACHE_TTL_MS    300000UL
+#define DNS_CACHE_STALE_MS  1800000UL   // past the TTL, still served while lookups fail
+// AWS endpoints answer from a rotating set of addresses, so a new answer
+// alone does not rewrite the file: any of them will do after a reset. The
+// file is rewritten when its address failed, or is older than this.
+#define DNS_CACHE_SAVE_MS   86400000UL
+#define DNS_CACHE_FILE      "/aegis/dnscache.bin"
+
+// DnsCacheResolve() results; negative values are the lookup's error
+#define DNS_CACHE_LOOKUP    0           // fresh answer from the network
+#define DNS_CACHE_HIT       1           // entry within its TTL
+#define DNS_CACHE_STALE     2           // lookup failed, expired entry served instead
+
+typedef struct {
+    char host[DNS_CACHE_HOST_MAX];
+    unsigned long ip;                   // host order; 0 marks a free slot
+    unsigned long resolvedMs;
+    unsigned long savedIp;              // what the file holds for this host
+    unsigned long savedMs;              // when it was written (or read back)
+    int failed;                         // forgotten since: the file's copy may be bad too
+} DnsCacheEntry;
+
+typedef struct {
+    int loaded;
+    DnsCacheEntry entry[DNS_CACHE_ENTRIES];
+
+    unsigned long lookups;              // queries actually sent
+    unsigned long hits;
+    unsigned long staleHits;
+    unsigned long failures;             // lookup failed with nothing to fall back on
+    unsigned long saves;                // file rewrites
+} DnsCache;
+
+void DnsCacheInit(DnsCache *cache);
+
+// Address for host, from the cache when possible. The file is read on the
+// first call, which must come after sl_Start(); entries from it count as
+// resolved at that moment. Returns one of the DNS_CACHE_ codes above.
+long DnsCacheResolve(DnsCache *cache, const char *host, unsigned long *ip,
+                     unsigned long nowMs);
+
+// The cached address did not answer: look it up again next time, and do
+// not serve it as a stale fallback either.
+void DnsCacheForget(DnsCache *cache, const char *host);
+
+#endif /* UTILS_DNS_CACHE_H_ */
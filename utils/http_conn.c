@@ -0,0 +1,307 @@
+/*
+ * http_conn.c
+ *
+ *  One long-lived TLS connection to the shadow endpoint, shared by every
+ *  HTTP/1.1 request with keep-alive. Requests may be pipelined: each send
+ *  queues one response, and responses are read back in the order sent.
+ *
+ *  The socket is non-blocking and every call does a bounded slice of work
+ *  and returns, HTTP_CONN_PENDING meaning "call again next loop". Nothing
+ *  here ever waits on the server.
+ */
+#include "http_conn.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int lowerChar(int c) {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+// Case-insensitive prefix match against a lower-case literal
+static int startsWith(const char *s, const char *lit) {
+    while (*lit) {
+        if (lowerChar(*s++) != *lit++) return 0;
+    }
+    return 1;
+}
+
+// Offset just past the blank line ending the header block, or -1
+static int headerEnd(const char *buf, int len) {
+    int i;
+
+    for (i = 0; i + 3 < len; i++) {
+        if (buf[i] == '\r' && buf[i + 1] == '\n' && buf[i + 2] == '\r' && buf[i + 3] == '\n') {
+            return i + 4;
+        }
+    }
+    return -1;
+}
+
+// Value of the header whose lower-case name (colon included) is given, or 0
+static const char *findHeader(const char *hdr, int len, const char *name) {
+    int i = 0;
+
+    while (i < len) {
+        if (startsWith(hdr + i, name)) {
+            const char *p = hdr + i + strlen(name);
+            while (*p == ' ' || *p == '\t') p++;
+            return p;
+        }
+        while (i < len && hdr[i] != '\n') i++;
+        i++;
+    }
+    return 0;
+}
+
+static void consume(HttpConn *conn, int n) {
+    memmove(conn->rx, conn->rx + n, conn->rxLen - n);
+    conn->rxLen -= n;
+    conn->rx[conn->rxLen] = '\0';
+}
+
+// Whatever the driver reports when the peer has gone (0, a reset, a TLS
+// alert) is folded into STALE/CLOSED so the caller can tell a dead keep-alive
+// socket from a server that is merely slow, which stays SL_EAGAIN.
+static int recvMore(HttpConn *conn) {
+    int ret;
+
+    if (conn->rxLen >= HTTP_CONN_RX_SIZE - 1) return HTTP_CONN_ERR_HEADER;
+    ret = sl_Recv(conn->sock, conn->rx + conn->rxLen, HTTP_CONN_RX_SIZE - 1 - conn->rxLen, 0);
+    if (ret == SL_EAGAIN) return ret;
+    if (ret <= 0) return (conn->rxLen == 0) ? HTTP_CONN_ERR_STALE : HTTP_CONN_ERR_CLOSED;
+    conn->rxLen += ret;
+    conn->rx[conn->rxLen] = '\0';
+    return ret;
+}
+
+static int failRead(HttpConn *conn, int err) {
+    if (err == HTTP_CONN_ERR_TIMEOUT) conn->timeouts++;
+    HttpConnClose(conn);
+    conn->lastError = err;
+    return err;
+}
+
+// Nothing more has arrived yet. Only the silence of the server is limited;
+// a response that keeps trickling in is waited for.
+static int waitMore(HttpConn *conn, unsigned long nowMs) {
+    if (nowMs - conn->lastUseMs >= HTTP_CONN_TIMEOUT_MS) {
+        return failRead(conn, HTTP_CONN_ERR_TIMEOUT);
+    }
+    return HTTP_CONN_PENDING;
+}
+
+// Status line and headers of the response at the front of rx, header block
+// of hdrLen bytes. Bodies are framed by Content-Length, which the shadow
+// endpoint always sends. Without one the body runs to the end of the
+// connection, which is then closed.
+static int parseHeader(HttpConn *conn, int hdrLen) {
+    const char *value;
+
+    conn->status = 0;
+    if (sscanf(conn->rx, "HTTP/1.%*d %d", &conn->status) != 1) return HTTP_CONN_ERR_HEADER;
+
+    conn->remaining = -1;
+    conn->keepAlive = 1;
+    value = findHeader(conn->rx, hdrLen, "content-length:");
+    if (value) conn->remaining = strtol(value, 0, 10);
+    if (conn->status < 200 || conn->status == 204 || conn->status == 304) conn->remaining = 0;
+    value = findHeader(conn->rx, hdrLen, "connection:");
+    if (value && startsWith(value, "close")) conn->keepAlive = 0;
+    if (findHeader(conn->rx, hdrLen, "transfer-encoding:")) conn->remaining = -1;
+    if (conn->remaining < 0) conn->keepAlive = 0;
+
+    conn->inBody = 1;
+    return 0;
+}
+
+//*****************************************************************************
+//
+//! \brief Start closed with all counters at zero
+//!
+//! \return None
+//!
+//*****************************************************************************
+void HttpConnInit(HttpConn *conn, int port) {
+    memset(conn, 0, sizeof(*conn));
+    conn->sock = -1;
+    conn->port = port;
+}
+
+//*****************************************************************************
+//
+//! \brief Close the socket, or abandon the connect under way. Responses
+//! still queued are counted as dropped.
+//!
+//! \return None
+//!
+//*****************************************************************************
+void HttpConnClose(HttpConn *conn) {
+    if (conn->connecting && conn->connect.sock >= 0) sl_Close(conn->connect.sock);
+    if (conn->sock >= 0) sl_Close(conn->sock);
+    conn->connecting = 0;
+    conn->sock = -1;
+    conn->dropped += conn->pending;
+    conn->pending = 0;
+    conn->wanted = 0;
+    conn->used = 0;
+    conn->inBody = 0;
+    conn->rxLen = 0;
+    conn->rx[0] = '\0';
+}
+
+//*****************************************************************************
+//
+//! \brief Discard unwanted responses and close a connection left unused for
+//! HTTP_CONN_IDLE_MS, so the next request does not find out the hard way
+//! that the server already has.
+//!
+//! \return None
+//!
+//*****************************************************************************
+void HttpConnPoll(HttpConn *conn, unsigned long nowMs) {
+    if (conn->sock < 0) return;
+    if (conn->pending > 0) {
+        if (!(conn->wanted & 1)) HttpConnReadStep(conn, 0, 0, nowMs);
+        return;
+    }
+    if (nowMs - conn->lastUseMs < HTTP_CONN_IDLE_MS) return;
+    conn->idleCloses++;
+    HttpConnClose(conn);
+}
+
+//*****************************************************************************
+//
+//! \brief Make sure a connection is open, doing the DNS lookup and TLS
+//! handshake only when there is none to reuse; see http_conn.h
+//!
+//! \return 0, HTTP_CONN_PENDING or the TLS error
+//!
+//*****************************************************************************
+int HttpConnConnect(HttpConn *conn, unsigned long nowMs) {
+    int ret;
+
+    if (!conn->connecting) {
+        if (conn->sock >= 0) return 0;
+        ret = tls_connect_begin(&conn->connect, conn->port);
+        if (ret < 0) return ret;
+        conn->connecting = 1;
+    }
+
+    ret = tls_connect_poll(&conn->connect);
+    if (ret == TLS_CONNECT_PENDING) return HTTP_CONN_PENDING;
+    conn->connecting = 0;
+    if (ret < 0) return ret;
+
+    conn->sock = conn->connect.sock;
+    conn->used = 0;
+    conn->pending = 0;
+    conn->wanted = 0;
+    conn->inBody = 0;
+    conn->rxLen = 0;
+    conn->lastUseMs = nowMs;
+    conn->handshakes++;
+    return 0;
+}
+
+//*****************************************************************************
+//
+//! \brief Send what the socket takes of one request; see http_conn.h
+//!
+//! \return 0, HTTP_CONN_PENDING or a negative error
+//!
+//*****************************************************************************
+int HttpConnSendStep(HttpConn *conn, const char *req, int len, int *sent,
+                     int wait, unsigned long nowMs) {
+    int ret;
+
+    if (conn->sock < 0 || conn->connecting) return HTTP_CONN_ERR_NONE;
+
+    // HttpConnPoll() reads the older responses off in the meantime
+    if (*sent == 0 && conn->pending >= HTTP_CONN_PIPELINE) return HTTP_CONN_PENDING;
+
+    ret = sl_Send(conn->sock, req + *sent, len - *sent, 0);
+    if (ret == SL_EAGAIN) return HTTP_CONN_PENDING;
+    if (ret <= 0) return failRead(conn, (ret == 0) ? HTTP_CONN_ERR_CLOSED : ret);
+    *sent += ret;
+    conn->lastUseMs = nowMs;
+    if (*sent < len) return HTTP_CONN_PENDING;
+
+    if (conn->used) conn->avoided++;
+    conn->used = 1;
+    if (wait) conn->wanted |= 1U << conn->pending;
+    conn->pending++;
+    return 0;
+}
+
+//*****************************************************************************
+//
+//! \brief Read a slice of the oldest outstanding response; see http_conn.h
+//!
+//! \return HTTP status code of an awaited response, HTTP_CONN_PENDING or a
+//! negative error
+//!
+//*****************************************************************************
+int HttpConnReadStep(HttpConn *conn, HttpBodyFn onBody, void *ctx, unsigned long nowMs) {
+    int budget = HTTP_CONN_SLICE;
+    int wanted;
+    int hdrLen;
+    int take;
+    int ret;
+
+    if (conn->sock < 0 || conn->connecting || conn->pending <= 0) return HTTP_CONN_ERR_NONE;
+    wanted = conn->wanted & 1;
+    if (!wanted) onBody = 0;
+
+    if (!conn->inBody) {
+        while ((hdrLen = headerEnd(conn->rx, conn->rxLen)) < 0) {
+            if (budget <= 0) return HTTP_CONN_PENDING;
+            ret = recvMore(conn);
+            if (ret == SL_EAGAIN) return waitMore(conn, nowMs);
+            if (ret < 0) return failRead(conn, ret);
+            budget -= ret;
+            conn->lastUseMs = nowMs;
+        }
+
+        ret = parseHeader(conn, hdrLen);
+        if (ret < 0) return failRead(conn, ret);
+
+        // Body bytes that arrived with the header; anything past them is the
+        // start of the next pipelined response and stays in rx.
+        take = conn->rxLen - hdrLen;
+        if (conn->remaining >= 0 && take > conn->remaining) take = (int)conn->remaining;
+        if (onBody && take > 0) onBody(ctx, conn->rx + hdrLen, take);
+        if (conn->remaining > 0) conn->remaining -= take;
+        consume(conn, hdrLen + take);
+    }
+
+    // rx is empty from here on, so the rest of the body lands there on its
+    // way to onBody.
+    while (conn->remaining != 0) {
+        int room = HTTP_CONN_RX_SIZE - 1;
+
+        if (budget <= 0) return HTTP_CONN_PENDING;
+        if (room > budget) room = budget;
+        if (conn->remaining > 0 && room > conn->remaining) room = (int)conn->remaining;
+
+        ret = sl_Recv(conn->sock, conn->rx, room, 0);
+        if (ret == SL_EAGAIN) return waitMore(conn, nowMs);
+        if (ret <= 0) {
+            if (conn->remaining < 0) break;
+            return failRead(conn, HTTP_CONN_ERR_CLOSED);
+        }
+        if (onBody) onBody(ctx, conn->rx, ret);
+        if (conn->remaining > 0) conn->remaining -= ret;
+        budget -= ret;
+        conn->lastUseMs = nowMs;
+    }
+
+    conn->inBody = 0;
+    conn->pending--;
+    conn->wanted >>= 1;
+    if (conn->status >= 400) conn->failed++;
+    ret = conn->status;
+    if (!conn->keepAlive) HttpConnClose(conn);
+    return wanted ? ret : HTTP_CONN_PENDING;
+}
@@ -0,0 +1,95 @@
+/*
+ * http_conn.h
+ *
+ *  One long-lived TLS connection to the shadow endpoint, shared by every
+ *  HTTP/1.1 request with keep-alive. Requests may be pipelined: each send
+ *  queues one response, and responses are read back in the order sent.
+ *
+ *  The socket is non-blocking and every call does a bounded slice of work
+ *  and returns, HTTP_CONN_PENDING meaning "call again next loop". Nothing
+ *  here ever waits on the server.
+ */
+
+#ifndef UTILS_HTTP_CONN_H_
+#define UTILS_HTTP_CONN_H_
+
+#include "network_utils.h"
+
+#define HTTP_CONN_RX_SIZE       768     // header block plus read-ahead of the next response
+#define HTTP_CONN_IDLE_MS       20000UL // close before the server's own idle timer does
+#define HTTP_CONN_TIMEOUT_MS    5000UL  // awaited response silent this long: give up
+#define HTTP_CONN_PIPELINE      4       // most responses left unread at once
+#define HTTP_CONN_SLICE         512     // most bytes one HttpConnReadStep() receives
+
+#define HTTP_CONN_PENDING       1       // not finished, call again
+
+// Error returns. Raw sl_Send()/sl_Recv() errors are passed through as
+// they are, so these sit at -1000 and below, clear of every SimpleLink code
+// and of main.c's -2..-4; TLS_CONNECT_ERR_* in network_utils.h share the
+// range.
+#define HTTP_CONN_ERR_STALE     -1001   // closed before any byte of the response arrived
+#define HTTP_CONN_ERR_CLOSED    -1002   // closed part way through a response
+#define HTTP_CONN_ERR_HEADER    -1003   // header block malformed or over HTTP_CONN_RX_SIZE
+#define HTTP_CONN_ERR_NONE      -1004   // not connected, or nothing outstanding to read
+#define HTTP_CONN_ERR_TIMEOUT   -1005   // see HTTP_CONN_TIMEOUT_MS
+
+// Receives the body of an awaited response as it comes in, a slice at a
+// time; data is only valid during the call.
+typedef void (*HttpBodyFn)(void *ctx, const char *data, int len);
+
+typedef struct {
+    int sock;                       // -1 while closed
+    int port;
+    int connecting;                 // handshake under way on connect.sock
+    TlsConnect connect;
+    int pending;                    // requests sent whose responses are still unread
+    unsigned int wanted;            // bit n: the nth oldest response goes to a reader
+    int used;                       // the open socket has already carried a request
+    unsigned long lastUseMs;
+    int status;                     // status code of the last response read
+    int lastError;                  // why the connection last closed on an error
+
+    // Response being read, carried from one HttpConnReadStep() to the next
+    int inBody;                     // header parsed, body under way
+    long remaining;                 // body bytes still to come, -1 for "until close"
+    int keepAlive;
+
+    int rxLen;
+    char rx[HTTP_CONN_RX_SIZE];
+
+    unsigned long handshakes;       // completed TLS connects
+    unsigned long avoided;          // requests sent without a handshake of their own
+    unsigned long reconnects;       // requests resent after a reused socket turned out dead
+    unsigned long idleCloses;
+    unsigned long dropped;          // pipelined responses lost with their connection
+    unsigned long failed;           // responses with a 4xx/5xx status, read or discarded
+    unsigned long timeouts;
+} HttpConn;
+
+void HttpConnInit(HttpConn *conn, int port);
+
+// Start connecting, or move a connect along. Returns 0 once a socket is
+// open (at once if one already is), HTTP_CONN_PENDING, or the TLS error.
+int HttpConnConnect(HttpConn *conn, unsigned long nowMs);
+void HttpConnClose(HttpConn *conn);
+
+// Once per main loop: reads off responses nobody waits for, a slice at a
+// time, and drops the connection after HTTP_CONN_IDLE_MS unused.
+void HttpConnPoll(HttpConn *conn, unsigned long nowMs);
+
+// Send req from *sent on, as far as the socket takes it, advancing *sent.
+// Returns 0 once all of it is out and the response is queued; wait says
+// whether HttpConnReadStep() hands that response back or it is discarded.
+// HTTP_CONN_PENDING while some is left (or the pipeline is full), else a
+// negative error after which the connection is closed.
+int HttpConnSendStep(HttpConn *conn, const char *req, int len, int *sent,
+                     int wait, unsigned long nowMs);
+
+// Receive up to HTTP_CONN_SLICE bytes toward the oldest response, which is
+// discarded if nobody waits for it. Body bytes of an awaited response go to
+// onBody (which may be 0) as they arrive, so no response is ever held whole.
+// Returns its status code once it is complete, HTTP_CONN_PENDING until
+// then, or a negative error after which the connection is closed.
+int HttpConnReadStep(HttpConn *conn, HttpBodyFn onBody, void *ctx, unsigned long nowMs);
+
+#endif /* UTILS_HTTP_CONN_H_ */
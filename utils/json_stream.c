@@ -0,0 +1,347 @@
+/*
+ * json_stream.c
+ *
+ *  Push tokenizer for JSON that arrives in pieces. Bytes are fed as they
+ *  come off the socket; every scalar whose key path ends in one of the
+ *  registered paths is handed to a callback in that same pass.
+ */
+#include "json_stream.h"
+
+#include <string.h>
+
+#define ST_VALUE            0   // a value is due
+#define ST_KEY_OR_END       1   // just after '{'
+#define ST_VALUE_OR_END     2   // just after '['
+#define ST_KEY              3   // after ',' in an object
+#define ST_KEY_STRING       4
+#define ST_COLON            5
+#define ST_AFTER            6   // value done: ',' or the container's closer
+#define ST_STRING           7
+#define ST_SCALAR           8   // number or literal
+#define ST_DONE             9   // root value complete
+
+static int isSpace(int c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static int hexValue(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int fail(JsonStream *js, int err) {
+    js->error = err;
+    return err;
+}
+
+static int topIsArray(const JsonStream *js) {
+    return (js->arrays >> (js->depth - 1)) & 1;
+}
+
+// Compare path's segments, last first, with the keys leading to the value
+static int pathMatches(const JsonStream *js, const char *path) {
+    const char *end = path + strlen(path);
+    int level = js->depth - 1;
+
+    while (end > path) {
+        const char *seg = end;
+
+        while (seg > path && seg[-1] != '.') seg--;
+        if (level < 0 || ((js->arrays >> level) & 1)) return 0;
+        if (js->keyLen[level] != end - seg || memcmp(js->key[level], seg, end - seg) != 0) return 0;
+        level--;
+        end = (seg > path) ? seg - 1 : path;
+    }
+    return 1;
+}
+
+static int findMatch(const JsonStream *js) {
+    int i;
+
+    if (js->depth == 0 || topIsArray(js)) return -1;
+    for (i = 0; i < js->pathCount; i++) {
+        if (pathMatches(js, js->paths[i])) return i;
+    }
+    return -1;
+}
+
+static void emit(JsonStream *js, int last) {
+    JsonValue value;
+
+    js->piece[js->pieceLen] = '\0';
+    value.path = js->match;
+    value.type = js->type;
+    value.text = js->piece;
+    value.len = js->pieceLen;
+    value.offset = js->offset;
+    value.last = last;
+    js->onValue(js->ctx, &value);
+
+    js->offset += js->pieceLen;
+    js->pieceLen = 0;
+}
+
+static void valueDone(JsonStream *js) {
+    js->state = (js->depth == 0) ? ST_DONE : ST_AFTER;
+}
+
+// A decoded byte of a key or a string value
+static void putChar(JsonStream *js, int c) {
+    if (js->state == ST_KEY_STRING) {
+        int level = js->depth - 1;
+
+        if (js->keyLen[level] < JSON_STREAM_KEY_MAX - 1) {
+            js->key[level][js->keyLen[level]++] = (char)c;
+        } else {
+            js->keyLen[level] = JSON_STREAM_KEY_MAX;
+        }
+        return;
+    }
+
+    if (js->match < 0) return;
+    js->piece[js->pieceLen++] = (char)c;
+    if (js->pieceLen == JSON_STREAM_PIECE_MAX) emit(js, 0);
+}
+
+// \uXXXX as UTF-8. Surrogate pairs are not combined; nothing the shadow
+// carries is outside the BMP.
+static void putCode(JsonStream *js, unsigned int code) {
+    if (code < 0x80) {
+        putChar(js, code);
+    } else if (code < 0x800) {
+        putChar(js, 0xC0 | (code >> 6));
+        putChar(js, 0x80 | (code & 0x3F));
+    } else {
+        putChar(js, 0xE0 | (code >> 12));
+        putChar(js, 0x80 | ((code >> 6) & 0x3F));
+        putChar(js, 0x80 | (code & 0x3F));
+    }
+}
+
+// Inside a key or string value; returns 1 on the closing quote
+static int stringChar(JsonStream *js, int c) {
+    if (js->esc > 0) {
+        int h = hexValue(c);
+
+        if (h < 0) return fail(js, JSON_STREAM_ERR_SYNTAX);
+        js->code = (js->code << 4) | h;
+        if (--js->esc == 0) putCode(js, js->code);
+        return 0;
+    }
+    if (js->esc < 0) {
+        js->esc = 0;
+        switch (c) {
+        case 'b': putChar(js, '\b'); break;
+        case 'f': putChar(js, '\f'); break;
+        case 'n': putChar(js, '\n'); break;
+        case 'r': putChar(js, '\r'); break;
+        case 't': putChar(js, '\t'); break;
+        case 'u': js->esc = 4; js->code = 0; break;
+        case '"': case '\\': case '/': putChar(js, c); break;
+        default: return fail(js, JSON_STREAM_ERR_SYNTAX);
+        }
+        return 0;
+    }
+    if (c == '"') return 1;
+    if (c == '\\') {
+        js->esc = -1;
+        return 0;
+    }
+    if ((unsigned char)c < 0x20) return fail(js, JSON_STREAM_ERR_SYNTAX);
+    putChar(js, c);
+    return 0;
+}
+
+static int push(JsonStream *js, int isArray) {
+    if (js->depth >= JSON_STREAM_DEPTH) return fail(js, JSON_STREAM_ERR_DEPTH);
+    if (isArray) {
+        js->arrays |= 1U << js->depth;
+    } else {
+        js->arrays &= ~(1U << js->depth);
+    }
+    js->keyLen[js->depth] = 0;
+    js->depth++;
+    js->state = isArray ? ST_VALUE_OR_END : ST_KEY_OR_END;
+    return 0;
+}
+
+static int pop(JsonStream *js, int c) {
+    if (js->depth == 0 || topIsArray(js) != (c == ']')) return fail(js, JSON_STREAM_ERR_SYNTAX);
+    js->depth--;
+    valueDone(js);
+    return 0;
+}
+
+// Numbers and literals are held whole in piece, matched or not, so they
+// can be checked before anyone sees them.
+static int endScalar(JsonStream *js) {
+    const char *s = js->piece;
+
+    js->piece[js->pieceLen] = '\0';
+    if (strcmp(s, "true") == 0) {
+        js->type = JSON_STREAM_TRUE;
+    } else if (strcmp(s, "false") == 0) {
+        js->type = JSON_STREAM_FALSE;
+    } else if (strcmp(s, "null") == 0) {
+        js->type = JSON_STREAM_NULL;
+    } else if (*s == '-' || (*s >= '0' && *s <= '9')) {
+        js->type = JSON_STREAM_NUMBER;
+        for (; *s; s++) {
+            if (!(*s >= '0' && *s <= '9') && !strchr("+-.eE", *s)) return fail(js, JSON_STREAM_ERR_SYNTAX);
+        }
+    } else {
+        return fail(js, JSON_STREAM_ERR_SYNTAX);
+    }
+
+    if (js->match >= 0) {
+        emit(js, 1);
+    } else {
+        js->pieceLen = 0;
+    }
+    valueDone(js);
+    return 0;
+}
+
+static int startValue(JsonStream *js, int c) {
+    if (c == '{' || c == '[') return push(js, c == '[');
+
+    js->match = findMatch(js);
+    js->offset = 0;
+    js->pieceLen = 0;
+    if (c == '"') {
+        js->type = JSON_STREAM_STRING;
+        js->esc = 0;
+        js->state = ST_STRING;
+        return 0;
+    }
+    if (c == '-' || (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')) {
+        js->piece[js->pieceLen++] = (char)c;
+        js->state = ST_SCALAR;
+        return 0;
+    }
+    return fail(js, JSON_STREAM_ERR_SYNTAX);
+}
+
+// One byte. Returns 1 once it has been used up, 0 when the state changed
+// and it must be looked at again, or an error.
+static int step(JsonStream *js, int c) {
+    int ret;
+
+    switch (js->state) {
+    case ST_STRING:
+        ret = stringChar(js, c);
+        if (ret == 1) {
+            if (js->match >= 0) emit(js, 1);
+            valueDone(js);
+        }
+        return (ret < 0) ? ret : 1;
+
+    case ST_KEY_STRING:
+        ret = stringChar(js, c);
+        if (ret == 1) js->state = ST_COLON;
+        return (ret < 0) ? ret : 1;
+
+    case ST_SCALAR:
+        if (isSpace(c) || c == ',' || c == '}' || c == ']') {
+            ret = endScalar(js);
+            return (ret < 0) ? ret : 0;
+        }
+        if (js->pieceLen == JSON_STREAM_PIECE_MAX) return fail(js, JSON_STREAM_ERR_SYNTAX);
+        js->piece[js->pieceLen++] = (char)c;
+        return 1;
+
+    default:
+        break;
+    }
+
+    if (isSpace(c)) return 1;
+
+    switch (js->state) {
+    case ST_VALUE_OR_END:
+        if (c == ']') return (pop(js, c) < 0) ? js->error : 1;
+        /* fall through */
+    case ST_VALUE:
+        ret = startValue(js, c);
+        return (ret < 0) ? ret : 1;
+
+    case ST_KEY_OR_END:
+        if (c == '}') return (pop(js, c) < 0) ? js->error : 1;
+        /* fall through */
+    case ST_KEY:
+        if (c != '"') return fail(js, JSON_STREAM_ERR_SYNTAX);
+        js->keyLen[js->depth - 1] = 0;
+        js->esc = 0;
+        js->state = ST_KEY_STRING;
+        return 1;
+
+    case ST_COLON:
+        if (c != ':') return fail(js, JSON_STREAM_ERR_SYNTAX);
+        js->state = ST_VALUE;
+        return 1;
+
+    case ST_AFTER:
+        if (c == ',') {
+            js->state = topIsArray(js) ? ST_VALUE : ST_KEY;
+            return 1;
+        }
+        if (c == '}' || c == ']') return (pop(js, c) < 0) ? js->error : 1;
+        return fail(js, JSON_STREAM_ERR_SYNTAX);
+
+    default:
+        return fail(js, JSON_STREAM_ERR_SYNTAX);
+    }
+}
+
+//*****************************************************************************
+//
+//! \brief Start a document; see json_stream.h
+//!
+//! \return None
+//!
+//*****************************************************************************
+void JsonStreamInit(JsonStream *js, const char *const *paths, int pathCount,
+                    JsonStreamFn onValue, void *ctx) {
+    memset(js, 0, sizeof(*js));
+    js->paths = paths;
+    js->pathCount = pathCount;
+    js->onValue = onValue;
+    js->ctx = ctx;
+    js->state = ST_VALUE;
+    js->match = -1;
+}
+
+//*****************************************************************************
+//
+//! \brief Tokenize the next chunk, calling onValue for every matched value
+//! completed or filled to JSON_STREAM_PIECE_MAX within it
+//!
+//! \return 0 or the (sticky) error
+//!
+//*****************************************************************************
+int JsonStreamFeed(JsonStream *js, const char *data, int len) {
+    int i = 0;
+    int ret;
+
+    while (i < len && js->error == 0) {
+        ret = step(js, (unsigned char)data[i]);
+        if (ret > 0) i++;
+    }
+    return js->error;
+}
+
+//*****************************************************************************
+//
+//! \brief Finish the document. A number at the root has no closer, so it
+//! is only complete here.
+//!
+//! \return 0, the sticky error, or JSON_STREAM_ERR_SHORT
+//!
+//*****************************************************************************
+int JsonStreamEnd(JsonStream *js) {
+    if (js->error) return js->error;
+    if (js->state == ST_SCALAR && js->depth == 0) endScalar(js);
+    if (js->error) return js->error;
+    return (js->state == ST_DONE) ? 0 : fail(js, JSON_STREAM_ERR_SHORT);
+}
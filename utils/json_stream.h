@@ -0,0 +1,78 @@
+/*
+ * json_stream.h
+ *
+ *  Push tokenizer for JSON that arrives in pieces. Bytes are fed as they
+ *  come off the socket; every scalar whose key path ends in one of the
+ *  registered paths is handed to a callback in that same pass. The struct
+ *  is all the memory it needs: no copy of the document is kept, nesting is
+ *  bounded and keys are only remembered as far as matching requires.
+ */
+
+#ifndef UTILS_JSON_STREAM_H_
+#define UTILS_JSON_STREAM_H_
+
+#define JSON_STREAM_DEPTH       10      // deepest nesting accepted
+#define JSON_STREAM_KEY_MAX     24      // longer keys are tracked but never match
+#define JSON_STREAM_PIECE_MAX   32      // strings longer than this arrive in pieces
+
+// JsonValue.type
+#define JSON_STREAM_STRING      1
+#define JSON_STREAM_NUMBER      2
+#define JSON_STREAM_TRUE        3
+#define JSON_STREAM_FALSE       4
+#define JSON_STREAM_NULL        5
+
+#define JSON_STREAM_ERR_SYNTAX  -30
+#define JSON_STREAM_ERR_DEPTH   -31     // nested deeper than JSON_STREAM_DEPTH
+#define JSON_STREAM_ERR_SHORT   -32     // JsonStreamEnd() before the document closed
+
+// One matched value, or one piece of a long string. text is decoded
+// (escapes resolved, \u as UTF-8) and NUL-terminated; numbers and literals
+// come whole, as written.
+typedef struct {
+    int path;                       // index into the registered paths
+    int type;
+    const char *text;
+    int len;
+    int offset;                     // where text starts within the whole string
+    int last;                       // no more pieces follow
+} JsonValue;
+
+typedef void (*JsonStreamFn)(void *ctx, const JsonValue *value);
+
+typedef struct {
+    const char *const *paths;
+    int pathCount;
+    JsonStreamFn onValue;
+    void *ctx;
+
+    int state;
+    int error;
+    int depth;
+    unsigned int arrays;            // bit n: level n is an array
+    unsigned char keyLen[JSON_STREAM_DEPTH];    // JSON_STREAM_KEY_MAX: too long to match
+    char key[JSON_STREAM_DEPTH][JSON_STREAM_KEY_MAX];
+
+    int match;                      // path of the value being read, -1 for none
+    int type;
+    int offset;
+    int pieceLen;
+    char piece[JSON_STREAM_PIECE_MAX + 1];
+    int esc;                        // \u digits still expected, or -1 right after a backslash
+    unsigned int code;
+} JsonStream;
+
+// paths are dotted key names ("round_result.winner") matched against the
+// end of a value's key path, so they need not start at the root. The array
+// must outlive the stream.
+void JsonStreamInit(JsonStream *js, const char *const *paths, int pathCount,
+                    JsonStreamFn onValue, void *ctx);
+
+// Tokenize the next len bytes. Returns 0 or the first error, which sticks:
+// later calls return it without reading anything.
+int JsonStreamFeed(JsonStream *js, const char *data, int len);
+
+// The input is over. Returns 0 if exactly one complete document was fed.
+int JsonStreamEnd(JsonStream *js);
+
+#endif /* UTILS_JSON_STREAM_H_ */
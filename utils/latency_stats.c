@@ -0,0 +1,85 @@
+/*
+ * latency_stats.c
+ *
+ *  Fixed-size latency accumulator: min/avg/max plus a coarse histogram for
+ *  percentiles.
+ */
+#include "latency_stats.h"
+
+//*****************************************************************************
+//
+//! \brief Drop all samples
+//!
+//! \return None
+//!
+//*****************************************************************************
+void LatencyStatsReset(LatencyStats *stats) {
+    int i;
+
+    stats->count = 0;
+    stats->sum = 0;
+    stats->min = 0;
+    stats->max = 0;
+    for (i = 0; i < LATENCY_BINS; i++) {
+        stats->bins[i] = 0;
+    }
+}
+
+//*****************************************************************************
+//
+//! \brief Record one sample in milliseconds. Bin counts saturate instead of
+//! wrapping, which only matters for rounds far longer than the game allows.
+//!
+//! \return None
+//!
+//*****************************************************************************
+void LatencyStatsAdd(LatencyStats *stats, unsigned long ms) {
+    unsigned long bin = ms / LATENCY_BIN_MS;
+
+    if (bin >= LATENCY_BINS) bin = LATENCY_BINS - 1;
+    if (stats->bins[bin] != 0xFFFF) stats->bins[bin]++;
+    if ((stats->count == 0) || (ms < stats->min)) stats->min = ms;
+    if (ms > stats->max) stats->max = ms;
+    stats->sum += ms;
+    stats->count++;
+}
+
+unsigned long LatencyStatsAvg(const LatencyStats *stats) {
+    if (stats->count == 0) return 0;
+    return (stats->sum + stats->count / 2) / stats->count;
+}
+
+unsigned long LatencyStatsMin(const LatencyStats *stats) {
+    return stats->min;
+}
+
+//*****************************************************************************
+//
+//! \brief Walk the histogram until pct percent of the samples are covered
+//!
+//! \param pct is the percentile, 1..100
+//!
+//! \return upper edge of that bin in ms, at most the largest sample
+//!
+//*****************************************************************************
+unsigned long LatencyStatsPercentile(const LatencyStats *stats, int pct) {
+    unsigned long total = 0;
+    unsigned long seen = 0;
+    unsigned long need;
+    unsigned long edge;
+    int i;
+
+    for (i = 0; i < LATENCY_BINS; i++) {
+        total += stats->bins[i];
+    }
+    if (total == 0) return 0;
+
+    need = (total * (unsigned long)pct + 99) / 100;
+    if (need == 0) need = 1;
+    for (i = 0; i < LATENCY_BINS - 1; i++) {
+        seen += stats->bins[i];
+        if (seen >= need) break;
+    }
+    edge = (unsigned long)(i + 1) * LATENCY_BIN_MS - 1;
+    return (edge < stats->max) ? edge : stats->max;
+}
@@ -0,0 +1,34 @@
+/*
+ * latency_stats.h
+ *
+ *  Fixed-size latency accumulator: min/avg/max plus a coarse histogram for
+ *  percentiles, so a whole round of samples fits in a few hundred bytes.
+ */
+
+#ifndef UTILS_LATENCY_STATS_H_
+#define UTILS_LATENCY_STATS_H_
+
+#define LATENCY_BIN_MS      10
+#define LATENCY_BINS        64      // last bin also takes everything above it
+
+typedef struct {
+    unsigned long count;
+    unsigned long sum;
+    unsigned long min;
+    unsigned long max;
+    unsigned short bins[LATENCY_BINS];
+} LatencyStats;
+
+void LatencyStatsReset(LatencyStats *stats);
+void LatencyStatsAdd(LatencyStats *stats, unsigned long ms);
+
+// All of these return 0 while no sample has been added.
+unsigned long LatencyStatsAvg(const LatencyStats *stats);
+unsigned long LatencyStatsMin(const LatencyStats *stats);
+
+// Upper edge of the bin holding the pct-th percentile, capped at the
+// largest sample, so the result is never below the true value by more
+// than LATENCY_BIN_MS.
+unsigned long LatencyStatsPercentile(const LatencyStats *stats, int pct);
+
+#endif /* UTILS_LATENCY_STATS_H_ */
@@ -0,0 +1,474 @@
+/*
+ * mqtt_client.c
+ *
+ *  Minimal MQTT 3.1.1 client on an already connected SimpleLink socket:
+ *  CONNECT, SUBSCRIBE, PUBLISH at QoS 0/1 both ways, keep-alive pings.
+ *  Everything is driven from MqttPoll() on a non-blocking socket, so the
+ *  main loop never waits on the broker.
+ */
+#include "mqtt_client.h"
+
+#include <string.h>
+
+#include "simplelink.h"
+
+#define PKT_CONNECT     0x10
+#define PKT_CONNACK     0x20
+#define PKT_PUBLISH     0x30
+#define PKT_PUBACK      0x40
+#define PKT_SUBSCRIBE   0x82    // reserved flag bits are 0010 for SUBSCRIBE
+#define PKT_SUBACK      0x90
+#define PKT_PINGREQ     0xC0
+#define PKT_PINGRESP    0xD0
+#define PKT_DISCONNECT  0xE0
+
+#define PUBLISH_DUP     0x08
+
+// Remaining-length field, 1..4 bytes
+static int putLength(unsigned char *p, long len) {
+    int n = 0;
+
+    do {
+        unsigned char b = (unsigned char)(len & 0x7F);
+        len >>= 7;
+        if (len) b |= 0x80;
+        p[n++] = b;
+    } while (len);
+    return n;
+}
+
+static int putString(unsigned char *p, const char *s, int len) {
+    p[0] = (unsigned char)(len >> 8);
+    p[1] = (unsigned char)len;
+    memcpy(p + 2, s, len);
+    return len + 2;
+}
+
+static unsigned short getU16(const unsigned char *p) {
+    return (unsigned short)((p[0] << 8) | p[1]);
+}
+
+static unsigned short takeId(MqttClient *client) {
+    if (++client->nextId == 0) client->nextId = 1;
+    return client->nextId;
+}
+
+static int fail(MqttClient *client, int err) {
+    if (client->sock >= 0) sl_Close(client->sock);
+    client->sock = -1;
+    client->state = MQTT_DOWN;
+    client->lastError = err;
+    client->waiting = 0;
+    client->pingOut = 0;
+    client->subscribed = 0;
+    client->inflightId = 0;
+    client->rxLen = 0;
+    client->rxSkip = 0;
+    client->txLen = 0;
+    return err;
+}
+
+// Hand the socket as much of the queue as it takes without waiting. A
+// queue that makes no progress for MQTT_ACK_TIMEOUT_MS means a dead link.
+static int flushTx(MqttClient *client, unsigned long nowMs) {
+    int ret;
+
+    while (client->txLen > 0) {
+        ret = sl_Send(client->sock, client->tx, client->txLen, 0);
+        if (ret == SL_EAGAIN) {
+            if (nowMs - client->txSinceMs > MQTT_ACK_TIMEOUT_MS) return fail(client, MQTT_ERR_TIMEOUT);
+            return 0;
+        }
+        if (ret == 0) return fail(client, MQTT_ERR_CLOSED);
+        if (ret < 0) return fail(client, ret);
+        client->txLen -= ret;
+        memmove(client->tx, client->tx + ret, client->txLen);
+        client->txSinceMs = nowMs;
+        client->lastTxMs = nowMs;
+    }
+    return 0;
+}
+
+static int txRoom(const MqttClient *client) {
+    return MQTT_TXQ_MAX - client->txLen;
+}
+
+// Append one piece of a packet; the caller has checked txRoom()
+static void queueBytes(MqttClient *client, const void *buf, int len, unsigned long nowMs) {
+    if (client->txLen == 0) client->txSinceMs = nowMs;
+    memcpy(client->tx + client->txLen, buf, len);
+    client->txLen += len;
+}
+
+// Queue a whole packet and send what the socket takes now
+static int sendBytes(MqttClient *client, const unsigned char *buf, int len, unsigned long nowMs) {
+    if (len > txRoom(client)) return MQTT_ERR_TX_FULL;
+    queueBytes(client, buf, len, nowMs);
+    return flushTx(client, nowMs);
+}
+
+static void expectAck(MqttClient *client, unsigned long nowMs) {
+    if (client->waiting++ == 0) client->waitSinceMs = nowMs;
+}
+
+static void gotAck(MqttClient *client, unsigned long nowMs) {
+    if (client->waiting > 0) client->waiting--;
+    client->waitSinceMs = nowMs;
+}
+
+static int handlePublish(MqttClient *client, unsigned char flags, unsigned char *body,
+                         long len, unsigned long nowMs) {
+    int qos = (flags >> 1) & 3;
+    int topicLen;
+    int pos;
+    unsigned short id = 0;
+    unsigned char *payload;
+    unsigned char saved;
+    long payloadLen;
+
+    if (len < 2 || qos > 1) return fail(client, MQTT_ERR_PROTOCOL);
+    topicLen = getU16(body);
+    pos = 2 + topicLen;
+    if (qos) {
+        if (pos + 2 > len) return fail(client, MQTT_ERR_PROTOCOL);
+        id = getU16(body + pos);
+        pos += 2;
+    }
+    if (pos > len) return fail(client, MQTT_ERR_PROTOCOL);
+
+    if (qos) {
+        unsigned char ack[4] = { PKT_PUBACK, 2, 0, 0 };
+
+        ack[2] = (unsigned char)(id >> 8);
+        ack[3] = (unsigned char)id;
+        // A queue with no room for four bytes has stalled for good
+        if (txRoom(client) < (int)sizeof(ack)) return fail(client, MQTT_ERR_TX_FULL);
+        if (sendBytes(client, ack, sizeof(ack), nowMs) < 0) return client->lastError;
+    }
+
+    // The byte after the payload may already belong to the next packet
+    payload = body + pos;
+    payloadLen = len - pos;
+    saved = payload[payloadLen];
+    payload[payloadLen] = '\0';
+    client->received++;
+    if (client->onMessage) {
+        client->onMessage(client->ctx, (const char *)body + 2, topicLen,
+                          (const char *)payload, (int)payloadLen);
+    }
+    payload[payloadLen] = saved;
+    return 0;
+}
+
+static int handlePacket(MqttClient *client, unsigned char type, unsigned char *body,
+                        long len, unsigned long nowMs) {
+    long i;
+
+    switch (type & 0xF0) {
+        case PKT_CONNACK:
+            if (client->state != MQTT_CONNECTING || len != 2) return fail(client, MQTT_ERR_PROTOCOL);
+            if (body[1] != 0) return fail(client, MQTT_ERR_REFUSED);
+            client->state = MQTT_UP;
+            gotAck(client, nowMs);
+            return 0;
+
+        case PKT_SUBACK:
+            if (len < 3) return fail(client, MQTT_ERR_PROTOCOL);
+            if (getU16(body) != client->subscribeId) return 0;
+            client->subscribed = 1;
+            for (i = 2; i < len; i++) {
+                if (body[i] & 0x80) client->subscribed = 0;
+            }
+            gotAck(client, nowMs);
+            return 0;
+
+        case PKT_PUBLISH:
+            return handlePublish(client, type & 0x0F, body, len, nowMs);
+
+        case PKT_PUBACK:
+            if (len != 2) return fail(client, MQTT_ERR_PROTOCOL);
+            if (client->inflightId != 0 && getU16(body) == client->inflightId) {
+                client->ackedId = client->inflightId;
+                client->inflightId = 0;
+                client->acked++;
+            }
+            return 0;
+
+        case PKT_PINGRESP:
+            if (client->pingOut) {
+                client->pingOut = 0;
+                gotAck(client, nowMs);
+            }
+            return 0;
+
+        default:
+            return fail(client, MQTT_ERR_PROTOCOL);
+    }
+}
+
+// Handle every complete packet at the front of rx. Returns -1 once the
+// client is down, with the reason in lastError.
+static int drainPackets(MqttClient *client, unsigned long nowMs) {
+    while (client->rxLen >= 2) {
+        long remaining = 0;
+        long total;
+        int shift = 0;
+        int n = 1;
+        int ret;
+
+        do {
+            if (n >= client->rxLen) return 0;
+            if (n > 4) return fail(client, MQTT_ERR_PROTOCOL);
+            remaining |= (long)(client->rx[n] & 0x7F) << shift;
+            shift += 7;
+        } while (client->rx[n++] & 0x80);
+
+        total = n + remaining;
+        if (total > MQTT_RX_MAX) {
+            client->oversized++;
+            client->rxSkip = total - client->rxLen;
+            client->rxLen = 0;
+            return 0;
+        }
+        if (client->rxLen < total) return 0;
+
+        // The message callback may have disconnected
+        ret = handlePacket(client, client->rx[0], client->rx + n, remaining, nowMs);
+        if (ret < 0 || client->state == MQTT_DOWN) return -1;
+
+        client->rxLen -= (int)total;
+        memmove(client->rx, client->rx + total, client->rxLen);
+    }
+    return 0;
+}
+
+//*****************************************************************************
+//
+//! \brief Start disconnected with the counters at zero
+//!
+//! \return None
+//!
+//*****************************************************************************
+void MqttInit(MqttClient *client, MqttMessageFn onMessage, void *ctx) {
+    memset(client, 0, sizeof(*client));
+    client->sock = -1;
+    client->state = MQTT_DOWN;
+    client->onMessage = onMessage;
+    client->ctx = ctx;
+}
+
+//*****************************************************************************
+//
+//! \brief Send CONNECT on sock; see mqtt_client.h
+//!
+//! \return 0 or a negative error
+//!
+//*****************************************************************************
+int MqttConnect(MqttClient *client, int sock, const char *clientId,
+                unsigned short keepAliveS, unsigned long nowMs) {
+    unsigned char pkt[160];
+    int idLen = strlen(clientId);
+    int n;
+
+    if (client->state != MQTT_DOWN) return MQTT_ERR_STATE;
+    client->sock = sock;
+    if (idLen + 17 > (int)sizeof(pkt)) return fail(client, MQTT_ERR_SIZE);
+
+    client->keepAliveS = keepAliveS;
+    client->rxLen = 0;
+    client->rxSkip = 0;
+    client->waiting = 0;
+    client->pingOut = 0;
+    client->subscribeId = 0;
+    client->subscribed = 0;
+    client->inflightId = 0;
+    client->lastError = 0;
+    client->txLen = 0;
+
+    pkt[0] = PKT_CONNECT;
+    n = 1 + putLength(pkt + 1, 10 + 2 + idLen);
+    n += putString(pkt + n, "MQTT", 4);
+    pkt[n++] = 4;                   // protocol level 3.1.1
+    pkt[n++] = 0x02;                // clean session, no will, no credentials
+    pkt[n++] = (unsigned char)(keepAliveS >> 8);
+    pkt[n++] = (unsigned char)keepAliveS;
+    n += putString(pkt + n, clientId, idLen);
+
+    client->state = MQTT_CONNECTING;
+    expectAck(client, nowMs);
+    return sendBytes(client, pkt, n, nowMs);
+}
+
+//*****************************************************************************
+//
+//! \brief Send SUBSCRIBE for a list of topics; see mqtt_client.h
+//!
+//! \return packet id or a negative error
+//!
+//*****************************************************************************
+int MqttSubscribe(MqttClient *client, const char *const *topics, int count,
+                  int qos, unsigned long nowMs) {
+    unsigned char pkt[256];
+    long remaining = 2;
+    int n;
+    int i;
+
+    if (client->state != MQTT_UP) return MQTT_ERR_STATE;
+    for (i = 0; i < count; i++) {
+        remaining += 2 + strlen(topics[i]) + 1;
+    }
+    if (remaining + 5 > (long)sizeof(pkt)) return MQTT_ERR_SIZE;
+    if (remaining + 5 > txRoom(client)) return MQTT_ERR_TX_FULL;
+
+    client->subscribeId = takeId(client);
+    client->subscribed = 0;
+
+    pkt[0] = PKT_SUBSCRIBE;
+    n = 1 + putLength(pkt + 1, remaining);
+    pkt[n++] = (unsigned char)(client->subscribeId >> 8);
+    pkt[n++] = (unsigned char)client->subscribeId;
+    for (i = 0; i < count; i++) {
+        n += putString(pkt + n, topics[i], strlen(topics[i]));
+        pkt[n++] = (unsigned char)qos;
+    }
+
+    expectAck(client, nowMs);
+    if (sendBytes(client, pkt, n, nowMs) < 0) return client->lastError;
+    return client->subscribeId;
+}
+
+//*****************************************************************************
+//
+//! \brief Send PUBLISH; see mqtt_client.h
+//!
+//! \return 0 for QoS 0, the packet id for QoS 1, or a negative error
+//!
+//*****************************************************************************
+int MqttPublish(MqttClient *client, const char *topic, const char *payload,
+                int payloadLen, int qos, unsigned long nowMs) {
+    unsigned char *pkt = client->inflight;
+    unsigned char head[8];
+    int topicLen = strlen(topic);
+    long remaining;
+    unsigned short id = 0;
+    int n;
+
+    if (client->state != MQTT_UP) return MQTT_ERR_STATE;
+    if (qos && client->inflightId != 0) return MQTT_ERR_BUSY;
+
+    remaining = 2 + topicLen + (qos ? 2 : 0) + payloadLen;
+    head[0] = (unsigned char)(PKT_PUBLISH | (qos ? 0x02 : 0));
+    n = 1 + putLength(head + 1, remaining);
+    if (n + remaining > MQTT_TX_MAX) return MQTT_ERR_SIZE;
+
+    if (n + remaining > txRoom(client)) return MQTT_ERR_TX_FULL;
+
+    // QoS 1 is assembled in the resend buffer and queued from there; QoS 0
+    // goes straight into the queue.
+    if (qos) {
+        memcpy(pkt, head, n);
+        n += putString(pkt + n, topic, topicLen);
+        id = takeId(client);
+        pkt[n++] = (unsigned char)(id >> 8);
+        pkt[n++] = (unsigned char)id;
+        memcpy(pkt + n, payload, payloadLen);
+        n += payloadLen;
+
+        client->inflightId = id;
+        client->inflightLen = n;
+        client->inflightMs = nowMs;
+        if (sendBytes(client, pkt, n, nowMs) < 0) return client->lastError;
+    } else {
+        unsigned char topicHead[2];
+
+        topicHead[0] = (unsigned char)(topicLen >> 8);
+        topicHead[1] = (unsigned char)topicLen;
+        queueBytes(client, head, n, nowMs);
+        queueBytes(client, topicHead, 2, nowMs);
+        queueBytes(client, topic, topicLen, nowMs);
+        queueBytes(client, payload, payloadLen, nowMs);
+        if (flushTx(client, nowMs) < 0) return client->lastError;
+    }
+
+    client->published++;
+    return id;
+}
+
+//*****************************************************************************
+//
+//! \brief Receive, dispatch, ping and resend; see mqtt_client.h
+//!
+//! \return 0 or a negative error
+//!
+//*****************************************************************************
+int MqttPoll(MqttClient *client, unsigned long nowMs) {
+    int ret;
+
+    if (client->state == MQTT_DOWN) return MQTT_ERR_STATE;
+    if (flushTx(client, nowMs) < 0) return client->lastError;
+
+    for (;;) {
+        if (client->rxSkip > 0) {
+            long want = (client->rxSkip < MQTT_RX_MAX) ? client->rxSkip : MQTT_RX_MAX;
+
+            ret = sl_Recv(client->sock, client->rx, (int)want, 0);
+            if (ret > 0) {
+                client->rxSkip -= ret;
+                continue;
+            }
+        } else {
+            ret = sl_Recv(client->sock, client->rx + client->rxLen, MQTT_RX_MAX - client->rxLen, 0);
+            if (ret > 0) {
+                client->rxLen += ret;
+                if (drainPackets(client, nowMs) < 0) return client->lastError;
+                continue;
+            }
+        }
+        if (ret == SL_EAGAIN) break;
+        return fail(client, (ret == 0) ? MQTT_ERR_CLOSED : ret);
+    }
+
+    if (client->waiting > 0 && nowMs - client->waitSinceMs > MQTT_ACK_TIMEOUT_MS) {
+        return fail(client, MQTT_ERR_TIMEOUT);
+    }
+    if (client->state != MQTT_UP) return 0;
+
+    // Ping at half the keep-alive so the broker never has to wonder
+    if (client->keepAliveS && !client->pingOut && client->txLen == 0 &&
+        nowMs - client->lastTxMs >= client->keepAliveS * 500UL) {
+        unsigned char ping[2] = { PKT_PINGREQ, 0 };
+
+        client->pingOut = 1;
+        client->pings++;
+        expectAck(client, nowMs);
+        if (sendBytes(client, ping, sizeof(ping), nowMs) < 0) return client->lastError;
+    }
+
+    // Resent only once the queue has room for all of it
+    if (client->inflightId != 0 && nowMs - client->inflightMs >= MQTT_RESEND_MS &&
+        client->inflightLen <= txRoom(client)) {
+        client->inflight[0] |= PUBLISH_DUP;
+        client->inflightMs = nowMs;
+        client->resent++;
+        if (sendBytes(client, client->inflight, client->inflightLen, nowMs) < 0) return client->lastError;
+    }
+    return 0;
+}
+
+//*****************************************************************************
+//
+//! \brief Send DISCONNECT if connected and close the socket
+//!
+//! \return None
+//!
+//*****************************************************************************
+void MqttDisconnect(MqttClient *client) {
+    unsigned char bye[2] = { PKT_DISCONNECT, 0 };
+
+    // Behind anything still queued, so it cannot split a packet; one try
+    if (client->state == MQTT_UP && txRoom(client) >= (int)sizeof(bye)) {
+        queueBytes(client, bye, sizeof(bye), client->lastTxMs);
+        sl_Send(client->sock, client->tx, client->txLen, 0);
+    }
+    fail(client, 0);
+}
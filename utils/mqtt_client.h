@@ -0,0 +1,107 @@
+/*
+ * mqtt_client.h
+ *
+ *  Minimal MQTT 3.1.1 client on an already connected SimpleLink socket:
+ *  CONNECT, SUBSCRIBE, PUBLISH at QoS 0/1 both ways, keep-alive pings.
+ *  Everything is driven from MqttPoll() on a non-blocking socket, so the
+ *  main loop never waits on the broker.
+ */
+
+#ifndef UTILS_MQTT_CLIENT_H_
+#define UTILS_MQTT_CLIENT_H_
+
+#define MQTT_RX_MAX         1280    // largest packet kept; bigger ones are skipped
+#define MQTT_TX_MAX         1024    // largest packet sent, and the QoS 1 resend copy
+#define MQTT_TXQ_MAX        (MQTT_TX_MAX + 64)  // bytes the socket has not taken yet
+#define MQTT_ACK_TIMEOUT_MS 10000UL // CONNACK/SUBACK/PINGRESP overdue: connection is dead
+#define MQTT_RESEND_MS      5000UL  // unacknowledged QoS 1 publish goes out again as DUP
+
+#define MQTT_DOWN           0
+#define MQTT_CONNECTING     1       // CONNECT sent, waiting for CONNACK
+#define MQTT_UP             2
+
+#define MQTT_ERR_STATE      -20     // not connected, or connected already
+#define MQTT_ERR_SIZE       -21     // packet would exceed MQTT_TX_MAX
+#define MQTT_ERR_BUSY       -22     // a QoS 1 publish is still waiting for its PUBACK
+#define MQTT_ERR_REFUSED    -23     // CONNACK return code was not 0
+#define MQTT_ERR_PROTOCOL   -24     // malformed or unexpected packet
+#define MQTT_ERR_TIMEOUT    -25     // see MQTT_ACK_TIMEOUT_MS
+#define MQTT_ERR_CLOSED     -26     // peer closed the socket
+#define MQTT_ERR_TX_FULL    -27     // no room to queue the packet; try again later
+
+// Called from MqttPoll() for every PUBLISH received. topic and payload
+// point into the receive buffer and are only valid during the call; the
+// payload is NUL-terminated for convenience.
+typedef void (*MqttMessageFn)(void *ctx, const char *topic, int topicLen,
+                              const char *payload, int payloadLen);
+
+typedef struct {
+    int sock;
+    int state;
+    unsigned short keepAliveS;
+    unsigned short nextId;
+    unsigned long lastTxMs;
+    unsigned long waitSinceMs;      // oldest CONNECT, SUBSCRIBE or PINGREQ awaiting its ack
+    int waiting;                    // how many of those are outstanding
+    int pingOut;
+    unsigned short subscribeId;     // 0 until the session's first SUBSCRIBE
+    int subscribed;                 // SUBACK granted every topic of the last SUBSCRIBE
+
+    // The one QoS 1 publish in flight, kept for resending
+    unsigned short inflightId;
+    unsigned short ackedId;         // last packet id the broker acknowledged
+    unsigned long inflightMs;
+    int inflightLen;
+    unsigned char inflight[MQTT_TX_MAX];
+
+    // Packets the socket would not take at once, sent on from MqttPoll()
+    int txLen;
+    unsigned long txSinceMs;        // last progress while txLen > 0
+    unsigned char tx[MQTT_TXQ_MAX];
+
+    int rxLen;
+    long rxSkip;                    // bytes left of an oversized packet being discarded
+    unsigned char rx[MQTT_RX_MAX + 1];
+
+    MqttMessageFn onMessage;
+    void *ctx;
+    int lastError;
+
+    unsigned long published;
+    unsigned long received;
+    unsigned long acked;
+    unsigned long resent;
+    unsigned long pings;
+    unsigned long oversized;
+} MqttClient;
+
+void MqttInit(MqttClient *client, MqttMessageFn onMessage, void *ctx);
+
+// Start a clean session on sock, which the client owns from here on and
+// closes on any failure. MqttPoll() moves the state to MQTT_UP on CONNACK.
+int MqttConnect(MqttClient *client, int sock, const char *clientId,
+                unsigned short keepAliveS, unsigned long nowMs);
+
+// Subscribe to count topics at the given QoS (0 or 1); subscribed is set
+// once the SUBACK grants them all. Returns the packet id or an error;
+// MQTT_ERR_TX_FULL leaves the client as it was.
+int MqttSubscribe(MqttClient *client, const char *const *topics, int count,
+                  int qos, unsigned long nowMs);
+
+// QoS 0 goes out and is forgotten. QoS 1 is resent until the PUBACK
+// arrives, and only one may be in flight: returns the packet id, which
+// shows up in ackedId once acknowledged, or MQTT_ERR_BUSY. Whatever the
+// socket does not take at once is queued; MQTT_ERR_TX_FULL if even that
+// has no room.
+int MqttPublish(MqttClient *client, const char *topic, const char *payload,
+                int payloadLen, int qos, unsigned long nowMs);
+
+// Send on what is queued, read and dispatch whatever has arrived, ping,
+// resend. Returns 0, or a negative error after which the client is
+// MQTT_DOWN and the socket closed.
+int MqttPoll(MqttClient *client, unsigned long nowMs);
+
+// Polite DISCONNECT, then close
+void MqttDisconnect(MqttClient *client);
+
+#endif /* UTILS_MQTT_CLIENT_H_ */
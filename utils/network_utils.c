@@ -8,6 +8,7 @@
 
 // stdlib includes
 #include <stdio.h>
+#include <string.h>
 
 // Driverlib includes
 #include "hw_types.h"
@@ -22,6 +23,8 @@
 #include "gpio_if.h"
 #include "uart_if.h"
 
+#include "timebase.h"
+
 
 // globals
 
@@ -36,6 +39,11 @@ int g_port;
 
 SlDateTime g_time;
 SlAppConfig_t g_app_config;
+DnsCache g_dnsCache;
+
+static long ConfigureSimpleLinkToDefaultState();
+static long printErrConvenience(char * msg, long retVal);
+static long InitializeAppVariables();
 
 //*****************************************************************************
 // SimpleLink Asynchronous Event Handlers -- Start
@@ -451,7 +459,7 @@ static long WlanConnect() {
     UART_PRINT("Attempting connection to access point: ");
     UART_PRINT(SSID_NAME);
     UART_PRINT("... ...");
-    lRetVal = sl_WlanConnect(SSID_NAME, strlen(SSID_NAME), 0, &secParams, 0);
+    lRetVal = sl_WlanConnect((signed char *)SSID_NAME, strlen(SSID_NAME), 0, &secParams, 0);
     ASSERT_ON_ERROR(lRetVal);
 
     UART_PRINT(" Connected!!!\n\r");
@@ -487,23 +495,19 @@ long printErrConvenience(char * msg, long retVal) {
 //! This function demonstrates how certificate can be used with SSL.
 //! The procedure includes the following steps:
 //! 1) connect to an open AP
-//! 2) get the server name via a DNS request
+//! 2) take the server address resolved by tls_connect_begin()
 //! 3) define all socket options and point to the CA certificate
-//! 4) connect to the server via TCP
+//! 4) connect to the server via TCP, which tls_connect_poll() drives
 //!
-//! \param None
+//! The socket is non-blocking from the start, so neither the handshake nor
+//! any later send or receive on it waits.
 //!
-//! \return  0 on success else error code
-//! \return  LED1 is turned solid in case of success
-//!    LED2 is turned solid in case of failure
+//! \return  socket descriptor on success else error code
 //!
 //*****************************************************************************
-int tls_connect() {
-    SlSockAddrIn_t    Addr;
-    int    iAddrSize;
-    SlTimeval_t recvTimeout;
+static int tls_socket_open(void) {
+    SlSockNonblocking_t nonBlocking;
     unsigned char    ucMethod = SL_SO_SEC_METHOD_TLSV1_2;
-    unsigned int uiIP;
 //    unsigned int uiCipher = SL_SEC_MASK_TLS_ECDHE_RSA_WITH_AES_256_CBC_SHA;
     unsigned int uiCipher = SL_SEC_MASK_TLS_ECDHE_RSA_WITH_AES_128_CBC_SHA256;
 // SL_SEC_MASK_SSL_RSA_WITH_RC4_128_SHA
@@ -519,17 +523,6 @@ int tls_connect() {
     long lRetVal = -1;
     int iSockID;
 
-    lRetVal = sl_NetAppDnsGetHostByName(g_Host, strlen((const char *)g_Host),
-                                    (unsigned long*)&uiIP, SL_AF_INET);
-
-    if(lRetVal < 0) {
-        return printErrConvenience("Device couldn't retrieve the host name \n\r", lRetVal);
-    }
-
-    Addr.sin_family = SL_AF_INET;
-    Addr.sin_port = sl_Htons(g_port);
-    Addr.sin_addr.s_addr = sl_Htonl(uiIP);
-    iAddrSize = sizeof(SlSockAddrIn_t);
     //
     // opens a secure socket
     //
@@ -538,10 +531,9 @@ int tls_connect() {
         return printErrConvenience("Device unable to create secure socket \n\r", iSockID);
     }
 
-    recvTimeout.tv_sec = 5;
-    recvTimeout.tv_usec = 0;
-    lRetVal = sl_SetSockOpt(iSockID, SL_SOL_SOCKET, SL_SO_RCVTIMEO,
-                            (unsigned char *)&recvTimeout, sizeof(recvTimeout));
+    nonBlocking.NonblockingEnabled = 1;
+    lRetVal = sl_SetSockOpt(iSockID, SL_SOL_SOCKET, SL_SO_NONBLOCKING,
+                            &nonBlocking, sizeof(nonBlocking));
     if (lRetVal < 0) {
         sl_Close(iSockID);
         return printErrConvenience("Device couldn't set socket options \n\r", lRetVal);
@@ -573,9 +565,9 @@ int tls_connect() {
     //
     //configure the socket with CA certificate - for server verification
     //
-//    lRetVal = sl_SetSockOpt(iSockID, SL_SOL_SOCKET, \
-//                           SL_SO_SECURE_FILES_CA_FILE_NAME, \
-//                           SL_SSL_CA_CERT, \
+//    lRetVal = sl_SetSockOpt(iSockID, SL_SOL_SOCKET,
+//                           SL_SO_SECURE_FILES_CA_FILE_NAME,
+//                           SL_SSL_CA_CERT,
 //                           strlen(SL_SSL_CA_CERT));
 //
 //    if(lRetVal < 0) {
@@ -609,25 +601,86 @@ int tls_connect() {
         return printErrConvenience("Device couldn't set socket options \n\r", lRetVal);
     }
 
+    return iSockID;
+}
+
+static int tls_connect_start(TlsConnect *tc, unsigned long ulIP) {
+    tc->sock = tls_socket_open();
+    if (tc->sock < 0) return tc->sock;
 
-    /* connect to the peer device - Google server */
-    lRetVal = sl_Connect(iSockID, ( SlSockAddr_t *)&Addr, iAddrSize);
+    memset(&tc->addr, 0, sizeof(tc->addr));
+    tc->addr.sin_family = SL_AF_INET;
+    tc->addr.sin_port = sl_Htons(tc->port);
+    tc->addr.sin_addr.s_addr = sl_Htonl(ulIP);
+    tc->startMs = TimebaseMillis();
+    return tc->sock;
+}
 
-    if(lRetVal >= 0) {
+//*****************************************************************************
+//
+//! Resolves g_Host through g_dnsCache and opens the socket for a TLS
+//! connection to port. Nothing goes on the wire until tls_connect_poll().
+//!
+//! \return  socket descriptor on success else error code
+//
+//*****************************************************************************
+int tls_connect_begin(TlsConnect *tc, int port) {
+    unsigned long ulIP;
+    long lRetVal;
+
+    tc->sock = -1;
+    tc->port = port;
+    lRetVal = DnsCacheResolve(&g_dnsCache, (const char *)g_Host, &ulIP, TimebaseMillis());
+    if(lRetVal < 0) {
+        return printErrConvenience("Device couldn't retrieve the host name \n\r", lRetVal);
     }
-    else if(lRetVal == SL_ESECSNOVERIFY) {
+    tc->fromCache = (lRetVal != DNS_CACHE_LOOKUP);
+    return tls_connect_start(tc, ulIP);
+}
+
+//*****************************************************************************
+//
+//! Advances the connect and handshake begun by tls_connect_begin(); call
+//! it again while it returns TLS_CONNECT_PENDING. An address that came from
+//! the cache gets one fresh lookup and a second attempt if it does not
+//! connect, since the endpoint may have moved.
+//!
+//! \return  0 once connected (tc->sock is usable), TLS_CONNECT_PENDING, or
+//!          an error code after which the socket is closed
+//
+//*****************************************************************************
+int tls_connect_poll(TlsConnect *tc) {
+    unsigned long ulIP;
+    long lRetVal;
+
+    if (tc->sock < 0) return TLS_CONNECT_ERR_NO_SOCKET;
+
+    lRetVal = sl_Connect(tc->sock, (SlSockAddr_t *)&tc->addr, sizeof(SlSockAddrIn_t));
+    if (lRetVal == SL_EALREADY) {
+        if (TimebaseMillis() - tc->startMs < TLS_CONNECT_TIMEOUT_MS) return TLS_CONNECT_PENDING;
+        lRetVal = TLS_CONNECT_ERR_TIMEOUT;
+    } else if (lRetVal >= 0 || lRetVal == SL_ESECSNOVERIFY) {
+        GPIO_IF_LedOff(MCU_RED_LED_GPIO);
+        GPIO_IF_LedOn(MCU_GREEN_LED_GPIO);
+        return 0;
     }
-    else if(lRetVal < 0) {
-        UART_PRINT("Device couldn't connect to server:");
-        UART_PRINT("%s", g_Host);
-        UART_PRINT("\n\r");
-        sl_Close(iSockID);
-        return printErrConvenience("Device couldn't connect to server \n\r", lRetVal);
+
+    sl_Close(tc->sock);
+    tc->sock = -1;
+
+    if (tc->fromCache) {
+        tc->fromCache = 0;
+        DnsCacheForget(&g_dnsCache, (const char *)g_Host);
+        if (DnsCacheResolve(&g_dnsCache, (const char *)g_Host, &ulIP, TimebaseMillis()) == DNS_CACHE_LOOKUP &&
+            tls_connect_start(tc, ulIP) >= 0) {
+            return TLS_CONNECT_PENDING;
+        }
     }
 
-    GPIO_IF_LedOff(MCU_RED_LED_GPIO);
-    GPIO_IF_LedOn(MCU_GREEN_LED_GPIO);
-    return iSockID;
+    UART_PRINT("Device couldn't connect to server:");
+    UART_PRINT("%s", g_Host);
+    UART_PRINT("\n\r");
+    return printErrConvenience("Device couldn't connect to server \n\r", lRetVal);
 }
 
 
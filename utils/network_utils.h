@@ -14,6 +14,8 @@
 #include "utils.h"
 #include "common.h"
 
+#include "dns_cache.h"
+
 #define MAX_URI_SIZE 128
 #define URI_SIZE MAX_URI_SIZE + 1
 
@@ -55,6 +57,25 @@ typedef struct SlAppConfig {
 
 extern SlAppConfig_t g_app_config;
 
+// Resolver cache used by tls_connect_begin()
+extern DnsCache g_dnsCache;
+
+#define TLS_CONNECT_PENDING         1       // handshake still running, poll again
+#define TLS_CONNECT_TIMEOUT_MS      15000UL
+// Errors of our own sit beside HTTP_CONN_ERR_*, clear of the SimpleLink codes
+// tls_connect_poll() otherwise passes through
+#define TLS_CONNECT_ERR_TIMEOUT     -1010   // no handshake within TLS_CONNECT_TIMEOUT_MS
+#define TLS_CONNECT_ERR_NO_SOCKET   -1011   // polled with no connect under way
+
+// A TLS connect in progress on a non-blocking socket
+typedef struct {
+    int sock;
+    int port;
+    int fromCache;                  // address came from g_dnsCache, not a fresh lookup
+    unsigned long startMs;
+    SlSockAddrIn_t addr;
+} TlsConnect;
+
 // Application specific status/error codes
 typedef enum {
     // Choosing -0x7D0 to avoid overlap w/ host-driver's error codes
@@ -76,14 +97,12 @@ void SimpleLinkGeneralEventHandler(SlDeviceEvent_t *pDevEvent);
 
 void SimpleLinkSockEventHandler(SlSockEvent_t *pSock);
 
-static long ConfigureSimpleLinkToDefaultState();
-
-int tls_connect();
+// Connects to g_Host over TLS without the main loop waiting on it: begin
+// opens the socket (returns it or an error), then poll once per loop until
+// it stops returning TLS_CONNECT_PENDING. Sockets come back non-blocking.
+int tls_connect_begin(TlsConnect *tc, int port);
+int tls_connect_poll(TlsConnect *tc);
 
 int connectToAccessPoint();
 
-static long printErrConvenience(char * msg, long retVal);
-
-static long InitializeAppVariables();
-
 #endif /* UTILS_NETWORK_UTILS_H_ */
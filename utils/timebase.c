@@ -0,0 +1,78 @@
+/*
+ * timebase.c
+ *
+ *  Free-running microsecond clock on general purpose timer A2.
+ */
+#include "timebase.h"
+
+// Driverlib includes
+#include "hw_types.h"
+#include "hw_memmap.h"
+#include "rom.h"
+#include "rom_map.h"
+#include "prcm.h"
+#include "timer.h"
+
+static unsigned long s_lastTicks = 0;
+static unsigned long s_usFrac = 0;
+static unsigned long s_micros = 0;
+static unsigned long s_msFrac = 0;
+static unsigned long s_millis = 0;
+
+//*****************************************************************************
+//
+//! \brief Start timer A2 as a 32-bit periodic up-counter over its full range
+//!
+//! \return None
+//!
+//*****************************************************************************
+void TimebaseInit(void) {
+    MAP_PRCMPeripheralClkEnable(PRCM_TIMERA2, PRCM_RUN_MODE_CLK);
+    MAP_PRCMPeripheralReset(PRCM_TIMERA2);
+    MAP_TimerConfigure(TIMERA2_BASE, TIMER_CFG_PERIODIC_UP);
+    MAP_TimerLoadSet(TIMERA2_BASE, TIMER_A, 0xFFFFFFFFUL);
+    MAP_TimerEnable(TIMERA2_BASE, TIMER_A);
+
+    s_lastTicks = MAP_TimerValueGet(TIMERA2_BASE, TIMER_A);
+    s_usFrac = 0;
+    s_micros = 0;
+    s_msFrac = 0;
+    s_millis = 0;
+}
+
+unsigned long TimebaseTicks(void) {
+    return MAP_TimerValueGet(TIMERA2_BASE, TIMER_A);
+}
+
+//*****************************************************************************
+//
+//! \brief Fold the ticks elapsed since the last call into the us/ms counters.
+//! The counter spans the full 32 bits, so unsigned subtraction handles wrap.
+//!
+//! \return None
+//!
+//*****************************************************************************
+static void TimebaseUpdate(void) {
+    unsigned long now = TimebaseTicks();
+    unsigned long us;
+
+    s_usFrac += now - s_lastTicks;
+    s_lastTicks = now;
+    us = s_usFrac / TIMEBASE_TICKS_PER_US;
+    s_usFrac -= us * TIMEBASE_TICKS_PER_US;
+    s_micros += us;
+
+    s_msFrac += us;
+    s_millis += s_msFrac / 1000;
+    s_msFrac %= 1000;
+}
+
+unsigned long TimebaseMicros(void) {
+    TimebaseUpdate();
+    return s_micros;
+}
+
+unsigned long TimebaseMillis(void) {
+    TimebaseUpdate();
+    return s_millis;
+}
@@ -0,0 +1,23 @@
+/*
+ * timebase.h
+ *
+ *  Free-running microsecond clock on general purpose timer A2.
+ */
+
+#ifndef UTILS_TIMEBASE_H_
+#define UTILS_TIMEBASE_H_
+
+// Timer A2 counts the 80 MHz system clock
+#define TIMEBASE_TICKS_PER_US 80UL
+
+void TimebaseInit(void);
+
+// Raw 32-bit timer count; wraps every ~53 s. Safe to call from interrupts.
+unsigned long TimebaseTicks(void);
+
+// Microseconds / milliseconds since TimebaseInit(). Main-loop context only,
+// and must be called at least once per timer wrap.
+unsigned long TimebaseMicros(void);
+unsigned long TimebaseMillis(void);
+
+#endif /* UTILS_TIMEBASE_H_ */